@@ -17,7 +17,7 @@ clean:
 	-rm -rf $(target).dSYM
 
 lint: $(sources)
-	$(LINT) $(CC) $(CPPFLAGS) $(CFLAGS) $(LDFLAGS) $? -o $(target)
+	$(LINT) $(CC) $(CPPFLAGS) $(CFLAGS) $(LDFLAGS) $? $(LDLIBS) -o $(target)
 
 test:
 	$(CEEDLING) test:all
@@ -30,4 +30,4 @@ test_clean:
 	-rm -rf build
 
 $(target): $(sources)
-	$(CC) $(CPPFLAGS) $(CFLAGS) $(LDFLAGS) $^ -o $@
+	$(CC) $(CPPFLAGS) $(CFLAGS) $(LDFLAGS) $^ $(LDLIBS) -o $@
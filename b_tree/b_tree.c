@@ -0,0 +1,628 @@
+// B+ tree
+//
+// See https://en.wikipedia.org/wiki/B%2B_tree
+// See https://en.algorithmica.org/hpc/data-structures/b-tree/
+
+#define _POSIX_C_SOURCE 200809L // For posix_memalign
+
+#include <errno.h>          // For errno
+#include <stdbool.h>        // For bool, true, false
+#include <stdint.h>         // For uint32_t
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For malloc, realloc, posix_memalign, free, NULL
+#include <string.h>         // For memcpy, memmove, strerror
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>      // For the AVX2 intrinsics
+#endif
+#include "b_tree.h"         // This module
+
+// Size of a cache line, in bytes
+#define CACHE_LINE  64
+
+// Maximum number of levels, more than a tree of 2^32 nodes can have when each internal node has at least 2 children
+#define HEIGHT_MAX  33
+
+// Nodes must be a whole number of cache lines
+typedef char node_size_check[(sizeof(btree_node_t) % CACHE_LINE == 0) ? 1 : -1];
+
+// Get a node from its index in the pool
+static inline btree_node_t* node_at(const btree_t* tree, uint32_t index) {
+    return &tree->slabs[index / BTREE_SLAB_NODES][index % BTREE_SLAB_NODES];
+}
+
+// Allocate slabs until the pool has room for n more nodes, counting the spare ones, so that allocating them cannot fail
+static bool reserve(btree_t* tree, size_t n) {
+    n = (n > tree->nspare) ? n - tree->nspare : 0;
+    if(tree->nnodes + n >= BTREE_NONE) {
+        printf("Too many nodes\n");
+        return false;
+    }
+
+    while(tree->nnodes + n > tree->nslabs * BTREE_SLAB_NODES) {
+        btree_node_t** slabs = realloc(tree->slabs, (tree->nslabs + 1) * sizeof(btree_node_t*));
+        if(slabs == NULL) {
+            printf("Failed to allocate slabs\n");
+            return false;
+        }
+        tree->slabs = slabs;
+
+        void*     slab  = NULL;
+        const int error = posix_memalign(&slab, CACHE_LINE, BTREE_SLAB_NODES * sizeof(btree_node_t));
+        if(error != 0) {
+            printf("posix_memalign failed: %s", strerror(error));
+            return false;
+        }
+        tree->slabs[tree->nslabs++] = slab;
+    }
+    return true;
+}
+
+// Allocate a node from the pool, which must have room for it, reusing a spare node if there is one
+static uint32_t allocate(btree_t* tree) {
+    if(tree->spare != BTREE_NONE) {
+        const uint32_t k = tree->spare;
+        tree->spare = node_at(tree, k)->next;
+        tree->nspare--;
+        return k;
+    }
+    return (uint32_t)tree->nnodes++;
+}
+
+// Return a node to the pool, on the list of spare nodes
+static void release(btree_t* tree, uint32_t k) {
+    node_at(tree, k)->next = tree->spare;
+    tree->spare = k;
+    tree->nspare++;
+}
+
+// Count the keys of a node less than a key (or not greater than it, if upper), one at a time
+static inline uint32_t rank_scalar(const btree_node_t* node, int key, bool upper) {
+    uint32_t rank = 0;
+    for(uint32_t i = 0; i < node->count; i++) {
+        rank += upper ? (node->keys[i] <= key) : (node->keys[i] < key);
+    }
+    return rank;
+}
+
+// Descend from the root to the leaf that would hold a key, returning it, and the position of the first key in the
+// leaf not less than the key in index
+static uint32_t descend_scalar(const btree_t* tree, int key, uint32_t* index) {
+    uint32_t k = tree->root;
+    for(uint32_t level = 1; level < tree->height; level++) {
+        const btree_node_t* node = node_at(tree, k);
+        k = node->slots.children[rank_scalar(node, key, true)];
+    }
+    *index = rank_scalar(node_at(tree, k), key, false);
+    return k;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Count the keys of a node less than a key (or not greater than it, if upper), comparing 8 at a time. The last load
+// reads 2 words past the keys, which are masked off with any others past the count.
+__attribute__((target("avx2,popcnt")))
+static inline uint32_t rank_avx2(const btree_node_t* node, __m256i key, bool upper) {
+    const __m256i* keys = (const __m256i*)node->keys;
+    uint32_t       mask = 0;
+    for(int i = 0; i < 4; i++) {
+        const __m256i values  = _mm256_loadu_si256(keys + i);
+        const __m256i compare = upper ? _mm256_cmpgt_epi32(values, key) : _mm256_cmpgt_epi32(key, values);
+        mask |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(compare)) << (8 * i);
+    }
+    mask &= (1u << node->count) - 1;
+
+    // For upper, the mask has the keys greater than the key
+    const uint32_t rank = (uint32_t)__builtin_popcount(mask);
+    return upper ? node->count - rank : rank;
+}
+
+// Descend the tree as descend_scalar does, comparing 8 keys at a time
+__attribute__((target("avx2,popcnt")))
+static uint32_t descend_avx2(const btree_t* tree, int key, uint32_t* index) {
+    const __m256i keys = _mm256_set1_epi32(key);
+    uint32_t      k    = tree->root;
+    for(uint32_t level = 1; level < tree->height; level++) {
+        const btree_node_t* node = node_at(tree, k);
+        k = node->slots.children[rank_avx2(node, keys, true)];
+    }
+    *index = rank_avx2(node_at(tree, k), keys, false);
+    return k;
+}
+
+// Count the keys of a node less than a key (or not greater than it, if upper), for the callers that are not compiled
+// for AVX2
+__attribute__((target("avx2,popcnt")))
+static uint32_t rank_avx2_key(const btree_node_t* node, int key, bool upper) {
+    return rank_avx2(node, _mm256_set1_epi32(key), upper);
+}
+
+// Whether the CPU supports AVX2: 1 if so, 0 if not, or -1 until it has been checked
+static int avx2_supported = -1;
+
+// Check whether the CPU supports AVX2
+static bool has_avx2(void) {
+    int supported = __atomic_load_n(&avx2_supported, __ATOMIC_RELAXED);
+    if(supported < 0) {
+        supported = (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) ? 1 : 0;
+        __atomic_store_n(&avx2_supported, supported, __ATOMIC_RELAXED);
+    }
+    return supported != 0;
+}
+
+#endif
+
+// Count the keys of a node less than a key (or not greater than it, if upper)
+static uint32_t rank(const btree_node_t* node, int key, bool upper) {
+#if defined(__x86_64__) || defined(__i386__)
+    if(has_avx2()) {
+        return rank_avx2_key(node, key, upper);
+    }
+#endif
+    return rank_scalar(node, key, upper);
+}
+
+// Descend from the root of a tree that is not empty to the leaf that would hold a key
+static uint32_t descend(const btree_t* tree, int key, uint32_t* index) {
+#if defined(__x86_64__) || defined(__i386__)
+    if(has_avx2()) {
+        return descend_avx2(tree, key, index);
+    }
+#endif
+    return descend_scalar(tree, key, index);
+}
+
+// Insert a key and value into a full leaf at a position, splitting it in two and returning the new leaf to its right
+static uint32_t split_leaf(btree_t* tree, uint32_t k, uint32_t index, int key, int value) {
+    const uint32_t half  = BTREE_B / 2;
+    const uint32_t r     = allocate(tree);
+    btree_node_t*  left  = node_at(tree, k);
+    btree_node_t*  right = node_at(tree, r);
+
+    memcpy(right->keys, left->keys + half, (BTREE_B - half) * sizeof(int));
+    memcpy(right->slots.values, left->slots.values + half, (BTREE_B - half) * sizeof(int));
+    right->count = BTREE_B - half;
+    right->next  = left->next;
+    left->count  = half;
+    left->next   = r;
+
+    btree_node_t* node = (index <= half) ? left : right;
+    index -= (index <= half) ? 0 : half;
+    memmove(node->keys + index + 1, node->keys + index, (node->count - index) * sizeof(int));
+    memmove(node->slots.values + index + 1, node->slots.values + index, (node->count - index) * sizeof(int));
+    node->keys[index]         = key;
+    node->slots.values[index] = value;
+    node->count++;
+    return r;
+}
+
+// Insert a separator key and the child to its right into a full internal node at a position, splitting it in two
+// around its middle key, which is returned in key, and returning the new node to its right
+static uint32_t split_internal(btree_t* tree, uint32_t k, uint32_t index, int* key, uint32_t child) {
+    int      keys[BTREE_B + 1];
+    uint32_t children[BTREE_B + 2];
+    const uint32_t half  = (BTREE_B + 1) / 2;
+    const uint32_t r     = allocate(tree);
+    btree_node_t*  left  = node_at(tree, k);
+    btree_node_t*  right = node_at(tree, r);
+
+    // Merge the new key and child into a copy of the node
+    memcpy(keys, left->keys, index * sizeof(int));
+    keys[index] = *key;
+    memcpy(keys + index + 1, left->keys + index, (BTREE_B - index) * sizeof(int));
+    memcpy(children, left->slots.children, (index + 1) * sizeof(uint32_t));
+    children[index + 1] = child;
+    memcpy(children + index + 2, left->slots.children + index + 1, (BTREE_B - index) * sizeof(uint32_t));
+
+    // The left half stays put, the middle key moves up to the parent, and the right half moves to the new node
+    memcpy(left->keys, keys, half * sizeof(int));
+    memcpy(left->slots.children, children, (half + 1) * sizeof(uint32_t));
+    left->count = half;
+    *key = keys[half];
+    memcpy(right->keys, keys + half + 1, (BTREE_B - half) * sizeof(int));
+    memcpy(right->slots.children, children + half + 1, (BTREE_B - half + 1) * sizeof(uint32_t));
+    right->count = BTREE_B - half;
+    right->next  = BTREE_NONE;
+    return r;
+}
+
+// Split count items into groups of up to size items, every group full but the last two, which share what is left
+// evenly if the last would otherwise be less than half full, returning the number of items in group i and the index
+// of its first item in start
+static size_t group(size_t count, size_t size, size_t i, size_t* start) {
+    const size_t ngroups = (count + size - 1) / size;
+    const size_t last    = count - (ngroups - 1) * size;
+    *start = i * size;
+    if((ngroups < 2) || (last >= (size + 1) / 2) || (i + 2 < ngroups)) {
+        return (i + 1 < ngroups) ? size : last;
+    }
+
+    // The second to last group takes the larger half
+    const size_t shared = size + last;
+    if(i + 2 == ngroups) {
+        return shared - shared / 2;
+    }
+    *start -= size - (shared - shared / 2);
+    return shared / 2;
+}
+
+// Create an empty tree
+btree_t* btree_create(void) {
+    btree_t* tree = malloc(sizeof(btree_t));
+    if(tree == NULL) {
+        printf("Failed to allocate struct\n");
+        return NULL;
+    }
+
+    tree->count  = 0;
+    tree->height = 0;
+    tree->root   = BTREE_NONE;
+    tree->first  = BTREE_NONE;
+    tree->nnodes = 0;
+    tree->spare  = BTREE_NONE;
+    tree->nspare = 0;
+    tree->nslabs = 0;
+    tree->slabs  = NULL;
+    return tree;
+}
+
+// Create a tree from keys in ascending order and their values
+btree_t* btree_load(const int* keys, const int* values, size_t n) {
+    if((n > 0) && ((keys == NULL) || (values == NULL))) {
+        printf("Bad arguments\n");
+        return NULL;
+    }
+    for(size_t i = 1; i < n; i++) {
+        if(keys[i - 1] >= keys[i]) {
+            printf("Bad arguments\n");
+            return NULL;
+        }
+    }
+
+    btree_t* tree = btree_create();
+    if((tree == NULL) || (n == 0)) {
+        return tree;
+    }
+
+    // Count the nodes on each level, up to the root, and allocate them all at once
+    size_t total = 0;
+    for(size_t count = (n + BTREE_B - 1) / BTREE_B; ; count = (count + BTREE_B) / (BTREE_B + 1)) {
+        total += count;
+        if(count == 1) {
+            break;
+        }
+    }
+    const size_t nleaves = (n + BTREE_B - 1) / BTREE_B;
+    int*         mins    = malloc(nleaves * sizeof(int));
+    if(mins == NULL) {
+        printf("malloc failed: %s", strerror(errno));
+        btree_destroy(&tree);
+        return NULL;
+    }
+    if(!reserve(tree, total)) {
+        free(mins);
+        btree_destroy(&tree);
+        return NULL;
+    }
+
+    // Fill the leaves, which are allocated one after another, remembering the smallest key in each
+    tree->first = (uint32_t)tree->nnodes;
+    for(size_t i = 0; i < nleaves; i++) {
+        const uint32_t k    = allocate(tree);
+        btree_node_t*  leaf = node_at(tree, k);
+        size_t         j    = 0;
+        leaf->count = (uint32_t)group(n, BTREE_B, i, &j);
+        leaf->next  = (i + 1 < nleaves) ? k + 1 : BTREE_NONE;
+        memcpy(leaf->keys, keys + j, leaf->count * sizeof(int));
+        memcpy(leaf->slots.values, values + j, leaf->count * sizeof(int));
+        mins[i] = keys[j];
+    }
+
+    // Build each level on top of the one below, from groups of up to BTREE_B + 1 nodes, separated by the smallest key
+    // of each node after the first. The smallest key of the parent is that of its first child.
+    uint32_t start = tree->first;
+    size_t   count = nleaves;
+    tree->height = 1;
+    while(count > 1) {
+        const size_t   nparents = (count + BTREE_B) / (BTREE_B + 1);
+        const uint32_t first    = (uint32_t)tree->nnodes;
+        for(size_t i = 0; i < nparents; i++) {
+            btree_node_t* node = node_at(tree, allocate(tree));
+            size_t        j    = 0;
+            node->count = (uint32_t)group(count, BTREE_B + 1, i, &j) - 1;
+            node->next  = BTREE_NONE;
+            for(uint32_t c = 0; c <= node->count; c++) {
+                node->slots.children[c] = start + (uint32_t)(j + c);
+                if(c > 0) {
+                    node->keys[c - 1] = mins[j + c];
+                }
+            }
+            mins[i] = mins[j];
+        }
+        start = first;
+        count = nparents;
+        tree->height++;
+    }
+
+    tree->root  = start;
+    tree->count = n;
+    free(mins);
+    return tree;
+}
+
+// Destroy a tree
+void btree_destroy(btree_t** tree) {
+    if((tree == NULL) || (*tree == NULL)) {
+        printf("Bad B+ tree\n");
+        return;
+    }
+
+    for(size_t i = 0; i < (*tree)->nslabs; i++) {
+        free((*tree)->slabs[i]);
+    }
+    free((*tree)->slabs);
+    free(*tree);
+    *tree = NULL;
+}
+
+// Insert a key and its value into a tree, or replace the value of a key already in it
+bool btree_insert(btree_t* tree, int key, int value) {
+    if(tree == NULL) {
+        printf("Bad B+ tree\n");
+        return false;
+    }
+
+    // An empty tree is a single empty leaf
+    if(tree->root == BTREE_NONE) {
+        if(!reserve(tree, 1)) {
+            return false;
+        }
+        tree->root   = allocate(tree);
+        tree->first  = tree->root;
+        tree->height = 1;
+        node_at(tree, tree->root)->count = 0;
+        node_at(tree, tree->root)->next  = BTREE_NONE;
+    }
+
+    // Descend to the leaf, remembering the path and how many of the nodes on it are full, each of which will split
+    uint32_t path[HEIGHT_MAX];
+    uint32_t ranks[HEIGHT_MAX];
+    uint32_t k     = tree->root;
+    size_t   nfull = 0;
+    for(uint32_t level = 0; level + 1 < tree->height; level++) {
+        const btree_node_t* node = node_at(tree, k);
+        nfull        = (node->count == BTREE_B) ? nfull + 1 : 0;
+        path[level]  = k;
+        ranks[level] = rank(node, key, true);
+        k            = node->slots.children[ranks[level]];
+    }
+    btree_node_t*  leaf  = node_at(tree, k);
+    const uint32_t index = rank(leaf, key, false);
+    if((index < leaf->count) && (leaf->keys[index] == key)) {
+        leaf->slots.values[index] = value;
+        return true;
+    }
+
+    if(leaf->count < BTREE_B) {
+        memmove(leaf->keys + index + 1, leaf->keys + index, (leaf->count - index) * sizeof(int));
+        memmove(leaf->slots.values + index + 1, leaf->slots.values + index, (leaf->count - index) * sizeof(int));
+        leaf->keys[index]         = key;
+        leaf->slots.values[index] = value;
+        leaf->count++;
+        tree->count++;
+        return true;
+    }
+
+    // Allocate the nodes for the splits first, so that the tree is unchanged if they cannot be allocated. If every node
+    // on the path is full, the root splits too, and there is a new root above it.
+    const size_t nsplits = 1 + nfull + ((nfull + 1 == tree->height) ? 1 : 0);
+    if((tree->height == HEIGHT_MAX) || !reserve(tree, nsplits)) {
+        return false;
+    }
+
+    // Split the leaf, then insert the smallest key of the new leaf and the new leaf into the parent, and so on up
+    uint32_t child     = split_leaf(tree, k, index, key, value);
+    int      separator = node_at(tree, child)->keys[0];
+    tree->count++;
+    for(uint32_t level = tree->height - 1; level-- > 0; ) {
+        btree_node_t*  node = node_at(tree, path[level]);
+        const uint32_t i    = ranks[level];
+        if(node->count < BTREE_B) {
+            memmove(node->keys + i + 1, node->keys + i, (node->count - i) * sizeof(int));
+            memmove(node->slots.children + i + 2, node->slots.children + i + 1,
+                    (node->count - i) * sizeof(uint32_t));
+            node->keys[i]               = separator;
+            node->slots.children[i + 1] = child;
+            node->count++;
+            return true;
+        }
+        child = split_internal(tree, path[level], i, &separator, child);
+    }
+
+    // The root split
+    const uint32_t root = allocate(tree);
+    btree_node_t*  node = node_at(tree, root);
+    node->count             = 1;
+    node->next              = BTREE_NONE;
+    node->keys[0]           = separator;
+    node->slots.children[0] = tree->root;
+    node->slots.children[1] = child;
+    tree->root              = root;
+    tree->height++;
+    return true;
+}
+
+// Move n keys and their values from the start of a leaf to the end of the leaf to its left, or for internal nodes, the
+// separator between them and n children with the keys between them, returning the new separator. Moving every key of
+// a leaf, or every child of an internal node, merges the two nodes.
+static int shift_left(btree_node_t* left, btree_node_t* right, int separator, uint32_t n, bool leaf) {
+    if(leaf) {
+        memcpy(left->keys + left->count, right->keys, n * sizeof(int));
+        memcpy(left->slots.values + left->count, right->slots.values, n * sizeof(int));
+        memmove(right->keys, right->keys + n, (right->count - n) * sizeof(int));
+        memmove(right->slots.values, right->slots.values + n, (right->count - n) * sizeof(int));
+        left->count  += n;
+        right->count -= n;
+        return (right->count > 0) ? right->keys[0] : separator;
+    }
+
+    left->keys[left->count] = separator;
+    memcpy(left->keys + left->count + 1, right->keys, (n - 1) * sizeof(int));
+    memcpy(left->slots.children + left->count + 1, right->slots.children, n * sizeof(uint32_t));
+    left->count += n;
+    if(n > right->count) {
+        right->count = 0;
+        return separator;
+    }
+    separator = right->keys[n - 1];
+    memmove(right->keys, right->keys + n, (right->count - n) * sizeof(int));
+    memmove(right->slots.children, right->slots.children + n, (right->count - n + 1) * sizeof(uint32_t));
+    right->count -= n;
+    return separator;
+}
+
+// Move the last key and its value from a leaf to the start of the leaf to its right, or for internal nodes, the
+// separator between them and the last child, returning the new separator
+static int shift_right(btree_node_t* left, btree_node_t* right, int separator, bool leaf) {
+    memmove(right->keys + 1, right->keys, right->count * sizeof(int));
+    if(leaf) {
+        memmove(right->slots.values + 1, right->slots.values, right->count * sizeof(int));
+        right->keys[0]         = left->keys[left->count - 1];
+        right->slots.values[0] = left->slots.values[left->count - 1];
+        separator              = right->keys[0];
+    } else {
+        memmove(right->slots.children + 1, right->slots.children, (right->count + 1) * sizeof(uint32_t));
+        right->keys[0]           = separator;
+        right->slots.children[0] = left->slots.children[left->count];
+        separator                = left->keys[left->count - 1];
+    }
+    left->count--;
+    right->count++;
+    return separator;
+}
+
+// Delete a key and its value from a tree
+bool btree_delete(btree_t* tree, int key) {
+    if(tree == NULL) {
+        printf("Bad B+ tree\n");
+        return false;
+    }
+    if(tree->root == BTREE_NONE) {
+        return false;
+    }
+
+    // Descend to the leaf, remembering the path
+    uint32_t path[HEIGHT_MAX];
+    uint32_t ranks[HEIGHT_MAX];
+    uint32_t k = tree->root;
+    for(uint32_t level = 0; level + 1 < tree->height; level++) {
+        const btree_node_t* node = node_at(tree, k);
+        path[level]  = k;
+        ranks[level] = rank(node, key, true);
+        k            = node->slots.children[ranks[level]];
+    }
+    btree_node_t*  leaf  = node_at(tree, k);
+    const uint32_t index = rank(leaf, key, false);
+    if((index == leaf->count) || (leaf->keys[index] != key)) {
+        return false;
+    }
+
+    memmove(leaf->keys + index, leaf->keys + index + 1, (leaf->count - index - 1) * sizeof(int));
+    memmove(leaf->slots.values + index, leaf->slots.values + index + 1, (leaf->count - index - 1) * sizeof(int));
+    leaf->count--;
+    tree->count--;
+
+    // A node left less than half full takes a key from a sibling that can spare one, or else is merged with it, which
+    // takes a key from the parent, and so on up. The separators of a leaf need not be keys in the tree, so they are
+    // left as they are when the smallest key of a leaf is deleted.
+    for(uint32_t level = tree->height - 1; level > 0; level--) {
+        btree_node_t* node = node_at(tree, k);
+        if(node->count >= BTREE_B / 2) {
+            return true;
+        }
+
+        btree_node_t*  parent = node_at(tree, path[level - 1]);
+        const uint32_t i      = ranks[level - 1];
+        const bool     isleaf = (level + 1 == tree->height);
+        btree_node_t*  left   = (i > 0) ? node_at(tree, parent->slots.children[i - 1]) : NULL;
+        btree_node_t*  right  = (i < parent->count) ? node_at(tree, parent->slots.children[i + 1]) : NULL;
+        if((left != NULL) && (left->count > BTREE_B / 2)) {
+            parent->keys[i - 1] = shift_right(left, node, parent->keys[i - 1], isleaf);
+            return true;
+        }
+        if((right != NULL) && (right->count > BTREE_B / 2)) {
+            parent->keys[i] = shift_left(node, right, parent->keys[i], 1, isleaf);
+            return true;
+        }
+
+        // Merge the node into its left sibling, or its right sibling into it, and remove the one emptied from the
+        // parent
+        const uint32_t j      = (left != NULL) ? i - 1 : i;
+        btree_node_t*  merged = node_at(tree, parent->slots.children[j]);
+        btree_node_t*  gone   = node_at(tree, parent->slots.children[j + 1]);
+        shift_left(merged, gone, parent->keys[j], gone->count + (isleaf ? 0 : 1), isleaf);
+        merged->next = gone->next;
+        release(tree, parent->slots.children[j + 1]);
+        memmove(parent->keys + j, parent->keys + j + 1, (parent->count - j - 1) * sizeof(int));
+        memmove(parent->slots.children + j + 1, parent->slots.children + j + 2,
+                (parent->count - j - 1) * sizeof(uint32_t));
+        parent->count--;
+        k = path[level - 1];
+    }
+
+    // A root left with no keys is replaced by its only child, or if it is a leaf, the tree is empty
+    btree_node_t* root = node_at(tree, tree->root);
+    if(root->count == 0) {
+        const uint32_t old = tree->root;
+        if(tree->height == 1) {
+            tree->root   = BTREE_NONE;
+            tree->first  = BTREE_NONE;
+            tree->height = 0;
+        } else {
+            tree->root = root->slots.children[0];
+            tree->height--;
+        }
+        release(tree, old);
+    }
+    return true;
+}
+
+// Find the value of a key in a tree
+bool btree_find(const btree_t* tree, int key, int* value) {
+    if((tree == NULL) || (tree->root == BTREE_NONE)) {
+        return false;
+    }
+
+    uint32_t            index = 0;
+    const btree_node_t* leaf  = node_at(tree, descend(tree, key, &index));
+    if((index < leaf->count) && (leaf->keys[index] == key)) {
+        *value = leaf->slots.values[index];
+        return true;
+    }
+    return false;
+}
+
+// Get an iterator at the first key not less than a key
+btree_iterator_t btree_seek(const btree_t* tree, int key) {
+    btree_iterator_t iterator = { tree, BTREE_NONE, 0 };
+    if((tree != NULL) && (tree->root != BTREE_NONE)) {
+        iterator.leaf = descend(tree, key, &iterator.index);
+    }
+    return iterator;
+}
+
+// Get the key and value at an iterator and move it to the next key
+bool btree_next(btree_iterator_t* iterator, int* key, int* value) {
+    // The first key not less than the key may be in the next leaf
+    while(iterator->leaf != BTREE_NONE) {
+        const btree_node_t* leaf = node_at(iterator->tree, iterator->leaf);
+        if(iterator->index < leaf->count) {
+            *key   = leaf->keys[iterator->index];
+            *value = leaf->slots.values[iterator->index];
+            iterator->index++;
+            return true;
+        }
+        iterator->leaf  = leaf->next;
+        iterator->index = 0;
+    }
+    return false;
+}
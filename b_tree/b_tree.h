@@ -0,0 +1,187 @@
+// B+ tree
+//
+// An ordered map from int keys to int values. A binary tree stores each key in its own node, allocated on its own,
+// with two or three pointers: in binary_tree that is 32 bytes, or 48 with the allocator's overhead, for a 4-byte key,
+// and a lookup takes log_2(N) dependent cache misses, each of which uses only a few bytes of the 64-byte cache line it
+// fetches.
+//
+// A B+ tree keeps up to BTREE_B keys in each node, so it is log_B(N) levels deep, about a fifth as many as a binary
+// tree. The values are all in the leaves, and the internal nodes only hold separator keys that direct the search:
+// child i of an internal node holds the keys from separator i - 1 (inclusive) up to separator i (exclusive). Which
+// child to descend to, or where a key is in a leaf, is the number of keys in the node less than (or not greater than)
+// the key, which AVX2 counts by comparing 8 keys at a time and taking the popcount of the mask. The keys of a node
+// fill two cache lines, and are the only part of the node read until the leaf.
+//
+// Nodes are 256 bytes, 4 cache lines, and come from a pool of slabs of BTREE_SLAB_NODES nodes aligned to a cache
+// line, rather than from malloc one by one. Nodes refer to each other by their 32-bit index in the pool rather than a
+// pointer, which keeps each node to 4 cache lines: child i of a node is node slots.children[i] of the pool.
+//
+// Each leaf also has the index of the next leaf in order, so that a range scan finds the first key with one descent
+// and then walks the leaves, reading the keys and values sequentially.
+//
+// A tree is built either by inserting keys one at a time, in O(log N) each, which splits a full node in two and adds a
+// separator to its parent, leaving nodes between half and completely full; or by loading sorted keys in O(N), which
+// fills the nodes completely, but for the last two on each level, and builds each level on top of the one below.
+//
+// Deleting a key that leaves a node less than half full moves a key into it from a sibling that has one to spare, or
+// else merges it with the sibling and deletes the separator between them from the parent, which may be left less than
+// half full in turn. Every node but the root is therefore kept at least half full. The nodes freed by merges go on a
+// list of spare nodes, which later insertions take from first.
+//
+// See https://en.wikipedia.org/wiki/B%2B_tree
+// See https://en.algorithmica.org/hpc/data-structures/b-tree/
+
+#ifndef B_TREE_H
+#define B_TREE_H
+
+#include <stdbool.h>    // For bool
+#include <stddef.h>     // For size_t
+#include <stdint.h>     // For uint32_t, UINT32_MAX
+
+// Maximum number of keys in a node
+#define BTREE_B             30
+
+// Number of nodes in each slab of the pool
+#define BTREE_SLAB_NODES    4096
+
+// Index of no node
+#define BTREE_NONE          UINT32_MAX
+
+// A node of a tree, which is a leaf if it is on the lowest level of the tree.
+//
+// Fields:
+//  count    : number of keys.
+//  next     : for a leaf, the index of the next leaf in order, or BTREE_NONE for the last one.
+//  keys     : the keys, in order.
+//  slots    : for a leaf, the value of each key in slots.values, or for an internal node, the indices of its count + 1
+//             children in slots.children.
+//  reserved : padding to 256 bytes.
+typedef struct btree_node_t {
+    uint32_t count;
+    uint32_t next;
+    int      keys[BTREE_B];
+    union {
+        int      values[BTREE_B];
+        uint32_t children[BTREE_B + 1];
+    } slots;
+    uint32_t reserved;
+} btree_node_t;
+
+// A B+ tree.
+//
+// Fields:
+//  count  : number of keys.
+//  height : number of levels, 0 for an empty tree.
+//  root   : index of the root, or BTREE_NONE for an empty tree.
+//  first  : index of the first leaf, or BTREE_NONE for an empty tree.
+//  nnodes : number of nodes allocated from the pool, including the spare ones.
+//  spare  : index of the first spare node, linked through next, or BTREE_NONE if there are none.
+//  nspare : number of spare nodes.
+//  nslabs : number of slabs allocated.
+//  slabs  : pointers to the slabs, each of BTREE_SLAB_NODES nodes aligned to a cache line.
+typedef struct btree_t {
+    size_t         count;
+    uint32_t       height;
+    uint32_t       root;
+    uint32_t       first;
+    size_t         nnodes;
+    uint32_t       spare;
+    size_t         nspare;
+    size_t         nslabs;
+    btree_node_t** slabs;
+} btree_t;
+
+// A position in a tree, for range scans.
+//
+// Fields:
+//  tree  : the tree.
+//  leaf  : index of the leaf, or BTREE_NONE past the last key.
+//  index : index of the key in the leaf.
+typedef struct btree_iterator_t {
+    const btree_t* tree;
+    uint32_t       leaf;
+    uint32_t       index;
+} btree_iterator_t;
+
+// Create an empty tree.
+//
+// Returns:
+//  pointer to the tree or NULL if memory could not be allocated.
+btree_t* btree_create(void);
+
+// Create a tree from keys in ascending order and their values, in O(N), with every node full but the last two on each
+// level, which are at least half full.
+//
+// Parameters:
+//  keys   : pointer to the array of keys, in strictly ascending order.
+//  values : pointer to the array of values, one for each key.
+//  n      : number of keys.
+//
+// Returns:
+//  pointer to the tree or NULL if the arguments are bad or memory could not be allocated.
+btree_t* btree_load(const int* keys, const int* values, size_t n);
+
+// Destroy a tree.
+//
+// Parameters:
+//  tree : pointer to pointer to the tree.
+void btree_destroy(btree_t** tree);
+
+// Insert a key and its value into a tree, or replace the value of a key already in it.
+//
+// Parameters:
+//  tree  : pointer to the tree.
+//  key   : the key.
+//  value : the value.
+//
+// Returns:
+//  true     : the key was inserted or its value replaced.
+//  false    : the tree is bad or memory could not be allocated.
+bool btree_insert(btree_t* tree, int key, int value);
+
+// Delete a key and its value from a tree.
+//
+// Parameters:
+//  tree : pointer to the tree.
+//  key  : the key.
+//
+// Returns:
+//  true     : the key was deleted.
+//  false    : the tree is bad or the key is not in it.
+bool btree_delete(btree_t* tree, int key);
+
+// Find the value of a key in a tree.
+//
+// Parameters:
+//  tree  : pointer to the tree.
+//  key   : the key.
+//  value : pointer to the value of the key, set if it is found.
+//
+// Returns:
+//  true     : the key was found.
+//  false    : the key is not in the tree.
+bool btree_find(const btree_t* tree, int key, int* value);
+
+// Get an iterator at the first key not less than a key, to scan the keys from there in order.
+//
+// Parameters:
+//  tree : pointer to the tree.
+//  key  : the key.
+//
+// Returns:
+//  the iterator, past the last key if every key is less than the key.
+btree_iterator_t btree_seek(const btree_t* tree, int key);
+
+// Get the key and value at an iterator and move it to the next key.
+//
+// Parameters:
+//  iterator : pointer to the iterator.
+//  key      : pointer to the key.
+//  value    : pointer to the value.
+//
+// Returns:
+//  true     : the key and value were got.
+//  false    : the iterator is past the last key.
+bool btree_next(btree_iterator_t* iterator, int* key, int* value);
+
+#endif // B_TREE_H
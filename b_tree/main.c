@@ -0,0 +1,434 @@
+// B+ tree
+//
+// Random lookups, half of them hits, are benchmarked against a red-black tree in trees of increasing size, with the
+// B+ tree built both by loading sorted keys and by inserting them in random order, reporting nanoseconds per lookup,
+// nanoseconds per key of a range scan, and bytes per key, with:
+//
+//  ./b_tree benchmark [largest number of keys]
+//
+// The red-black tree takes about 48 bytes a key, so it is left out of sizes over BINARY_TREE_MAX.
+//
+// See https://en.wikipedia.org/wiki/B%2B_tree
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include <errno.h>          // For errno
+#include <limits.h>         // For INT_MIN, INT_MAX
+#include <stdbool.h>        // For bool, true, false
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For EXIT_SUCCESS, EXIT_FAILURE, malloc, free, rand, strtoul
+#include <string.h>         // For strcmp, strerror
+#include <time.h>           // For clock_gettime
+#include "b_tree.h"         // For btree_t and the tree operations
+#include "binary_tree.h"    // For node_t, compare_data, insert, search, destroy
+
+#define NELEMENTS(a)    (sizeof(a) / sizeof(a[0]))
+
+// Number of random lookups timed for each size of tree
+#define NQUERIES        1000000
+
+// Largest number of keys to benchmark the red-black tree with
+#define BINARY_TREE_MAX 20000000
+
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Shuffle an array of keys
+void shuffle(int* keys, size_t nkeys) {
+    for(size_t i = nkeys; i > 1; i--) {
+        const size_t j    = ((size_t)rand() * ((size_t)RAND_MAX + 1) + (size_t)rand()) % i;
+        const int    temp = keys[i - 1];
+        keys[i - 1] = keys[j];
+        keys[j]     = temp;
+    }
+}
+
+// Get a node of a tree from its index
+const btree_node_t* node(const btree_t* tree, uint32_t index) {
+    return &tree->slabs[index / BTREE_SLAB_NODES][index % BTREE_SLAB_NODES];
+}
+
+// Check that a sub-tree at a level is in order, with keys from lo up to hi (inclusive), every leaf on the lowest level,
+// every node but the root at least half full and every internal node with at least one key, and that its leaves follow
+// on from a previous leaf, returning the number of keys in it, or -1 if not
+long check(const btree_t* tree, uint32_t k, uint32_t level, long lo, long hi, uint32_t* leaf) {
+    const btree_node_t* n = node(tree, k);
+    if((n->count > BTREE_B) || ((level > 0) && (n->count < BTREE_B / 2)) ||
+       ((n->count > 0) && ((n->keys[0] < lo) || (n->keys[n->count - 1] > hi)))) {
+        return -1;
+    }
+    for(uint32_t i = 1; i < n->count; i++) {
+        if(n->keys[i - 1] >= n->keys[i]) {
+            return -1;
+        }
+    }
+
+    // Leaves are linked in order
+    if(level + 1 == tree->height) {
+        const bool linked = (*leaf == BTREE_NONE) ? (k == tree->first) : (node(tree, *leaf)->next == k);
+        *leaf = k;
+        return linked ? (long)n->count : -1;
+    }
+
+    // Child i has the keys from separator i - 1 up to separator i, and there are at least two children
+    if(n->count == 0) {
+        return -1;
+    }
+    long count = 0;
+    for(uint32_t i = 0; i <= n->count; i++) {
+        const long low   = (i == 0) ? lo : n->keys[i - 1];
+        const long high  = (i == n->count) ? hi : (long)n->keys[i] - 1;
+        const long child = check(tree, n->slots.children[i], level + 1, low, high, leaf);
+        if(child < 0) {
+            return -1;
+        }
+        count += child;
+    }
+    return count;
+}
+
+// Check a whole tree, including that its last leaf is the end of the list
+bool check_tree(const btree_t* tree) {
+    if(tree->root == BTREE_NONE) {
+        return (tree->count == 0) && (tree->height == 0);
+    }
+    uint32_t   leaf  = BTREE_NONE;
+    const long count = check(tree, tree->root, 0, INT_MIN, INT_MAX, &leaf);
+    return (count == (long)tree->count) && (node(tree, leaf)->next == BTREE_NONE);
+}
+
+// Time random lookups in a B+ tree, returning nanoseconds per lookup, and checking the number of hits
+double time_lookups(const btree_t* tree, const int* queries, size_t nhits, bool* ok) {
+    size_t       hits  = 0;
+    int          value = 0;
+    const double start = now();
+    for(size_t i = 0; i < NQUERIES; i++) {
+        hits += btree_find(tree, queries[i], &value) && (value == queries[i] / 2);
+    }
+    const double seconds = now() - start;
+    *ok = *ok && (hits == nhits);
+    return seconds / NQUERIES * 1e9;
+}
+
+// Benchmark random lookups, half of them hits, in trees of 10000 keys up to nkeys, and a range scan of every key,
+// reporting nanoseconds per lookup and per key scanned, and the bytes taken per key
+int benchmark(size_t nkeys) {
+    int* keys    = malloc(nkeys * sizeof(int));
+    int* values  = malloc(nkeys * sizeof(int));
+    int* queries = malloc(NQUERIES * sizeof(int));
+    if((keys == NULL) || (values == NULL) || (queries == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(keys); free(values); free(queries);
+        return EXIT_FAILURE;
+    }
+
+    printf("Nanoseconds per lookup, nanoseconds per key scanned, bytes per key\n");
+    printf("%-12s %12s %12s %12s %12s %12s %12s\n", "keys", "red-black", "b_tree load", "b_tree insert", "scan",
+           "bytes load", "bytes insert");
+    bool passed = true;
+    for(size_t n = 10000; n <= nkeys; n = (n * 10 <= nkeys) || (n == nkeys) ? n * 10 : nkeys) {
+        for(size_t i = 0; i < n; i++) {
+            keys[i]   = (int)(2 * i);
+            values[i] = (int)i;
+        }
+        size_t nhits = 0;
+        for(size_t i = 0; i < NQUERIES; i++) {
+            queries[i] = (int)(((size_t)rand() * ((size_t)RAND_MAX + 1) + (size_t)rand()) % (2 * n));
+            nhits     += (queries[i] % 2 == 0);
+        }
+        printf("%-12zu ", n);
+        fflush(stdout);
+        bool ok = true;
+
+        // The red-black tree built in random order
+        if(n <= BINARY_TREE_MAX) {
+            node_t* root = NULL;
+            shuffle(keys, n);
+            for(size_t i = 0; i < n; i++) {
+                ok = insert(&root, keys[i], compare_data) && ok;
+            }
+            size_t       hits  = 0;
+            const double start = now();
+            for(size_t i = 0; i < NQUERIES; i++) {
+                hits += (search(&root, queries[i], compare_data) != NULL);
+            }
+            printf("%12.1f ", (now() - start) / NQUERIES * 1e9);
+            ok = ok && (hits == nhits);
+            destroy(&root);
+            for(size_t i = 0; i < n; i++) {
+                keys[i] = (int)(2 * i);
+            }
+        } else {
+            printf("%12s ", "-");
+        }
+        fflush(stdout);
+
+        // The B+ tree loaded from sorted keys, which is scanned too
+        btree_t* tree = btree_load(keys, values, n);
+        if(tree == NULL) {
+            free(keys); free(values); free(queries);
+            return EXIT_FAILURE;
+        }
+        printf("%12.1f ", time_lookups(tree, queries, nhits, &ok));
+        fflush(stdout);
+        btree_iterator_t iterator = btree_seek(tree, INT_MIN);
+        int              key      = 0;
+        int              value    = 0;
+        size_t           scanned  = 0;
+        long long        sum      = 0;
+        double           start    = now();
+        while(btree_next(&iterator, &key, &value)) {
+            sum += key - value;
+            scanned++;
+        }
+        const double scan       = (now() - start) / n * 1e9;
+        const double bytes_load = (double)tree->nnodes * sizeof(btree_node_t) / n;
+        ok = ok && (scanned == n) && (sum == (long long)n * (long long)(n - 1) / 2);
+        btree_destroy(&tree);
+
+        // The B+ tree built in random order
+        tree = btree_create();
+        shuffle(keys, n);
+        for(size_t i = 0; (tree != NULL) && (i < n); i++) {
+            ok = btree_insert(tree, keys[i], keys[i] / 2) && ok;
+        }
+        if(tree == NULL) {
+            free(keys); free(values); free(queries);
+            return EXIT_FAILURE;
+        }
+        printf("%12.1f ", time_lookups(tree, queries, nhits, &ok));
+        printf("%12.1f %12.1f %12.1f%s\n", scan, bytes_load, (double)tree->nnodes * sizeof(btree_node_t) / n,
+               ok ? "" : " FAILED");
+        passed = passed && ok;
+        fflush(stdout);
+        btree_destroy(&tree);
+
+        if(n == nkeys) {
+            break;
+        }
+    }
+
+    free(keys); free(values); free(queries);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Verify a tree of keys 0, 3, 6... against what they should be: each key's value, that keys in between are not
+// found, every seek, and a scan of every key in order
+bool verify_tree(const btree_t* tree, size_t n) {
+    bool ok = check_tree(tree) && (tree->count == n);
+    for(size_t i = 0; ok && (i < n); i++) {
+        int value = -1;
+        ok = btree_find(tree, 3 * (int)i, &value) && (value == (int)i) && !btree_find(tree, 3 * (int)i + 1, &value);
+    }
+
+    // Seeking a key finds the next multiple of 3
+    for(int key = -1; ok && (key <= 3 * (int)n); key++) {
+        btree_iterator_t iterator = btree_seek(tree, key);
+        int              found    = 0;
+        int              value    = 0;
+        const int        expected = (key < 0) ? 0 : (key + 2) / 3 * 3;
+        ok = (expected < 3 * (int)n) ? (btree_next(&iterator, &found, &value) && (found == expected))
+                                     : !btree_next(&iterator, &found, &value);
+    }
+
+    btree_iterator_t iterator = btree_seek(tree, INT_MIN);
+    int              key      = 0;
+    int              value    = 0;
+    size_t           count    = 0;
+    while(ok && btree_next(&iterator, &key, &value)) {
+        ok = (key == 3 * (int)count) && (value == (int)count);
+        count++;
+    }
+    return ok && (count == n);
+}
+
+// Delete keys from a tree in the order given, checking the tree as it shrinks, that each key is gone, and at the
+// halfway point that the rest are still there with their values
+bool verify_delete(btree_t* tree, const int* keys, size_t n, int (*value_of)(int)) {
+    // Checking the whole tree after every deletion takes O(n^2), so large trees are checked 100 times
+    const size_t every = (n > 1000) ? n / 100 : 1;
+    const size_t count = tree->count;
+    bool         ok    = true;
+    for(size_t i = 0; ok && (i < n); i++) {
+        int value = 0;
+        ok = btree_delete(tree, keys[i]) && !btree_delete(tree, keys[i]) && !btree_find(tree, keys[i], &value) &&
+             (tree->count == count - i - 1) && ((i % every != 0) || check_tree(tree));
+        for(size_t j = i + 1; ok && (i == n / 2) && (j < n); j++) {
+            ok = btree_find(tree, keys[j], &value) && (value == value_of(keys[j]));
+        }
+    }
+    return ok && check_tree(tree);
+}
+
+// Get the value of a key of a tree being verified, a third of the key
+int third(int key) {
+    return key / 3;
+}
+
+// Get the value of a key inserted into a loaded tree being verified, which is 0
+int zero(int key) {
+    (void)key;
+    return 0;
+}
+
+// Verify trees built by inserting keys in random and in sorted order, with some values replaced, and by loading them,
+// deleting the keys again in random and in sorted order, and keys at the limits of an int
+bool verify(void) {
+    // 931 keys fill 31 leaves and 1 more, which would leave the last internal node with a single child
+    static const size_t sizes[] = { 0, 1, 2, 29, 30, 31, 61, 931, 1000, 100000 };
+
+    for(size_t s = 0; s < NELEMENTS(sizes); s++) {
+        const size_t n      = sizes[s];
+        int*         keys   = malloc((n + 1) * sizeof(int));
+        int*         values = malloc((n + 1) * sizeof(int));
+        if((keys == NULL) || (values == NULL)) {
+            printf("malloc failed: %s", strerror(errno));
+            free(keys); free(values);
+            return false;
+        }
+
+        bool ok = true;
+        for(int sorted = 0; ok && (sorted <= 1); sorted++) {
+            for(size_t i = 0; i < n; i++) {
+                keys[i] = 3 * (int)i;
+            }
+            if(!sorted) {
+                shuffle(keys, n);
+            }
+
+            // Insert every key with the wrong value, then replace every other one and then all of them
+            btree_t* tree = btree_create();
+            for(size_t i = 0; ok && (i < n); i++) {
+                ok = btree_insert(tree, keys[i], -1);
+            }
+            for(size_t i = 0; ok && (i < n); i += 2) {
+                ok = btree_insert(tree, keys[i], keys[i] / 3) && (tree->count == n);
+            }
+            for(size_t i = 0; ok && (i < n); i++) {
+                ok = btree_insert(tree, keys[i], keys[i] / 3);
+            }
+            ok = ok && verify_tree(tree, n);
+
+            // Delete every key in random order, which frees every node, and then reuse the nodes
+            shuffle(keys, n);
+            ok = ok && verify_delete(tree, keys, n, third) && (tree->root == BTREE_NONE) &&
+                 (tree->nspare == tree->nnodes);
+            const size_t nnodes = tree->nnodes;
+            for(size_t i = 0; ok && (i < n); i++) {
+                ok = btree_insert(tree, keys[i], keys[i] / 3);
+            }
+            ok = ok && verify_tree(tree, n) && ((tree->nnodes == nnodes) || (tree->nspare == 0));
+            btree_destroy(&tree);
+        }
+
+        for(size_t i = 0; i < n; i++) {
+            keys[i]   = 3 * (int)i;
+            values[i] = (int)i;
+        }
+        btree_t* tree = btree_load(keys, values, n);
+        ok = ok && (tree != NULL) && verify_tree(tree, n);
+
+        // Keys keep being inserted into a loaded tree, whose nodes are all full
+        for(size_t i = 0; ok && (i < n); i++) {
+            ok = btree_insert(tree, 3 * (int)i + 1, 0);
+        }
+        ok = ok && check_tree(tree) && (tree->count == 2 * n);
+
+        // Delete the keys inserted in random order, which leaves the loaded tree, and then the rest in sorted order
+        for(size_t i = 0; i < n; i++) {
+            values[i] = 3 * (int)i + 1;
+        }
+        shuffle(values, n);
+        ok = ok && verify_delete(tree, values, n, zero) && verify_tree(tree, n) &&
+             verify_delete(tree, keys, n, third) && (tree->root == BTREE_NONE);
+        if(tree != NULL) {
+            btree_destroy(&tree);
+        }
+        free(keys); free(values);
+
+        if(!ok) {
+            printf("Mismatch for %zu keys\n", n);
+            return false;
+        }
+    }
+
+    // The smallest and largest keys
+    btree_t* tree  = btree_create();
+    int      value = 0;
+    bool     ok    = btree_insert(tree, INT_MAX, 1) && btree_insert(tree, INT_MIN, 2) && btree_insert(tree, 0, 3);
+    ok = ok && btree_find(tree, INT_MAX, &value) && (value == 1) && btree_find(tree, INT_MIN, &value) && (value == 2);
+    btree_iterator_t iterator = btree_seek(tree, 1);
+    int              key      = 0;
+    ok = ok && btree_next(&iterator, &key, &value) && (key == INT_MAX) && !btree_next(&iterator, &key, &value);
+    btree_destroy(&tree);
+    if(!ok) {
+        printf("Mismatch for INT_MIN and INT_MAX\n");
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    // Benchmark the tree rather than demonstrating it?
+    if((argc > 1) && (strcmp(argv[1], "benchmark") == 0)) {
+        size_t nkeys = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10000000;
+        return (nkeys >= 10000) ? benchmark(nkeys) : EXIT_FAILURE;
+    }
+
+    // Load a tree from sorted keys, the squares of 0 to 99
+    int keys[100];
+    int values[100];
+    for(size_t i = 0; i < NELEMENTS(keys); i++) {
+        keys[i]   = (int)(i * i);
+        values[i] = (int)i;
+    }
+    btree_t* tree = btree_load(keys, values, NELEMENTS(keys));
+    if(tree == NULL) {
+        return EXIT_FAILURE;
+    }
+    printf("Loaded %zu keys into %zu nodes, %u levels\n", tree->count, tree->nnodes, tree->height);
+
+    // Insert the negative squares
+    for(size_t i = 1; i < NELEMENTS(keys); i++) {
+        btree_insert(tree, -keys[i], -values[i]);
+    }
+    printf("Inserted to make %zu keys in %zu nodes, %u levels\n", tree->count, tree->nnodes, tree->height);
+
+    // Find some keys
+    int find[] = { 49, 50, -81 };
+    for(size_t i = 0; i < NELEMENTS(find); i++) {
+        int value = 0;
+        if(btree_find(tree, find[i], &value)) {
+            printf("Found %d ==> %d\n", find[i], value);
+        } else {
+            printf("Not found %d\n", find[i]);
+        }
+    }
+
+    // Scan a range of keys
+    printf("Keys from -50 to 50:");
+    btree_iterator_t iterator = btree_seek(tree, -50);
+    int              key      = 0;
+    int              value    = 0;
+    while(btree_next(&iterator, &key, &value) && (key <= 50)) {
+        printf(" %d", key);
+    }
+    printf("\n");
+
+    // Delete the negative squares again, which leaves nodes spare for later insertions
+    for(size_t i = 1; i < NELEMENTS(keys); i++) {
+        btree_delete(tree, -keys[i]);
+    }
+    printf("Deleted to leave %zu keys in %zu nodes, %zu of them spare, %u levels\n", tree->count, tree->nnodes,
+           tree->nspare, tree->height);
+    btree_destroy(&tree);
+
+    // Verify the trees
+    const bool ok = verify();
+    printf("\nVerify B+ trees: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -11,20 +11,39 @@
 // This typically executes in log_2(N) time
 //
 // See https://en.wikipedia.org/wiki/Binary_search_algorithm
+// See Khuong and Morin, "Array Layouts for Comparison-Based Searching"
 
-#include <stdio.h>      // For printf
-#include <stdlib.h>     // For EXIT_SUCCESS, bsearch
+#define _POSIX_C_SOURCE 200809L // For posix_memalign
 
-#define NOT_FOUND       -1
-#define NELEMENTS(a)    (sizeof(a) / sizeof(a[0]))
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For bsearch, posix_memalign, free, NULL
+#include <string.h>         // For strerror
+#include "binary_search.h"  // This module
+
+// Size of a cache line, in bytes
+#define CACHE_LINE      64
+
+// Number of lookups that search_batch advances in lockstep, enough to cover the latency of memory with the misses
+// that a core can have outstanding
+#define BATCH           16
+
+// Ranges of at most this many values are finished by interpolation_search with lower_bound
+#define INTERPOLATION_MIN   16
+
+// Number of guesses by interpolation_search that may fail to bracket the key before it falls back to lower_bound
+#define BAD_GUESSES_MAX     1
+
+// Number of values in a cache line, which are the descendants of an Eytzinger node 4 levels down
+#define LINE_VALUES     (CACHE_LINE / sizeof(int))
 
 // Iterative binary search
-int iterative(int *Values, int Key, int Lower, int Upper) {
+int iterative(const int *Values, int Key, int Lower, int Upper) {
     // Continually narrow the search until just one element remains
     while(Upper >= Lower) {
         // Calculate the midpoint to split the set in two
-        int Midpoint = (Upper + Lower) / 2;
-        printf("Key: %d Lower: %d Midpoint %d Upper: %d\n", Key, Lower, Midpoint, Upper);
+        // Beware of simply using (Upper + Lower) / 2 because the Lower + Upper
+        // addition may overflow
+        int Midpoint = Lower + ((Upper - Lower) / 2);
 
         // Is the key at the midpoint?
         if(Key == Values[Midpoint]) {
@@ -46,7 +65,7 @@ int iterative(int *Values, int Key, int Lower, int Upper) {
 }
 
 // Recursive binary search
-int recursive(int *Values, int Key, int Lower, int Upper) {
+int recursive(const int *Values, int Key, int Lower, int Upper) {
     // Are there no more elements remaining?
     if(Upper < Lower) {
         return NOT_FOUND;
@@ -54,8 +73,9 @@ int recursive(int *Values, int Key, int Lower, int Upper) {
     // There is at least 1 remaining element
     else {
         // Calculate the midpoint to split the set in two
-        int Midpoint = (Upper + Lower) / 2;
-        printf("Key: %d Lower: %d Midpoint %d Upper: %d\n", Key, Lower, Midpoint, Upper);
+        // Beware of simply using (Upper + Lower) / 2 because the Lower + Upper
+        // addition may overflow
+        int Midpoint = Lower + ((Upper - Lower) / 2);
 
         // Is the key at the midpoint?
         if(Key == Values[Midpoint]) {
@@ -75,7 +95,7 @@ int recursive(int *Values, int Key, int Lower, int Upper) {
 }
 
 // Recursive binary search (implementation ends with a 2 element set)
-int recursive2(int *Values, int Key, int Lower, int Upper) {
+int recursive2(const int *Values, int Key, int Lower, int Upper) {
     // Has the search been reduced as far as practical?
     //
     // The smallest set ideally contains 1 element, in which case the tests
@@ -107,8 +127,6 @@ int recursive2(int *Values, int Key, int Lower, int Upper) {
         // addition may overflow
         int Midpoint = Lower + ((Upper - Lower) / 2);
 
-        printf("Key: %d Lower: %d Midpoint %d Upper: %d\n", Key, Lower, Midpoint, Upper);
-
         // Is the key within the range of the upper set?
         if(Key >= Values[Midpoint]) {
             // Continue search in the upper set
@@ -122,11 +140,9 @@ int recursive2(int *Values, int Key, int Lower, int Upper) {
 }
 
 // Comparison function used with bsearch
-int Compare(const void *Key, const void *Value) {
-    int key   = *(int *) Key;
-    int value = *(int *) Value;
-
-    printf("Key: %d Value: %d\n", key, value);
+static int Compare(const void *Key, const void *Value) {
+    int key   = *(const int *) Key;
+    int value = *(const int *) Value;
 
     if(key < value) {
         return -1;
@@ -140,8 +156,8 @@ int Compare(const void *Key, const void *Value) {
 }
 
 // Binary search using the built-in function from the C library
-int builtin(int *Values, size_t NumElements, int *Key) {
-    int *Match = (int *)bsearch(Key, Values, NumElements, sizeof(Values[0]), Compare);
+int builtin(const int *Values, size_t NumElements, const int *Key) {
+    const int *Match = (const int *)bsearch(Key, Values, NumElements, sizeof(Values[0]), Compare);
     if(Match != NULL) {
         return Match - Values;
     }
@@ -150,42 +166,269 @@ int builtin(int *Values, size_t NumElements, int *Key) {
     }
 }
 
-int main(void) {
-    int Values[] = { 1, 2, 3, 4, 5, 7, 8, 9, 11, 13, 16, 17, 23, 27, 29, 32, 31, 37, 64, 81 };
-    int Key      = NOT_FOUND;
-    int Index    = NOT_FOUND;
+// Find the first value not less than a key, using a branchless binary search with prefetching
+size_t lower_bound(const int* values, size_t nvalues, int key) {
+    if((values == NULL) || (nvalues == 0)) {
+        return 0;
+    }
+
+    // Halve the range each time, moving the base up by half if the last value of the lower half, base[half - 1], is
+    // still less than the key. The range shrinks by the same amount either way, so the only data dependency is on the
+    // base. The next probe is at next - 1 from either base, or there is none when next is 0.
+    const int* base = values;
+    size_t     n    = nvalues;
+    while(n > 1) {
+        const size_t half = n / 2;
+        const size_t next = (n - half) / 2;
+        const size_t skew = (next > 0);
+        __builtin_prefetch(base + next - skew);
+        __builtin_prefetch(base + half + next - skew);
+        base += (base[half - 1] < key) * half;
+        n    -= half;
+    }
+    return (size_t)(base - values) + (*base < key);
+}
+
+// Find the index of each of many keys in a sorted array, searching a group of keys at a time in lockstep
+void search_batch(const int* values, size_t nvalues, const int* keys, size_t nkeys, int* indices) {
+    if((values == NULL) || (keys == NULL) || (indices == NULL)) {
+        return;
+    }
+    if(nvalues == 0) {
+        for(size_t i = 0; i < nkeys; i++) {
+            indices[i] = NOT_FOUND;
+        }
+        return;
+    }
+
+    for(size_t first = 0; first < nkeys; first += BATCH) {
+        const size_t nlanes = (nkeys - first < BATCH) ? nkeys - first : BATCH;
+        const int*   key    = keys + first;
+        const int*   base[BATCH];
+        for(size_t lane = 0; lane < nlanes; lane++) {
+            base[lane] = values;
+        }
+
+        // As in lower_bound, but every lane has the same range size at each step, so one loop steps them all. Once a
+        // lane has taken its step its next probe is known exactly, so only that one is prefetched.
+        size_t n = nvalues;
+        while(n > 1) {
+            const size_t half = n / 2;
+            const size_t next = (n - half) / 2;
+            const size_t skew = (next > 0);
+            for(size_t lane = 0; lane < nlanes; lane++) {
+                base[lane] += (base[lane][half - 1] < key[lane]) * half;
+                __builtin_prefetch(base[lane] + next - skew);
+            }
+            n -= half;
+        }
+
+        // The lower bound is the index if it holds the key
+        for(size_t lane = 0; lane < nlanes; lane++) {
+            const size_t index = (size_t)(base[lane] - values) + (*base[lane] < key[lane]);
+            indices[first + lane] = ((index < nvalues) && (values[index] == key[lane])) ? (int)index : NOT_FOUND;
+        }
+    }
+}
+
+// Get the number of bits needed to hold a (non-zero) size
+static inline unsigned bit_width(size_t size) {
+    return 64 - (unsigned)__builtin_clzll((unsigned long long)size);
+}
+
+// Find the first value not less than a key using interpolation search, falling back to binary search
+size_t interpolation_search(const int* values, size_t nvalues, int key, size_t* probes) {
+    if((values == NULL) || (nvalues == 0)) {
+        return 0;
+    }
+
+    // The key must be between the first and last values to interpolate
+    size_t count = 2;
+    size_t found;
+    if(key <= values[0]) {
+        found = 0;
+    }
+    else if(key > values[nvalues - 1]) {
+        found = nvalues;
+    }
+    else {
+        // Values at a are less than the key and those at b are not, so the first not less is in (a, b]
+        size_t a   = 0;
+        size_t b   = nvalues - 1;
+        int    va  = values[a];
+        int    vb  = values[b];
+        int    bad = 0;
+        while((b - a > INTERPOLATION_MIN) && (bad <= BAD_GUESSES_MAX)) {
+            // Guess in proportion to where the key falls between the bounds
+            const size_t size     = b - a;
+            const double fraction = ((double)key - va) / ((double)vb - va);
+            size_t       guess    = a + 1 + (size_t)(fraction * (double)(size - 1));
+            guess = (guess < b) ? guess : b - 1;
+
+            // Probe the guess, then about twice the typical error beyond it towards the key
+            const size_t gap = (size_t)2 << (bit_width(size) / 2);
+            count++;
+            if(values[guess] < key) {
+                a  = guess;
+                va = values[a];
+                if(a + gap < b) {
+                    count++;
+                    if(values[a + gap] < key) {
+                        a  = a + gap;
+                        va = values[a];
+                    }
+                    else {
+                        b  = a + gap;
+                        vb = values[b];
+                    }
+                }
+            }
+            else {
+                b  = guess;
+                vb = values[b];
+                if(b > a + gap) {
+                    count++;
+                    if(values[b - gap] < key) {
+                        a  = b - gap;
+                        va = values[a];
+                    }
+                    else {
+                        b  = b - gap;
+                        vb = values[b];
+                    }
+                }
+            }
+            bad += (b - a > gap);
+        }
+
+        // Binary search whatever is left, of m = b - a - 1 values before b, in about log2 m + 1 probes
+        const size_t left = b - a - 1;
+        found  = a + 1 + lower_bound(values + a + 1, left, key);
+        count += (left > 1) ? bit_width(left - 1) + 1 : left;
+    }
+
+    if(probes != NULL) {
+        *probes += count;
+    }
+    return found;
+}
+
+// Find the first value not less than a key using exponential (galloping) search from the start
+size_t exponential_search(const int* values, size_t nvalues, int key) {
+    if((values == NULL) || (nvalues == 0)) {
+        return 0;
+    }
+
+    // Double the bound until the value before it is not less than the key, or it passes the end
+    size_t bound = 1;
+    while((bound < nvalues) && (values[bound - 1] < key)) {
+        bound *= 2;
+    }
+
+    // The value before the previous bound was less than the key
+    const size_t lo = bound / 2;
+    const size_t hi = (bound < nvalues) ? bound : nvalues;
+    return lo + lower_bound(values + lo, hi - lo, key);
+}
+
+// Find the first value not less than a key in a sorted source of unknown length, using exponential search
+size_t exponential_search_unbounded(bool (*read)(void* context, size_t index, int* value), void* context, int key) {
+    if(read == NULL) {
+        return 0;
+    }
+
+    // Double the bound until the value before it is not less than the key, or is past the end
+    int    value;
+    size_t bound = 1;
+    while(read(context, bound - 1, &value) && (value < key)) {
+        bound *= 2;
+    }
+
+    // Binary search the gap, treating the end as a value greater than any key
+    size_t lo = bound / 2;
+    size_t hi = bound - 1;
+    while(lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if(read(context, mid, &value) && (value < key)) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Copy sorted values into the Eytzinger layout, by an in-order walk of the tree rooted at index k, returning the index
+// of the next value to copy
+static size_t eytzinger_build(int* layout, size_t nvalues, const int* values, size_t i, size_t k) {
+    if(k <= nvalues) {
+        i = eytzinger_build(layout, nvalues, values, i, 2*k);
+        layout[k] = values[i++];
+        i = eytzinger_build(layout, nvalues, values, i, 2*k + 1);
+    }
+    return i;
+}
 
-    Key = 3;
-    Index = iterative(Values, Key, 0, NELEMENTS(Values) - 1);
-    printf("Iterative: %d ==> %d\n\n", Key, Index);
+// Create the Eytzinger layout of a sorted array of values
+eytzinger_t* eytzinger_create(const int* values, size_t nvalues) {
+    if((values == NULL) || (nvalues == 0)) {
+        printf("Bad arguments\n");
+        return NULL;
+    }
 
-    Key = 14;
-    Index = iterative(Values, Key, 0, NELEMENTS(Values) - 1);
-    printf("Iterative: %d ==> %d\n\n", Key, Index);
+    eytzinger_t* eytzinger = malloc(sizeof(eytzinger_t));
+    if(eytzinger == NULL) {
+        printf("Failed to allocate struct\n");
+        return NULL;
+    }
 
-    Key = 3;
-    Index = recursive(Values, Key, 0, NELEMENTS(Values) - 1);
-    printf("Recursive: %d ==> %d\n\n", Key, Index);
+    // Index 0 is unused, so that the root is at index 1 and each group of 16 siblings starts on a cache line
+    void*        layout = NULL;
+    const size_t bytes  = (nvalues + 1) * sizeof(int);
+    const int    error  = posix_memalign(&layout, CACHE_LINE, (bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE);
+    if(error != 0) {
+        printf("posix_memalign failed: %s", strerror(error));
+        free(eytzinger);
+        return NULL;
+    }
 
-    Key = 14;
-    Index = recursive(Values, Key, 0, NELEMENTS(Values) - 1);
-    printf("Recursive: %d ==> %d\n\n", Key, Index);
+    eytzinger->nvalues   = nvalues;
+    eytzinger->values    = layout;
+    eytzinger->values[0] = 0;
+    eytzinger_build(eytzinger->values, nvalues, values, 0, 1);
+    return eytzinger;
+}
 
-    Key = 3;
-    Index = recursive2(Values, Key, 0, NELEMENTS(Values) - 1);
-    printf("Recursive 2: %d ==> %d\n\n", Key, Index);
+// Destroy an Eytzinger layout
+void eytzinger_destroy(eytzinger_t** eytzinger) {
+    if((eytzinger == NULL) || (*eytzinger == NULL)) {
+        printf("Bad Eytzinger layout\n");
+        return;
+    }
 
-    Key = 14;
-    Index = recursive2(Values, Key, 0, NELEMENTS(Values) - 1);
-    printf("Recursive 2: %d ==> %d\n\n", Key, Index);
+    free((*eytzinger)->values);
+    free(*eytzinger);
+    *eytzinger = NULL;
+}
 
-    Key = 3;
-    Index = builtin(Values, NELEMENTS(Values), &Key);
-    printf("Built-in: %d ==> %d\n\n", Key, Index);
+// Find the first value not less than a key in an Eytzinger layout
+size_t eytzinger_lower_bound(const eytzinger_t* eytzinger, int key) {
+    if(eytzinger == NULL) {
+        return 0;
+    }
 
-    Key = 14;
-    Index = builtin(Values, NELEMENTS(Values), &Key);
-    printf("Built-in: %d ==> %d\n\n", Key, Index);
+    // Descend to the left child if the value is not less than the key, otherwise to the right, prefetching the cache
+    // line that holds the node's 16 descendants 4 levels down. The prefetch may be past the end, which is harmless.
+    const int*   values  = eytzinger->values;
+    const size_t nvalues = eytzinger->nvalues;
+    size_t       k       = 1;
+    while(k <= nvalues) {
+        __builtin_prefetch(values + LINE_VALUES * k);
+        k = 2*k + (values[k] < key);
+    }
 
-    return EXIT_SUCCESS;
+    // The path went right after the last node not less than the key and left ever since, so undo those lefts and the
+    // one right. If the path only ever went right, every value is less than the key and this leaves 0.
+    return k >> __builtin_ffsll((long long)~k);
 }
@@ -0,0 +1,184 @@
+// Find the position of a target value (a key) in a sorted array using a binary
+// search.
+//
+// Compare the target value to the value at the middle element of the set.
+// If equal, return the position of the middle element. If the target value is
+// smaller than the value at the middle element then continue the search in the
+// lower half of the set, otherwise continue the search in the upper half of the
+// set. Repeat until the target value is found or there are no more elements
+// left to search, in which case the target value is not present in the set.
+//
+// This typically executes in log_2(N) time
+//
+// iterative, recursive and recursive2 are the textbook versions. Each probe branches on the comparison, which the CPU
+// cannot predict, and on a large array each probe is also a cache miss that the CPU cannot start until the comparison
+// before it is resolved.
+//
+// lower_bound is branchless: the loop runs a fixed number of times for a given number of values, and the comparison
+// only picks which half to keep with a conditional move. Since the CPU no longer waits on the comparison to know what
+// comes next, it prefetches both of the possible next probes, a quarter and three quarters of the way through the
+// range, so that the cache miss for the next probe overlaps with this one.
+//
+// search_batch runs many independent lookups in the same array. It advances a group of them in lockstep, one probe
+// each per step, prefetching each one's next probe as soon as it is known. By the time the step comes back around to
+// it, the value has usually arrived, so the cache misses of the group overlap rather than following one another.
+//
+// interpolation_search guesses where the key is from its value, assuming the values between the two known bounds are
+// evenly spread, as sorted timestamps roughly are. On such data the guess is typically within about sqrt(n) of the
+// key, so after each guess it also probes that far beyond it, on the side of the key. If the key is bracketed, the
+// range left is about sqrt(n), and a range of n values takes O(log log n) probes. A guess that fails to bracket the
+// key is a bad guess, and after two of them (on skewed data) the search finishes with lower_bound, so the worst case
+// is O(log n), at most 6 probes more than lower_bound. Those probes are dependent cache misses, so on skewed data it is
+// slower than lower_bound, which should be used unless the values are known to be roughly evenly spread.
+//
+// exponential_search gallops: it probes at indices 0, 1, 3, 7, 15... until it passes the key, then binary searches the
+// last gap, so that finding a key at index i takes O(log i) probes however many values there are. The unbounded
+// version reads the values through a function, for sources whose end is not known in advance e.g. a sorted stream or
+// file, for which it never needs to find the end.
+//
+// The Eytzinger layout stores the sorted values in the order of a breadth-first walk of a binary search tree, as in
+// a binary heap: the root at index 1 and the children of index k at 2k and 2k + 1. The first few levels of the tree
+// are then packed together at the start of the array, where they stay in the cache, and the 16 descendants 4 levels
+// below any node are adjacent in one cache line, which can be prefetched 4 probes ahead.
+//
+// See https://en.wikipedia.org/wiki/Binary_search_algorithm
+// See Khuong and Morin, "Array Layouts for Comparison-Based Searching"
+
+#ifndef BINARY_SEARCH_H
+#define BINARY_SEARCH_H
+
+#include <stdbool.h>    // For bool
+#include <stddef.h>     // For size_t
+
+#define NOT_FOUND   -1
+
+// Sorted values in the Eytzinger (breadth-first) layout.
+//
+// Fields:
+//  nvalues : number of values.
+//  values  : values at indices 1 to nvalues, with the children of index k at 2k and 2k + 1, allocated on the heap
+//            aligned to a cache line.
+typedef struct eytzinger_t {
+    size_t nvalues;
+    int*   values;
+} eytzinger_t;
+
+// Iterative binary search.
+//
+// Parameters:
+//  Values : pointer to the sorted array of values.
+//  Key    : value to find.
+//  Lower  : index of the first value to search, 0 to begin with.
+//  Upper  : index of the last value to search (inclusive), the number of values - 1 to begin with.
+//
+// Returns:
+//  the index of a value equal to the key, or NOT_FOUND.
+int iterative(const int *Values, int Key, int Lower, int Upper);
+
+// Recursive binary search.
+//
+// Parameters and return value as for iterative.
+int recursive(const int *Values, int Key, int Lower, int Upper);
+
+// Recursive binary search, which ends with a 2 element set.
+//
+// Parameters and return value as for iterative.
+int recursive2(const int *Values, int Key, int Lower, int Upper);
+
+// Binary search using the built-in function from the C library.
+//
+// Parameters:
+//  Values      : pointer to the sorted array of values.
+//  NumElements : number of values in the array.
+//  Key         : pointer to the value to find.
+//
+// Returns:
+//  the index of a value equal to the key, or NOT_FOUND.
+int builtin(const int *Values, size_t NumElements, const int *Key);
+
+// Find the first value not less than a key, using a branchless binary search with prefetching.
+//
+// Parameters:
+//  values  : pointer to the sorted array of values.
+//  nvalues : number of values in the array.
+//  key     : value to find.
+//
+// Returns:
+//  the index of the first value greater than or equal to the key, or nvalues if every value is less than it.
+size_t lower_bound(const int* values, size_t nvalues, int key);
+
+// Find the index of each of many keys in a sorted array, searching a group of keys at a time in lockstep.
+//
+// Parameters:
+//  values  : pointer to the sorted array of values, of no more than INT_MAX values.
+//  nvalues : number of values in the array.
+//  keys    : pointer to the values to find, in any order.
+//  nkeys   : number of keys.
+//  indices : pointer into which the index of each key will be written, as for iterative i.e. the index of a value
+//            equal to the key (the first, if it is repeated), or NOT_FOUND.
+void search_batch(const int* values, size_t nvalues, const int* keys, size_t nkeys, int* indices);
+
+// Find the first value not less than a key using interpolation search, falling back to binary search.
+//
+// Parameters:
+//  values  : pointer to the sorted array of values.
+//  nvalues : number of values in the array.
+//  key     : value to find.
+//  probes  : pointer to a count to which the number of values compared with the key is added, or NULL.
+//
+// Returns:
+//  the index of the first value greater than or equal to the key, or nvalues if every value is less than it.
+size_t interpolation_search(const int* values, size_t nvalues, int key, size_t* probes);
+
+// Find the first value not less than a key using exponential (galloping) search from the start.
+//
+// Parameters:
+//  values  : pointer to the sorted array of values.
+//  nvalues : number of values in the array.
+//  key     : value to find.
+//
+// Returns:
+//  the index of the first value greater than or equal to the key, or nvalues if every value is less than it.
+size_t exponential_search(const int* values, size_t nvalues, int key);
+
+// Find the first value not less than a key in a sorted source of unknown length, using exponential search.
+//
+// Parameters:
+//  read    : function to read the value at an index of the source, returning false if the index is past the end.
+//  context : pointer passed to read e.g. the source.
+//  key     : value to find.
+//
+// Returns:
+//  the index of the first value greater than or equal to the key, or the number of values if every value is less than
+//  it.
+size_t exponential_search_unbounded(bool (*read)(void* context, size_t index, int* value), void* context, int key);
+
+// Create the Eytzinger layout of a sorted array of values, in O(n).
+//
+// Parameters:
+//  values  : pointer to the sorted array of values.
+//  nvalues : number of values in the array.
+//
+// Returns:
+//  pointer to the layout or NULL if the arguments are bad or memory could not be allocated.
+eytzinger_t* eytzinger_create(const int* values, size_t nvalues);
+
+// Destroy an Eytzinger layout.
+//
+// Parameters:
+//  eytzinger : pointer to pointer to the layout.
+void eytzinger_destroy(eytzinger_t** eytzinger);
+
+// Find the first value not less than a key in an Eytzinger layout, branchlessly with prefetching.
+//
+// Parameters:
+//  eytzinger : pointer to the layout.
+//  key       : value to find.
+//
+// Returns:
+//  the index in the layout (from 1 to nvalues) of the first value greater than or equal to the key i.e.
+//  eytzinger->values[index] is the same value as lower_bound finds in the sorted array, or 0 if every value is less
+//  than the key.
+size_t eytzinger_lower_bound(const eytzinger_t* eytzinger, int key);
+
+#endif // BINARY_SEARCH_H
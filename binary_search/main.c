@@ -0,0 +1,397 @@
+// Find the position of a target value (a key) in a sorted array using a binary
+// search.
+//
+// The searches are benchmarked on random lookups in arrays of increasing size, up to one much larger than the cache,
+// reporting nanoseconds per lookup, with:
+//
+//  ./binary_search benchmark [largest number of values]
+//
+// Interpolation and exponential search are benchmarked against lower_bound on evenly spread, timestamp-like, skewed
+// and adversarial values, reporting nanoseconds and probes per lookup, with:
+//
+//  ./binary_search interpolation [number of values]
+//
+// See https://en.wikipedia.org/wiki/Binary_search_algorithm
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include <errno.h>          // For errno
+#include <stdbool.h>        // For bool, true, false
+#include <limits.h>         // For INT_MAX
+#include <stdint.h>         // For uint64_t
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For EXIT_SUCCESS, EXIT_FAILURE, malloc, free, rand, strtoul
+#include <string.h>         // For strcmp, strerror
+#include <time.h>           // For clock_gettime
+#include "binary_search.h"  // For iterative, recursive, recursive2, builtin, lower_bound, search_batch,
+                            // interpolation_search, exponential_search, eytzinger_t
+#include "s_tree.h"         // For stree_t, stree_create, stree_lower_bound, stree_destroy
+
+#define NELEMENTS(a)    (sizeof(a) / sizeof(a[0]))
+
+// Number of random lookups timed for each size of array
+#define NQUERIES        1000000
+
+// Patterns of sorted values for interpolation search
+typedef enum pattern_t {
+    LINEAR,         // evenly spread
+    TIMESTAMPS,     // random gaps, as between events
+    SKEWED,         // growing as the cube of the index
+    OUTLIER,        // evenly spread but for one very large last value, which defeats interpolation
+    NPATTERNS
+} pattern_t;
+
+// A sorted source of unknown length, counting the values read from it
+typedef struct source_t {
+    const int* values;
+    size_t     nvalues;
+    size_t     reads;
+} source_t;
+
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Fill an array with a pattern of sorted values
+void fill(int* values, size_t nvalues, pattern_t pattern) {
+    int value = 0;
+    for(size_t i = 0; i < nvalues; i++) {
+        const double x = (double)i / nvalues;
+        switch(pattern) {
+            case LINEAR:     values[i] = (int)(2 * i);                      break;
+            case TIMESTAMPS: values[i] = (value += rand() % 64);            break;
+            case SKEWED:     values[i] = (int)(x * x * x * 2e9);            break;
+            default:         values[i] = (int)i;                            break;
+        }
+    }
+    if(pattern == OUTLIER) {
+        values[nvalues - 1] = INT_MAX;
+    }
+}
+
+// Get the name of a pattern
+const char* pattern_name(pattern_t pattern) {
+    static const char* names[NPATTERNS] = { "linear", "timestamps", "skewed", "outlier" };
+    return names[pattern];
+}
+
+// Read a value from a source of unknown length, counting the reads
+bool source_read(void* context, size_t index, int* value) {
+    source_t* source = context;
+    source->reads++;
+    if(index >= source->nvalues) {
+        return false;
+    }
+    *value = source->values[index];
+    return true;
+}
+
+// Benchmark lookups of values, or one more than values, in each pattern, reporting nanoseconds and probes per lookup
+int benchmark_interpolation(size_t nvalues) {
+    int*    values  = malloc(nvalues * sizeof(int));
+    int*    queries = malloc(NQUERIES * sizeof(int));
+    size_t* indices = malloc(NQUERIES * sizeof(size_t));
+    if((values == NULL) || (queries == NULL) || (indices == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(values); free(queries); free(indices);
+        return EXIT_FAILURE;
+    }
+
+    printf("%zu values, nanoseconds (probes) per lookup\n", nvalues);
+    printf("%-12s %12s %20s %20s\n", "pattern", "lower_bound", "interpolation", "exponential");
+    bool passed = true;
+    for(pattern_t pattern = 0; pattern < NPATTERNS; pattern++) {
+        fill(values, nvalues, pattern);
+        for(size_t i = 0; i < NQUERIES; i++) {
+            const int value = values[(size_t)rand() % nvalues];
+            queries[i] = value + ((value < INT_MAX) && (rand() % 2));
+        }
+        printf("%-12s ", pattern_name(pattern));
+
+        // lower_bound makes ceil(log2 n) + 1 probes whatever the values
+        size_t depth = 0;
+        while(((size_t)1 << depth) < nvalues) {
+            depth++;
+        }
+        double start = now();
+        for(size_t i = 0; i < NQUERIES; i++) {
+            indices[i] = lower_bound(values, nvalues, queries[i]);
+        }
+        printf("%5.1f (%4zu) ", (now() - start) / NQUERIES * 1e9, depth + 1);
+
+        bool   ok     = true;
+        size_t probes = 0;
+        start = now();
+        for(size_t i = 0; i < NQUERIES; i++) {
+            ok = ok && (interpolation_search(values, nvalues, queries[i], &probes) == indices[i]);
+        }
+        printf("%12.1f (%4.1f)%s ", (now() - start) / NQUERIES * 1e9, (double)probes / NQUERIES, ok ? "" : " FAILED");
+
+        // Probes are counted by reading from a source, but exponential search of the array is what is timed
+        source_t source = { values, nvalues, 0 };
+        start = now();
+        for(size_t i = 0; i < NQUERIES; i++) {
+            ok = ok && (exponential_search(values, nvalues, queries[i]) == indices[i]);
+        }
+        const double seconds = now() - start;
+        for(size_t i = 0; i < NQUERIES; i++) {
+            ok = ok && (exponential_search_unbounded(source_read, &source, queries[i]) == indices[i]);
+        }
+        printf("%12.1f (%4.1f)%s\n", seconds / NQUERIES * 1e9, (double)source.reads / NQUERIES, ok ? "" : " FAILED");
+        passed = passed && ok;
+        fflush(stdout);
+    }
+
+    free(values); free(queries); free(indices);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Benchmark random lookups, half of them hits, in arrays of 1000 values up to nvalues, reporting nanoseconds per
+// lookup. Each search sums the keys it finds, which must agree.
+int benchmark(size_t nvalues) {
+    int* values  = malloc(nvalues * sizeof(int));
+    int* queries = malloc(NQUERIES * sizeof(int));
+    int* indices = malloc(NQUERIES * sizeof(int));
+    if((values == NULL) || (queries == NULL) || (indices == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(values); free(queries); free(indices);
+        return EXIT_FAILURE;
+    }
+
+    printf("Nanoseconds per lookup\n");
+    printf("%-12s %12s %12s %12s %12s %12s %12s\n", "values", "bsearch", "iterative", "lower_bound", "search_batch",
+           "eytzinger", "s_tree");
+    bool passed = true;
+    for(size_t n = 1000; n <= nvalues; n = (n * 10 <= nvalues) || (n == nvalues) ? n * 10 : nvalues) {
+        for(size_t i = 0; i < n; i++) {
+            values[i] = (int)(2 * i);
+        }
+        for(size_t i = 0; i < NQUERIES; i++) {
+            queries[i] = (int)((size_t)rand() % (2 * n));
+        }
+        eytzinger_t* eytzinger = eytzinger_create(values, n);
+        stree_t*     tree      = stree_create(values, n);
+        if((eytzinger == NULL) || (tree == NULL)) {
+            if(eytzinger != NULL) {
+                eytzinger_destroy(&eytzinger);
+            }
+            free(values); free(queries); free(indices);
+            return EXIT_FAILURE;
+        }
+        printf("%-12zu ", n);
+
+        uint64_t expected = 0;
+        double   start    = now();
+        for(size_t i = 0; i < NQUERIES; i++) {
+            const int index = builtin(values, n, &queries[i]);
+            expected += (index != NOT_FOUND) ? (uint64_t)values[index] : 0;
+        }
+        printf("%12.1f ", (now() - start) / NQUERIES * 1e9);
+
+        uint64_t found = 0;
+        start = now();
+        for(size_t i = 0; i < NQUERIES; i++) {
+            const int index = iterative(values, queries[i], 0, (int)n - 1);
+            found += (index != NOT_FOUND) ? (uint64_t)values[index] : 0;
+        }
+        printf("%12.1f%s ", (now() - start) / NQUERIES * 1e9, (found == expected) ? "" : " FAILED");
+        passed = passed && (found == expected);
+
+        found = 0;
+        start = now();
+        for(size_t i = 0; i < NQUERIES; i++) {
+            const size_t index = lower_bound(values, n, queries[i]);
+            found += ((index < n) && (values[index] == queries[i])) ? (uint64_t)values[index] : 0;
+        }
+        printf("%12.1f%s ", (now() - start) / NQUERIES * 1e9, (found == expected) ? "" : " FAILED");
+        passed = passed && (found == expected);
+
+        found = 0;
+        start = now();
+        search_batch(values, n, queries, NQUERIES, indices);
+        for(size_t i = 0; i < NQUERIES; i++) {
+            found += (indices[i] != NOT_FOUND) ? (uint64_t)values[indices[i]] : 0;
+        }
+        printf("%12.1f%s ", (now() - start) / NQUERIES * 1e9, (found == expected) ? "" : " FAILED");
+        passed = passed && (found == expected);
+
+        found = 0;
+        start = now();
+        for(size_t i = 0; i < NQUERIES; i++) {
+            const size_t index = eytzinger_lower_bound(eytzinger, queries[i]);
+            found += ((index > 0) && (eytzinger->values[index] == queries[i])) ? (uint64_t)queries[i] : 0;
+        }
+        printf("%12.1f%s ", (now() - start) / NQUERIES * 1e9, (found == expected) ? "" : " FAILED");
+        passed = passed && (found == expected);
+
+        found = 0;
+        start = now();
+        for(size_t i = 0; i < NQUERIES; i++) {
+            const size_t index = stree_lower_bound(tree, queries[i]);
+            found += ((index != STREE_NONE) && (tree->keys[index] == queries[i])) ? (uint64_t)queries[i] : 0;
+        }
+        printf("%12.1f%s\n", (now() - start) / NQUERIES * 1e9, (found == expected) ? "" : " FAILED");
+        passed = passed && (found == expected);
+        fflush(stdout);
+
+        eytzinger_destroy(&eytzinger);
+        stree_destroy(&tree);
+        if(n == nvalues) {
+            break;
+        }
+    }
+
+    free(values); free(queries); free(indices);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Verify every search against a linear scan, for every key in and around arrays of a range of sizes, with and
+// without repeated values
+bool verify(void) {
+    static const size_t sizes[] = { 1, 2, 3, 4, 5, 15, 16, 17, 31, 32, 33, 100, 1000, 4097 };
+
+    for(size_t s = 0; s < NELEMENTS(sizes); s++) {
+        for(int repeats = 1; repeats <= 3; repeats++) {
+            const size_t n      = sizes[s];
+            const int    nkeys  = 2 * (int)n + 2;
+            int*         values = malloc(n * sizeof(int));
+            int*         keys   = malloc((size_t)nkeys * sizeof(int));
+            int*         batch  = malloc((size_t)nkeys * sizeof(int));
+            if((values == NULL) || (keys == NULL) || (batch == NULL)) {
+                printf("malloc failed: %s", strerror(errno));
+                free(values); free(keys); free(batch);
+                return false;
+            }
+            for(size_t i = 0; i < n; i++) {
+                values[i] = 2 * (int)(i / (size_t)repeats);
+            }
+            for(int i = 0; i < nkeys; i++) {
+                keys[i] = i - 1;
+            }
+            search_batch(values, n, keys, (size_t)nkeys, batch);
+            eytzinger_t* eytzinger = eytzinger_create(values, n);
+            stree_t*     tree      = stree_create(values, n);
+
+            bool ok = (eytzinger != NULL) && (tree != NULL);
+            for(int key = -1; ok && (key <= values[n - 1] + 1); key++) {
+                size_t expected = 0;
+                while((expected < n) && (values[expected] < key)) {
+                    expected++;
+                }
+                const bool present = (expected < n) && (values[expected] == key);
+
+                const int found[] = { iterative(values, key, 0, (int)n - 1), recursive(values, key, 0, (int)n - 1),
+                                      recursive2(values, key, 0, (int)n - 1), builtin(values, n, &key) };
+                for(size_t i = 0; ok && (i < NELEMENTS(found)); i++) {
+                    ok = present ? ((found[i] != NOT_FOUND) && (values[found[i]] == key)) : (found[i] == NOT_FOUND);
+                }
+                ok = ok && (batch[key + 1] == (present ? (int)expected : NOT_FOUND));
+
+                const size_t index = eytzinger_lower_bound(eytzinger, key);
+                ok = ok && (lower_bound(values, n, key) == expected) &&
+                     ((expected < n) ? ((index > 0) && (eytzinger->values[index] == values[expected])) : (index == 0));
+
+                source_t source = { values, n, 0 };
+                ok = ok && (interpolation_search(values, n, key, NULL) == expected) &&
+                     (exponential_search(values, n, key) == expected) &&
+                     (exponential_search_unbounded(source_read, &source, key) == expected);
+
+                const size_t node = stree_lower_bound(tree, key);
+                ok = ok && ((expected < n) ? ((node != STREE_NONE) && (tree->keys[node] == values[expected]))
+                                           : (node == STREE_NONE));
+            }
+            if(eytzinger != NULL) {
+                eytzinger_destroy(&eytzinger);
+            }
+            if(tree != NULL) {
+                stree_destroy(&tree);
+            }
+            free(values); free(keys); free(batch);
+
+            if(!ok) {
+                printf("Mismatch for %zu values each repeated %d times\n", n, repeats);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    // Benchmark the searches rather than demonstrating them?
+    if((argc > 1) && (strcmp(argv[1], "benchmark") == 0)) {
+        size_t nvalues = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10000000;
+        return (nvalues >= 1000) ? benchmark(nvalues) : EXIT_FAILURE;
+    }
+    if((argc > 1) && (strcmp(argv[1], "interpolation") == 0)) {
+        size_t nvalues = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10000000;
+        return (nvalues >= 2) ? benchmark_interpolation(nvalues) : EXIT_FAILURE;
+    }
+
+    int Values[] = { 1, 2, 3, 4, 5, 7, 8, 9, 11, 13, 16, 17, 23, 27, 29, 31, 32, 37, 64, 81 };
+    int Key      = NOT_FOUND;
+    int Index    = NOT_FOUND;
+
+    Key = 3;
+    Index = iterative(Values, Key, 0, NELEMENTS(Values) - 1);
+    printf("Iterative: %d ==> %d\n", Key, Index);
+
+    Key = 14;
+    Index = iterative(Values, Key, 0, NELEMENTS(Values) - 1);
+    printf("Iterative: %d ==> %d\n\n", Key, Index);
+
+    Key = 3;
+    Index = recursive(Values, Key, 0, NELEMENTS(Values) - 1);
+    printf("Recursive: %d ==> %d\n", Key, Index);
+
+    Key = 14;
+    Index = recursive(Values, Key, 0, NELEMENTS(Values) - 1);
+    printf("Recursive: %d ==> %d\n\n", Key, Index);
+
+    Key = 3;
+    Index = recursive2(Values, Key, 0, NELEMENTS(Values) - 1);
+    printf("Recursive 2: %d ==> %d\n", Key, Index);
+
+    Key = 14;
+    Index = recursive2(Values, Key, 0, NELEMENTS(Values) - 1);
+    printf("Recursive 2: %d ==> %d\n\n", Key, Index);
+
+    Key = 3;
+    Index = builtin(Values, NELEMENTS(Values), &Key);
+    printf("Built-in: %d ==> %d\n", Key, Index);
+
+    Key = 14;
+    Index = builtin(Values, NELEMENTS(Values), &Key);
+    printf("Built-in: %d ==> %d\n\n", Key, Index);
+
+    // The first value not less than the key, which is the key itself if it is present
+    Key = 14;
+    printf("Lower bound: %d ==> %zu\n", Key, lower_bound(Values, NELEMENTS(Values), Key));
+    eytzinger_t* eytzinger = eytzinger_create(Values, NELEMENTS(Values));
+    if(eytzinger != NULL) {
+        printf("Eytzinger:   %d ==> %d\n", Key, eytzinger->values[eytzinger_lower_bound(eytzinger, Key)]);
+        eytzinger_destroy(&eytzinger);
+    }
+    stree_t* tree = stree_create(Values, NELEMENTS(Values));
+    if(tree != NULL) {
+        printf("S-tree:      %d ==> %d\n", Key, tree->keys[stree_lower_bound(tree, Key)]);
+        stree_destroy(&tree);
+    }
+
+    // Several keys at once
+    int Keys[]    = { 3, 14, 81, 1, 0 };
+    int Indices[NELEMENTS(Keys)];
+    search_batch(Values, NELEMENTS(Values), Keys, NELEMENTS(Keys), Indices);
+    for(size_t i = 0; i < NELEMENTS(Keys); i++) {
+        printf("Batch: %d ==> %d\n", Keys[i], Indices[i]);
+    }
+
+    // Verify against a linear scan
+    const bool ok = verify();
+    printf("\nVerify against a linear scan: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,155 @@
+// Find the first value not less than a key in a static search tree (S-tree)
+//
+// See https://en.algorithmica.org/hpc/data-structures/s-tree/
+
+#define _POSIX_C_SOURCE 200809L // For posix_memalign
+
+#include <limits.h>         // For INT_MAX
+#include <stdbool.h>        // For bool, true, false
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For malloc, posix_memalign, free, NULL
+#include <string.h>         // For strerror
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>      // For the AVX2 intrinsics
+#endif
+#include "s_tree.h"         // This module
+
+// Size of a cache line, in bytes
+#define CACHE_LINE  64
+
+// Get the index of child i (from 0 to STREE_B) of node k
+#define CHILD(k, i) ((k) * (STREE_B + 1) + (i) + 1)
+
+// Copy sorted values into the nodes, by an in-order walk of the subtree rooted at node k, returning the index of the
+// next value to copy
+static size_t build(int* keys, size_t nnodes, const int* values, size_t nvalues, size_t i, size_t k) {
+    if(k < nnodes) {
+        for(size_t j = 0; j < STREE_B; j++) {
+            i = build(keys, nnodes, values, nvalues, i, CHILD(k, j));
+            keys[k*STREE_B + j] = (i < nvalues) ? values[i++] : INT_MAX;
+        }
+        i = build(keys, nnodes, values, nvalues, i, CHILD(k, STREE_B));
+    }
+    return i;
+}
+
+// Count the keys of a node less than a key, one at a time
+static inline size_t rank_scalar(const int* node, int key) {
+    size_t rank = 0;
+    for(size_t j = 0; j < STREE_B; j++) {
+        rank += (node[j] < key);
+    }
+    return rank;
+}
+
+// Descend the tree from the root, remembering the last key not less than the key passed on the way, which is the
+// first such key in order
+static size_t search_scalar(const stree_t* tree, int key) {
+    size_t result = STREE_NONE;
+    size_t k      = 0;
+    while(k < tree->nnodes) {
+        const size_t rank = rank_scalar(tree->keys + k*STREE_B, key);
+        result = (rank < STREE_B) ? k*STREE_B + rank : result;
+        k      = CHILD(k, rank);
+    }
+    return result;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Count the keys of a node less than a key, comparing 8 at a time
+__attribute__((target("avx2,popcnt")))
+static inline size_t rank_avx2(const int* node, __m256i key) {
+    const __m256i lo   = _mm256_load_si256((const __m256i*)node);
+    const __m256i hi   = _mm256_load_si256((const __m256i*)(node + 8));
+    const int     less = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(key, lo))) |
+                         (_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(key, hi))) << 8);
+    return (size_t)__builtin_popcount((unsigned)less);
+}
+
+// Descend the tree as search_scalar does, comparing 8 keys at a time
+__attribute__((target("avx2,popcnt")))
+static size_t search_avx2(const stree_t* tree, int key) {
+    const __m256i keys   = _mm256_set1_epi32(key);
+    size_t        result = STREE_NONE;
+    size_t        k      = 0;
+    while(k < tree->nnodes) {
+        const size_t rank = rank_avx2(tree->keys + k*STREE_B, keys);
+        result = (rank < STREE_B) ? k*STREE_B + rank : result;
+        k      = CHILD(k, rank);
+    }
+    return result;
+}
+
+// Whether the CPU supports AVX2: 1 if so, 0 if not, or -1 until it has been checked
+static int avx2_supported = -1;
+
+// Check whether the CPU supports AVX2
+static bool has_avx2(void) {
+    int supported = __atomic_load_n(&avx2_supported, __ATOMIC_RELAXED);
+    if(supported < 0) {
+        supported = (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) ? 1 : 0;
+        __atomic_store_n(&avx2_supported, supported, __ATOMIC_RELAXED);
+    }
+    return supported != 0;
+}
+
+#endif
+
+// Create a static search tree from a sorted array of values
+stree_t* stree_create(const int* values, size_t nvalues) {
+    if((values == NULL) || (nvalues == 0)) {
+        printf("Bad arguments\n");
+        return NULL;
+    }
+
+    stree_t* tree = malloc(sizeof(stree_t));
+    if(tree == NULL) {
+        printf("Failed to allocate struct\n");
+        return NULL;
+    }
+
+    // Each node is a cache line
+    void*        keys   = NULL;
+    const size_t nnodes = (nvalues + STREE_B - 1) / STREE_B;
+    const int    error  = posix_memalign(&keys, CACHE_LINE, nnodes * STREE_B * sizeof(int));
+    if(error != 0) {
+        printf("posix_memalign failed: %s", strerror(error));
+        free(tree);
+        return NULL;
+    }
+
+    tree->nvalues = nvalues;
+    tree->nnodes  = nnodes;
+    tree->max     = values[nvalues - 1];
+    tree->keys    = keys;
+    build(tree->keys, nnodes, values, nvalues, 0, 0);
+    return tree;
+}
+
+// Destroy a static search tree
+void stree_destroy(stree_t** tree) {
+    if((tree == NULL) || (*tree == NULL)) {
+        printf("Bad static search tree\n");
+        return;
+    }
+
+    free((*tree)->keys);
+    free(*tree);
+    *tree = NULL;
+}
+
+// Find the first value not less than a key in a static search tree
+size_t stree_lower_bound(const stree_t* tree, int key) {
+    // Otherwise the search could end on the padding, which is in order after every value
+    if((tree == NULL) || (key > tree->max)) {
+        return STREE_NONE;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    if(has_avx2()) {
+        return search_avx2(tree, key);
+    }
+#endif
+    return search_scalar(tree, key);
+}
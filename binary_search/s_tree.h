@@ -0,0 +1,69 @@
+// Find the first value not less than a key in a static search tree (S-tree)
+//
+// A binary search of n values takes log2(n) probes, each a cache miss once the array is larger than the cache, and
+// uses only 4 bytes of each 64-byte cache line it fetches. An S-tree is a B-tree with 16 keys per node, so that a
+// node fills exactly one cache line, and with no pointers: as in the Eytzinger layout, the children of node k are the
+// nodes k * 17 + 1 to k * 17 + 17, so the tree is just an array of nodes. A search takes log17(n) probes, about a
+// quarter as many as a binary search, and finds which child to descend to by comparing the key with all 16 keys of a
+// node at once. With AVX2 that is two vector compares, and the number of keys less than the key is the popcount of the
+// resulting mask.
+//
+// The tree is built from a sorted array in O(n), by an in-order walk of the nodes. Any unused keys in the last nodes
+// are INT_MAX. The tree is read-only: values cannot be inserted or removed once it is built.
+//
+// See https://en.algorithmica.org/hpc/data-structures/s-tree/
+
+#ifndef S_TREE_H
+#define S_TREE_H
+
+#include <stddef.h> // For size_t
+#include <stdint.h> // For SIZE_MAX
+
+// Number of keys in a node, which fill a cache line
+#define STREE_B     16
+
+// Returned by stree_lower_bound when every value is less than the key
+#define STREE_NONE  SIZE_MAX
+
+// A static search tree.
+//
+// Fields:
+//  nvalues : number of values.
+//  nnodes  : number of nodes.
+//  max     : the largest value, which tells a key greater than every value from the padding.
+//  keys    : STREE_B keys for each node, allocated on the heap aligned to a cache line.
+typedef struct stree_t {
+    size_t nvalues;
+    size_t nnodes;
+    int    max;
+    int*   keys;
+} stree_t;
+
+// Create a static search tree from a sorted array of values, in O(n).
+//
+// Parameters:
+//  values  : pointer to the sorted array of values.
+//  nvalues : number of values in the array.
+//
+// Returns:
+//  pointer to the tree or NULL if the arguments are bad or memory could not be allocated.
+stree_t* stree_create(const int* values, size_t nvalues);
+
+// Destroy a static search tree.
+//
+// Parameters:
+//  tree : pointer to pointer to the tree.
+void stree_destroy(stree_t** tree);
+
+// Find the first value not less than a key in a static search tree.
+//
+// Parameters:
+//  tree : pointer to the tree.
+//  key  : value to find.
+//
+// Returns:
+//  the index in tree->keys of the first value greater than or equal to the key, or STREE_NONE if every value is less
+//  than the key.
+size_t stree_lower_bound(const stree_t* tree, int key);
+
+#endif // S_TREE_H
@@ -1,36 +1,251 @@
 // Binary tree
 //
-// This typically executes in log_2(N) time for insertion, deletion and sorting
+// This is a red-black tree, which takes O(log N) time for insertion, deletion and search
 // See https://en.wikipedia.org/wiki/Binary_tree
+// See https://en.wikipedia.org/wiki/Red%E2%80%93black_tree
+
+#include <errno.h>          // For errno
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For malloc, free, NULL
+#include <string.h>         // For strerror
+#include "binary_tree.h"    // This module
+
+// Orders in which to visit the nodes of a tree
+typedef enum order_t {
+    PREORDER,       // root, left, right
+    INORDER,        // left, root, right
+    POSTORDER,      // left, right, root
+    REVERSE         // right, root, left
+} order_t;
+
+// Whether a node, which may be NULL, is red (missing children count as black)
+static inline bool is_red(const node_t *node) {
+    return (node != NULL) && (node->color == RED);
+}
+
+// Replace the link to a node from its parent (or the root) with a link to another node or NULL
+static void replace(node_t **tree, node_t *node, node_t *replacement) {
+    if(node->parent == NULL) {
+        *tree = replacement;
+    }
+    else if(node == node->parent->left) {
+        node->parent->left = replacement;
+    }
+    else {
+        node->parent->right = replacement;
+    }
+    if(replacement != NULL) {
+        replacement->parent = node->parent;
+    }
+}
+
+// Rotate a node down to the left, so that its right child takes its place
+static void rotate_left(node_t **tree, node_t *node) {
+    node_t *child = node->right;
+    node->right = child->left;
+    if(child->left != NULL) {
+        child->left->parent = node;
+    }
+    replace(tree, node, child);
+    child->left  = node;
+    node->parent = child;
+}
+
+// Rotate a node down to the right, so that its left child takes its place
+static void rotate_right(node_t **tree, node_t *node) {
+    node_t *child = node->left;
+    node->left = child->right;
+    if(child->right != NULL) {
+        child->right->parent = node;
+    }
+    replace(tree, node, child);
+    child->right = node;
+    node->parent = child;
+}
+
+// Restore the rules after inserting a red node, which may have a red parent
+static void insert_fixup(node_t **tree, node_t *node) {
+    while(is_red(node->parent)) {
+        // The parent is red so is not the root, and the grandparent is black
+        node_t *parent      = node->parent;
+        node_t *grandparent = parent->parent;
+        if(parent == grandparent->left) {
+            node_t *uncle = grandparent->right;
+            if(is_red(uncle)) {
+                // Push the grandparent's black down to both its children, and carry on from the grandparent
+                parent->color      = BLACK;
+                uncle->color       = BLACK;
+                grandparent->color = RED;
+                node               = grandparent;
+            }
+            else {
+                // Line the node up with its parent, then rotate the parent up in place of the grandparent
+                if(node == parent->right) {
+                    rotate_left(tree, parent);
+                    node   = parent;
+                    parent = node->parent;
+                }
+                parent->color      = BLACK;
+                grandparent->color = RED;
+                rotate_right(tree, grandparent);
+            }
+        }
+        else {
+            // The mirror image
+            node_t *uncle = grandparent->left;
+            if(is_red(uncle)) {
+                parent->color      = BLACK;
+                uncle->color       = BLACK;
+                grandparent->color = RED;
+                node               = grandparent;
+            }
+            else {
+                if(node == parent->left) {
+                    rotate_right(tree, parent);
+                    node   = parent;
+                    parent = node->parent;
+                }
+                parent->color      = BLACK;
+                grandparent->color = RED;
+                rotate_left(tree, grandparent);
+            }
+        }
+    }
+    (*tree)->color = BLACK;
+}
+
+// Restore the rules after removing a black node, which leaves the paths through node (which may be NULL), a child of
+// parent, one black short
+static void delete_fixup(node_t **tree, node_t *node, node_t *parent) {
+    while((node != *tree) && !is_red(node)) {
+        // The sibling has a black node more on its side, so it exists
+        if(node == parent->left) {
+            node_t *sibling = parent->right;
+            if(is_red(sibling)) {
+                // Rotate the red sibling up, so that the sibling is black
+                sibling->color = BLACK;
+                parent->color  = RED;
+                rotate_left(tree, parent);
+                sibling = parent->right;
+            }
+            if(!is_red(sibling->left) && !is_red(sibling->right)) {
+                // Take a black off the sibling's side too, and carry on from the parent
+                sibling->color = RED;
+                node           = parent;
+                parent         = node->parent;
+            }
+            else {
+                // Make sure the sibling's far child is red, then rotate the sibling up, adding a black on this side
+                if(!is_red(sibling->right)) {
+                    sibling->left->color = BLACK;
+                    sibling->color       = RED;
+                    rotate_right(tree, sibling);
+                    sibling = parent->right;
+                }
+                sibling->color        = parent->color;
+                parent->color         = BLACK;
+                sibling->right->color = BLACK;
+                rotate_left(tree, parent);
+                node = *tree;
+            }
+        }
+        else {
+            // The mirror image
+            node_t *sibling = parent->left;
+            if(is_red(sibling)) {
+                sibling->color = BLACK;
+                parent->color  = RED;
+                rotate_right(tree, parent);
+                sibling = parent->left;
+            }
+            if(!is_red(sibling->left) && !is_red(sibling->right)) {
+                sibling->color = RED;
+                node           = parent;
+                parent         = node->parent;
+            }
+            else {
+                if(!is_red(sibling->left)) {
+                    sibling->right->color = BLACK;
+                    sibling->color        = RED;
+                    rotate_left(tree, sibling);
+                    sibling = parent->left;
+                }
+                sibling->color       = parent->color;
+                parent->color        = BLACK;
+                sibling->left->color = BLACK;
+                rotate_right(tree, parent);
+                node = *tree;
+            }
+        }
+    }
+    if(node != NULL) {
+        node->color = BLACK;
+    }
+}
+
+// Walk a tree in O(1) space by following the parent pointers back up, visiting each node with its level
 //
-// This supports the following operations:
-//  create          Create a new stand-alone node
-//  destroy         Destroy a tree (recursively)
-//  insert          Insert a node into a tree (recursively)
-//  search          Search for an item in the tree (recursively)
-//  search_parent   Search for the parent of an item in the tree (recursively)
-//  detach          Detach a node or sub-tree
-//  print_preorder  Print the contents of a tree (pre-order: root, left, right)
-//  print_inorder   Print the contents of a tree (in-order: left, root, right)
-//  print_postorder Print the contents of a tree (post-order: left, right, root)
-//  print_tree      Print a tree (in-order: left, right, root)
+// Each node is arrived at three times: from its parent, back from its first child and back from its second child. It
+// is visited on the first, second or third of those for pre-, in- and post-order respectively.
+static void traverse(node_t *tree, int level, order_t order,
+                     void (*visit)(const node_t *node, int level, void *context), void *context) {
+    node_t *const stop     = (tree != NULL) ? tree->parent : NULL;
+    node_t       *previous = stop;
+    node_t       *node     = tree;
+    while(node != stop) {
+        node_t *first  = (order == REVERSE) ? node->right : node->left;
+        node_t *second = (order == REVERSE) ? node->left : node->right;
+        node_t *next;
+        if(previous == node->parent) {
+            // Arrived from the parent, so go down the first child if there is one
+            if(order == PREORDER) {
+                visit(node, level, context);
+            }
+            next = first;
+        }
+        else {
+            next = NULL;
+        }
+        if((next == NULL) && ((previous == node->parent) || (previous == first))) {
+            // Back from the first child (or there is none), so go down the second child if there is one
+            if((order == INORDER) || (order == REVERSE)) {
+                visit(node, level, context);
+            }
+            next = second;
+        }
+        if(next == NULL) {
+            // Back from the second child (or there is none), so go back up
+            if(order == POSTORDER) {
+                visit(node, level, context);
+            }
+            next = node->parent;
+        }
 
-#include <errno.h>      // For errno
-#include <stdbool.h>    // For bool, true, false
-#include <stdio.h>      // For printf
-#include <stdlib.h>     // For EXIT_SUCCESS, malloc, free
-#include <string.h>     // For strerror
+        level += (next == node->parent) ? -1 : 1;
+        previous = node;
+        node     = next;
+    }
+}
 
-#define NELEMENTS(a)    (sizeof(a) / sizeof(a[0]))
+// Visit a node by printing its data
+static void print_node(const node_t *node, int level, void *context) {
+    (void)level;
+    (void)context;
+    printf("%2d\n", node->data);
+}
 
-typedef struct node_t node_t;
-struct node_t {
-    int data;
-    node_t *left;
-    node_t *right;
-};
+// Visit a node by printing its data indented by its level, marking red nodes
+static void print_indented(const node_t *node, int level, void *context) {
+    (void)context;
+    printf("%*s%2d%s\n", level * 4, "", node->data, (node->color == RED) ? "*" : "");
+}
 
-typedef int (*compare_t)(node_t *tree, int data);
+// Visit a node by recording its level in the context if it is the deepest so far
+static void measure_height(const node_t *node, int level, void *context) {
+    int *deepest = context;
+    (void)node;
+    *deepest = (level > *deepest) ? level : *deepest;
+}
 
 // Comparison function used for insertion, search et al
 int compare_data(node_t *tree, int data) {
@@ -47,293 +262,204 @@ int compare_data(node_t *tree, int data) {
 }
 
 // Create a new stand-alone node
-node_t * create(int data) {
+node_t *create(int data) {
     node_t *node = malloc(sizeof(node_t));
     if(node == NULL) {
         printf("ERROR! %s", strerror(errno));
         return NULL;
     }
-    node->data = data;
-    node->left = NULL;
-    node->right = NULL;
+    node->data   = data;
+    node->color  = RED;
+    node->left   = NULL;
+    node->right  = NULL;
+    node->parent = NULL;
     return node;
 }
 
-// Destroy a tree (recursively)
+// Destroy a tree
 void destroy(node_t **tree) {
-    // Is the tree empty?
-    if(*tree == NULL) {
-        // Nothing to do
-        return;
-    }
-    // The tree is not empty
-    else {
-        // Destroy the left sub-tree
-        destroy(&(*tree)->left);
-
-        // Destroy the right sub-tree
-        destroy(&(*tree)->right);
-
-        // Free the node
-        free(*tree);
-        *tree = NULL;
+    // Free the leaves, and then the nodes that become leaves, working back up
+    node_t *node = *tree;
+    while(node != NULL) {
+        if(node->left != NULL) {
+            node = node->left;
+        }
+        else if(node->right != NULL) {
+            node = node->right;
+        }
+        else {
+            node_t *parent = node->parent;
+            if(parent != NULL) {
+                if(node == parent->left) {
+                    parent->left = NULL;
+                }
+                else {
+                    parent->right = NULL;
+                }
+            }
+            free(node);
+            node = parent;
+        }
     }
+    *tree = NULL;
 }
 
-// Insert a node into a tree (recursively)
-void insert(node_t **tree, int data, compare_t compare) {
-    // Is the tree empty?
-    if(*tree == NULL) {
-        // Create and insert the new node here
-        *tree = create(data);
-    }
-    // The tree is not empty
-    else {
-        // Compare against the current node
-        int result = compare(*tree, data);
+// Insert an item into a tree
+bool insert(node_t **tree, int data, compare_t compare) {
+    // Find where the item belongs, as a leaf
+    node_t  *parent = NULL;
+    node_t **link   = tree;
+    while(*link != NULL) {
+        parent = *link;
+        int result = compare(parent, data);
         if(result < 0) {
-            // Recurse into the left sub-tree
-            insert(&(*tree)->left, data, compare);
+            link = &parent->left;
         }
         else if(result > 0) {
-            // Recurse into the right sub-tree
-            insert(&(*tree)->right, data, compare);
+            link = &parent->right;
         }
         else {
             // Already in the tree, do not insert
-            printf("Already in tree: data = %d, tree = %p\n", data, *tree);
+            return false;
         }
     }
+
+    // Link in a red node, which keeps the black counts but may have a red parent
+    node_t *node = create(data);
+    if(node == NULL) {
+        return false;
+    }
+    node->parent = parent;
+    *link        = node;
+    insert_fixup(tree, node);
+    return true;
 }
 
-// Search for an item in the tree (recursively)
+// Search for an item in the tree
 node_t *search(node_t **tree, int data, compare_t compare) {
-    // Is the tree empty?
-    if(*tree == NULL) {
-        // The data is not in the tree
-        return NULL;
-    }
-    // The tree is not empty
-    else {
+    node_t *node = *tree;
+    while(node != NULL) {
         // Compare against the current node
-        int result = compare(*tree, data);
+        int result = compare(node, data);
         if(result < 0) {
-            // Recurse into the left sub-tree
-            return search(&(*tree)->left, data, compare);
+            node = node->left;
         }
         else if(result > 0) {
-            // Recurse into the right sub-tree
-            return search(&(*tree)->right, data, compare);
+            node = node->right;
         }
         else {
             // Found the item, return the node
-            return *tree;
+            return node;
         }
     }
+
+    // The data is not in the tree
+    return NULL;
 }
 
-// Search for the parent of an item in the tree (recursively)
-node_t *search_parent(node_t **tree, node_t *parent, int data,
-        compare_t compare) {
-    // Is the tree empty?
-    if(*tree == NULL) {
-        // The node is not in the tree, hence no parent
-        return NULL;
+// Delete an item from the tree
+bool delete(node_t **tree, int data, compare_t compare) {
+    node_t *node = search(tree, data, compare);
+    if(node == NULL) {
+        return false;
+    }
+
+    // The node removed from its place is the node itself if it has at most one child, otherwise its successor, which
+    // has no left child, and which then takes the node's place and colour. Either way the removed node's only child
+    // (or NULL) moves up in its place.
+    node_t *child;
+    node_t *parent;
+    color_t removed;
+    if(node->left == NULL) {
+        child   = node->right;
+        parent  = node->parent;
+        removed = node->color;
+        replace(tree, node, child);
+    }
+    else if(node->right == NULL) {
+        child   = node->left;
+        parent  = node->parent;
+        removed = node->color;
+        replace(tree, node, child);
     }
-    // The tree is not empty
     else {
-        // Compare against the current node
-        int result = compare(*tree, data);
-        if(result < 0) {
-            // Recurse into the left sub-tree
-            return search_parent(&(*tree)->left, *tree, data, compare);
-        }
-        else if(result > 0) {
-            // Recurse into the right sub-tree
-            return search_parent(&(*tree)->right, *tree, data, compare);
+        node_t *next = minimum(node->right);
+        child   = next->right;
+        removed = next->color;
+        if(next->parent == node) {
+            parent = next;
         }
         else {
-            // Found the item, return the parent
-            return parent;
+            parent = next->parent;
+            replace(tree, next, child);
+            next->right         = node->right;
+            next->right->parent = next;
         }
+        replace(tree, node, next);
+        next->left         = node->left;
+        next->left->parent = next;
+        next->color        = node->color;
     }
-}
+    free(node);
 
-// Detach a node or sub-tree
-node_t *detach(node_t *parent, node_t *child) {
-    node_t *detached = NULL;
-
-    if((parent != NULL) && (child != NULL)) {
-        if(child == parent->left) {
-            detached = child;
-            parent->left = NULL;
-        }
-        else if(child == parent->right) {
-            detached = child;
-            parent->right = NULL;
-        }
-        else {
-            printf("Not a child of the parent: data = %d, child = %p\n",
-                    child->data, child);
-        }
+    // Removing a red node changes no black counts, but removing a black one leaves its paths one short
+    if(removed == BLACK) {
+        delete_fixup(tree, child, parent);
     }
-
-    return detached;
+    return true;
 }
 
-// Delete an item in the tree
-void delete(node_t **tree, int data, compare_t compare) {
-    // Find the node and its parent
-    node_t *node = search(tree, data, compare);
-    node_t *parent = search_parent(tree, NULL, data, compare);
-
-    if((node != NULL) && (parent != NULL)) {
-        // Get the parent's link to the node
-        node_t **link = (node == parent->left) ? &parent->left : &parent->right;
-
-        // If the node has no right sub-tree?
-        if(node->right == NULL) {
-            // If the node has no left sub-tree?
-            if(node->left == NULL) {
-                // Node has no left or right sub-tree, so can be simply deleted
-                printf("\nNo L, no R: delete item %d at %p\n", node->data,
-                        node);
-                *link = NULL;
-                free(node);
-            }
-            else {
-                // Node has left sub-tree only, so replace it with the left sub-tree
-                printf("\nHas L, no R: delete item %d at %p\n", node->data,
-                        node);
-                *link = node->left;
-                free(node);
-            }
+// Find the first item in order
+node_t *minimum(node_t *tree) {
+    if(tree != NULL) {
+        while(tree->left != NULL) {
+            tree = tree->left;
         }
-        // If the node has no left sub-tree?
-        else if(node->left == NULL) {
-            // Node has right sub-tree only, so replace it with the right sub-tree
-            printf("\nNo L, Has R: delete item %d at %p\n", node->data, node);
-            *link = node->right;
-            free(node);
+    }
+    return tree;
+}
 
-        }
-        else {
-            // Node has both left and right sub-trees
-            printf("\nHas L, Has R: delete item %d at %p\n", node->data, node);
+// Find the next item in order
+node_t *successor(node_t *node) {
+    if(node == NULL) {
+        return NULL;
+    }
 
-            // TODO
-            // Successor is the left-most node in the right sub-tree
-            // Successor acquires the left and right sub-tree
-        }
+    // The next item is the first in the right sub-tree, or else the nearest ancestor whose left sub-tree this is in
+    if(node->right != NULL) {
+        return minimum(node->right);
     }
+    node_t *parent = node->parent;
+    while((parent != NULL) && (node == parent->right)) {
+        node   = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+// Get the height of a tree
+int height(node_t *tree) {
+    int deepest = 0;
+    traverse(tree, 1, INORDER, measure_height, &deepest);
+    return deepest;
 }
 
 // Print the contents of a tree (pre-order: root, left, right)
 void print_preorder(node_t *tree) {
-    if(tree != NULL) {
-        printf("%2d\n", tree->data);
-        print_preorder(tree->left);
-        print_preorder(tree->right);
-    }
+    traverse(tree, 0, PREORDER, print_node, NULL);
 }
 
 // Print the contents of a tree (in-order: left, root, right)
 void print_inorder(node_t *tree) {
-    if(tree != NULL) {
-        print_inorder(tree->left);
-        printf("%2d\n", tree->data);
-        print_inorder(tree->right);
-    }
+    traverse(tree, 0, INORDER, print_node, NULL);
 }
 
 // Print the contents of a tree (post-order: left, right, root)
 void print_postorder(node_t *tree) {
-    if(tree != NULL) {
-        print_postorder(tree->left);
-        print_postorder(tree->right);
-        printf("%2d\n", tree->data);
-    }
+    traverse(tree, 0, POSTORDER, print_node, NULL);
 }
 
-// Print a tree (in-order: left, right, root)
+// Print a tree (in-order: right, root, left)
 void print_tree(node_t *tree, int level) {
-    if(tree != NULL) {
-        print_tree(tree->right, level + 1);
-        printf("%*s%2d\n", level * 4, "", tree->data);
-        print_tree(tree->left, level + 1);
-    }
-}
-
-int main(void) {
-    // Create a new tree
-    node_t *tree = NULL;
-
-    // Insert some data
-    int values[] = { 9, 4, 15, 6, 12, 17, 2 };
-    for(size_t i = 0; i < NELEMENTS(values); i++) {
-        insert(&tree, values[i], compare_data);
-    }
-    printf("\nTree:\n");
-    print_tree(tree, 0);
-
-    // Verify that duplicates are not inserted
-    insert(&tree, 9, compare_data);
-
-    // Search for an item
-    node_t *node = search(&tree, 12, compare_data);
-    if(node != NULL) {
-        printf("\nFound item %d at %p\n", node->data, node);
-    }
-
-    // Search for the parent of an item
-    node_t *parent = search_parent(&tree, NULL, 12, compare_data);
-    if(parent != NULL) {
-        printf("\nFound parent %d of item 12 at %p\n", parent->data, parent);
-    }
-
-    // Detach the item
-    node_t *detached = detach(parent, node);
-    printf("\nDetached:\n");
-    print_tree(detached, 0);
-    printf("\nTree:\n");
-    print_tree(tree, 0);
-
-    // Destroy the tree
-    destroy(&tree);
-
-    // Create a new tree
-    int values2[] = { 2, 5, 6, 4, 3, 1 };
-    for(size_t i = 0; i < NELEMENTS(values2); i++) {
-        insert(&tree, values2[i], compare_data);
-    }
-    printf("\nTree:\n");
-    print_tree(tree, 0);
-
-    // Delete a node that has no children
-    delete(&tree, 1, compare_data);
-    printf("\nTree:\n");
-    print_tree(tree, 0);
-
-    // Delete a node that has one child
-    delete(&tree, 4, compare_data);
-    printf("\nTree:\n");
-    print_tree(tree, 0);
-
-    // Reset the tree
-    destroy(&tree);
-    for(size_t i = 0; i < NELEMENTS(values2); i++) {
-        insert(&tree, values2[i], compare_data);
-    }
-    printf("\nTree:\n");
-    print_tree(tree, 0);
-
-    // Delete a node that has two children
-    delete(&tree, 2, compare_data);
-    printf("\nTree:\n");
-    print_tree(tree, 0);
-
-    // Destroy the tree
-    destroy(&tree);
-
-    return EXIT_SUCCESS;
+    traverse(tree, level, REVERSE, print_indented, NULL);
 }
@@ -0,0 +1,162 @@
+// Binary tree
+//
+// This is a red-black tree, a binary search tree that keeps itself balanced, so that insertion, deletion and search
+// take O(log N) time whatever order the items arrive in. Without balancing, items inserted in sorted order make each
+// node the right child of the last, and the tree degenerates into a linked list with O(N) operations.
+//
+// Each node is red or black, and the tree keeps two rules:
+//  - a red node has no red children;
+//  - every path from a node down to a missing child passes the same number of black nodes.
+// The longest path from the root is then at most twice the shortest, so the height is at most 2 log_2(N + 1).
+// Insertion and deletion restore the rules with recolouring and at most 3 rotations.
+//
+// Every node also points to its parent, so nothing recurses: insertion and deletion walk back up from the node,
+// successor steps to the next item in order, and the traversals walk the tree in O(1) space.
+//
+// See https://en.wikipedia.org/wiki/Binary_tree
+// See https://en.wikipedia.org/wiki/Red%E2%80%93black_tree
+// See Cormen, Leiserson, Rivest and Stein, "Introduction to Algorithms", chapter 13
+//
+// This supports the following operations:
+//  create          Create a new stand-alone node
+//  destroy         Destroy a tree
+//  insert          Insert an item into a tree
+//  search          Search for an item in the tree
+//  delete          Delete an item from the tree
+//  minimum         Find the first item in order
+//  successor       Find the next item in order
+//  height          Get the height of a tree
+//  print_preorder  Print the contents of a tree (pre-order: root, left, right)
+//  print_inorder   Print the contents of a tree (in-order: left, root, right)
+//  print_postorder Print the contents of a tree (post-order: left, right, root)
+//  print_tree      Print a tree (in-order: right, root, left)
+
+#ifndef BINARY_TREE_H
+#define BINARY_TREE_H
+
+#include <stdbool.h>    // For bool
+
+// Colour of a node
+typedef enum color_t {
+    RED,
+    BLACK
+} color_t;
+
+// A node of a tree.
+//
+// Fields:
+//  data   : the item.
+//  color  : the colour of the node.
+//  left   : the sub-tree of smaller items, or NULL.
+//  right  : the sub-tree of larger items, or NULL.
+//  parent : the parent node, or NULL for the root.
+typedef struct node_t node_t;
+struct node_t {
+    int     data;
+    color_t color;
+    node_t *left;
+    node_t *right;
+    node_t *parent;
+};
+
+// Comparison function used for insertion, search et al, returning less than 0 if the data belongs to the left of the
+// node, greater than 0 if to the right, or 0 if it is equal to the node's data.
+typedef int (*compare_t)(node_t *tree, int data);
+
+// Comparison function ordering by the value of the data.
+int compare_data(node_t *tree, int data);
+
+// Create a new stand-alone node.
+//
+// Parameters:
+//  data : the item.
+//
+// Returns:
+//  pointer to the red node or NULL if memory could not be allocated.
+node_t *create(int data);
+
+// Destroy a tree, in O(1) space.
+//
+// Parameters:
+//  tree : pointer to the root of the tree, which is set to NULL.
+void destroy(node_t **tree);
+
+// Insert an item into a tree, rebalancing it.
+//
+// Parameters:
+//  tree    : pointer to the root of the tree, NULL for an empty tree.
+//  data    : the item.
+//  compare : comparison function.
+//
+// Returns:
+//  true     : the item was inserted.
+//  false    : the item was not inserted i.e. it is already in the tree or memory could not be allocated.
+bool insert(node_t **tree, int data, compare_t compare);
+
+// Search for an item in the tree.
+//
+// Parameters:
+//  tree    : pointer to the root of the tree.
+//  data    : the item.
+//  compare : comparison function.
+//
+// Returns:
+//  the node holding the item, or NULL if it is not in the tree.
+node_t *search(node_t **tree, int data, compare_t compare);
+
+// Delete an item from the tree, rebalancing it.
+//
+// Parameters:
+//  tree    : pointer to the root of the tree.
+//  data    : the item.
+//  compare : comparison function.
+//
+// Returns:
+//  true     : the item was deleted.
+//  false    : the item was not deleted i.e. it is not in the tree.
+bool delete(node_t **tree, int data, compare_t compare);
+
+// Find the first item in order in a tree or sub-tree.
+//
+// Parameters:
+//  tree : the root of the tree.
+//
+// Returns:
+//  the node holding the smallest item, or NULL if the tree is empty.
+node_t *minimum(node_t *tree);
+
+// Find the next item in order, to iterate over a tree from minimum.
+//
+// Parameters:
+//  node : a node of the tree.
+//
+// Returns:
+//  the node holding the next larger item, or NULL if this is the largest.
+node_t *successor(node_t *node);
+
+// Get the height of a tree.
+//
+// Parameters:
+//  tree : the root of the tree.
+//
+// Returns:
+//  the number of nodes on the longest path from the root down, 0 if the tree is empty.
+int height(node_t *tree);
+
+// Print the contents of a tree (pre-order: root, left, right).
+void print_preorder(node_t *tree);
+
+// Print the contents of a tree (in-order: left, root, right).
+void print_inorder(node_t *tree);
+
+// Print the contents of a tree (post-order: left, right, root).
+void print_postorder(node_t *tree);
+
+// Print a tree sideways, with the root on the left, each level indented further and red nodes marked with *.
+//
+// Parameters:
+//  tree  : the root of the tree.
+//  level : the level of the root, 0 to begin with.
+void print_tree(node_t *tree, int level);
+
+#endif // BINARY_TREE_H
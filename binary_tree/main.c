@@ -0,0 +1,253 @@
+// Binary tree
+//
+// This is a red-black tree, which takes O(log N) time for insertion, deletion and search
+//
+// Inserting, searching for and deleting items in random and in sorted order is benchmarked, with the height of the
+// tree, with:
+//
+//  ./binary_tree benchmark [number of items]
+//
+// See https://en.wikipedia.org/wiki/Binary_tree
+// See https://en.wikipedia.org/wiki/Red%E2%80%93black_tree
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include <errno.h>          // For errno
+#include <stdbool.h>        // For bool, true, false
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For EXIT_SUCCESS, EXIT_FAILURE, malloc, free, rand, strtoul
+#include <string.h>         // For strcmp, strerror
+#include <time.h>           // For clock_gettime
+#include "binary_tree.h"    // For node_t, compare_data and the tree operations
+
+#define NELEMENTS(a)    (sizeof(a) / sizeof(a[0]))
+
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Shuffle an array of items
+void shuffle(int* items, size_t nitems) {
+    for(size_t i = nitems; i > 1; i--) {
+        const size_t j    = (size_t)rand() % i;
+        const int    temp = items[i - 1];
+        items[i - 1] = items[j];
+        items[j]     = temp;
+    }
+}
+
+// Check that a sub-tree keeps the rules, and that its items are in order and between lo and hi, returning the number
+// of black nodes on each path down from it, or -1 if it breaks the rules
+int check(const node_t *tree, const node_t *parent, long lo, long hi) {
+    if(tree == NULL) {
+        return 1;
+    }
+    if((tree->parent != parent) || (tree->data < lo) || (tree->data > hi) ||
+       ((tree->color == RED) && (((tree->left != NULL) && (tree->left->color == RED)) ||
+                                 ((tree->right != NULL) && (tree->right->color == RED))))) {
+        return -1;
+    }
+    const int left  = check(tree->left, tree, lo, (long)tree->data - 1);
+    const int right = check(tree->right, tree, (long)tree->data + 1, hi);
+    if((left < 0) || (left != right)) {
+        return -1;
+    }
+    return left + (tree->color == BLACK);
+}
+
+// Benchmark inserting, searching for and deleting items in random and in sorted order, reporting millions of
+// operations per second and the height of the tree
+int benchmark(size_t nitems) {
+    int* items = malloc(nitems * sizeof(int));
+    if(items == NULL) {
+        printf("malloc failed: %s", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    printf("%zu items, millions of operations per second\n", nitems);
+    printf("%-8s %12s %12s %12s %12s %8s\n", "order", "insert", "search", "iterate", "delete", "height");
+    bool passed = true;
+    for(int sorted = 0; sorted <= 1; sorted++) {
+        for(size_t i = 0; i < nitems; i++) {
+            items[i] = (int)i;
+        }
+        if(!sorted) {
+            shuffle(items, nitems);
+        }
+        printf("%-8s ", sorted ? "sorted" : "random");
+
+        node_t* tree  = NULL;
+        bool    ok    = true;
+        double  start = now();
+        for(size_t i = 0; i < nitems; i++) {
+            ok = insert(&tree, items[i], compare_data) && ok;
+        }
+        printf("%12.2f ", nitems / (now() - start) / 1e6);
+
+        start = now();
+        for(size_t i = 0; i < nitems; i++) {
+            ok = ok && (search(&tree, items[i], compare_data) != NULL);
+        }
+        printf("%12.2f ", nitems / (now() - start) / 1e6);
+
+        // The items in order are 0, 1, 2...
+        start = now();
+        int expected = 0;
+        for(node_t* node = minimum(tree); node != NULL; node = successor(node)) {
+            ok = ok && (node->data == expected++);
+        }
+        printf("%12.2f ", nitems / (now() - start) / 1e6);
+        const int levels = height(tree);
+
+        start = now();
+        for(size_t i = 0; i < nitems; i++) {
+            ok = delete(&tree, items[i], compare_data) && ok;
+        }
+        ok = ok && ((size_t)expected == nitems) && (tree == NULL);
+        printf("%12.2f %8d%s\n", nitems / (now() - start) / 1e6, levels, ok ? "" : " FAILED");
+        passed = passed && ok;
+        fflush(stdout);
+        destroy(&tree);
+    }
+
+    free(items);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Verify the rules and the order of the items after every insertion and deletion, in random and in sorted order, and
+// that duplicates and missing items are refused
+bool verify(void) {
+    static const size_t sizes[] = { 1, 2, 3, 10, 100, 1000 };
+
+    for(size_t s = 0; s < NELEMENTS(sizes); s++) {
+        for(int sorted = 0; sorted <= 1; sorted++) {
+            const size_t n     = sizes[s];
+            int*         items = malloc(n * sizeof(int));
+            if(items == NULL) {
+                printf("malloc failed: %s", strerror(errno));
+                return false;
+            }
+            for(size_t i = 0; i < n; i++) {
+                items[i] = 2 * (int)i;
+            }
+            if(!sorted) {
+                shuffle(items, n);
+            }
+
+            node_t* tree = NULL;
+            bool    ok   = true;
+            for(size_t i = 0; ok && (i < n); i++) {
+                ok = insert(&tree, items[i], compare_data) && !insert(&tree, items[i], compare_data) &&
+                     (check(tree, NULL, -1, 2 * (long)n) > 0) && (tree->color == BLACK);
+            }
+
+            // The height is at most 2 log2(n + 1), and every item is found in order
+            int limit = 0;
+            while(((size_t)1 << limit) <= n) {
+                limit++;
+            }
+            ok = ok && (height(tree) <= 2 * limit);
+            int expected = 0;
+            for(node_t* node = minimum(tree); ok && (node != NULL); node = successor(node)) {
+                ok = (node->data == expected) && (search(&tree, expected + 1, compare_data) == NULL);
+                expected += 2;
+            }
+            ok = ok && ((size_t)expected == 2 * n);
+
+            // Delete in a different order from the insertion
+            shuffle(items, n);
+            for(size_t i = 0; ok && (i < n); i++) {
+                ok = delete(&tree, items[i], compare_data) && !delete(&tree, items[i], compare_data) &&
+                     (check(tree, NULL, -1, 2 * (long)n) > 0) && ((tree == NULL) || (tree->color == BLACK));
+            }
+            ok = ok && (tree == NULL);
+            destroy(&tree);
+            free(items);
+
+            if(!ok) {
+                printf("Mismatch for %zu items in %s order\n", n, sorted ? "sorted" : "random");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    // Benchmark the tree rather than demonstrating it?
+    if((argc > 1) && (strcmp(argv[1], "benchmark") == 0)) {
+        size_t nitems = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1000000;
+        return (nitems > 0) ? benchmark(nitems) : EXIT_FAILURE;
+    }
+
+    // Create a new tree
+    node_t *tree = NULL;
+
+    // Insert some data
+    int values[] = { 9, 4, 15, 6, 12, 17, 2 };
+    for(size_t i = 0; i < NELEMENTS(values); i++) {
+        insert(&tree, values[i], compare_data);
+    }
+    printf("\nTree (red nodes marked *):\n");
+    print_tree(tree, 0);
+
+    // Verify that duplicates are not inserted
+    if(!insert(&tree, 9, compare_data)) {
+        printf("\nAlready in tree: 9\n");
+    }
+
+    // Search for an item and its parent
+    node_t *node = search(&tree, 12, compare_data);
+    if(node != NULL) {
+        printf("\nFound item %d at %p", node->data, (void*)node);
+        if(node->parent != NULL) {
+            printf(", with parent %d", node->parent->data);
+        }
+        printf("\n");
+    }
+
+    // Iterate in order
+    printf("\nIn order:");
+    for(node = minimum(tree); node != NULL; node = successor(node)) {
+        printf(" %d", node->data);
+    }
+    printf("\n");
+
+    // Destroy the tree
+    destroy(&tree);
+
+    // Create a new tree from sorted items, which stays balanced
+    int values2[] = { 1, 2, 3, 4, 5, 6 };
+    for(size_t i = 0; i < NELEMENTS(values2); i++) {
+        insert(&tree, values2[i], compare_data);
+    }
+    printf("\nTree:\n");
+    print_tree(tree, 0);
+
+    // Delete a node that has no children
+    delete(&tree, 1, compare_data);
+    printf("\nTree:\n");
+    print_tree(tree, 0);
+
+    // Delete a node that has one child
+    delete(&tree, 5, compare_data);
+    printf("\nTree:\n");
+    print_tree(tree, 0);
+
+    // Delete a node that has two children
+    delete(&tree, 2, compare_data);
+    printf("\nTree:\n");
+    print_tree(tree, 0);
+
+    // Destroy the tree
+    destroy(&tree);
+
+    // Verify the rules
+    const bool ok = verify();
+    printf("\nVerify red-black rules: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,23 +1,55 @@
-// A circular buffer (or ring buffer)
-
-#include <stdbool.h>    // For bool, true, false
-#include <stdio.h>      // For printf
-#include <stdlib.h>     // For calloc, NULL, EXIT_FAILURE, EXIT_SUCCESS, size_t
-#include <string.h>     // For memcpy, memset
-
-// A circular buffer storing chars
-typedef struct circular_t {
-    size_t capacity;    // capacity of the buffer i.e. total number of elements
-    size_t occupied;    // number of elements currently occupied
-    size_t head;        // index from which to read
-    size_t tail;        // index at which to write
-    char*  buffer;      // buffer allocated on the heap
-} circular_t;
+// A circular buffer (or ring buffer).
+//
+// Elements may be of any size, fixed when the buffer is created, and are copied in and out by value.
+//
+// As well as copying elements in and out, the reserve/commit functions hand out pointers into the buffer itself so that
+// producers (e.g. recv or a parser) and consumers can work on the elements in place with no intermediate copy. Because
+// the free or occupied elements may wrap around the end of the buffer, a reservation is made up of at most two
+// contiguous regions. The file descriptor helpers use this to move bytes between a buffer and a socket, pipe or file
+// with one readv/writev call, however the data is split.
+
+#include <errno.h>              // For errno, EINTR, EINVAL, ENOBUFS, ENODATA
+#include <stdio.h>              // For printf
+#include <stdlib.h>             // For calloc, malloc, free, NULL
+#include <string.h>             // For memcpy
+#include <sys/uio.h>            // For readv, writev, struct iovec
+#include "circular_buffer.h"    // This module
+
+// Reserve up to nelements starting at an index, splitting the reservation where it wraps around the end of the buffer
+static size_t reserve(circular_t* circular, size_t start, size_t available, size_t nelements,
+                      ring_region_t regions[2]) {
+    if(nelements > available) {
+        nelements = available;
+    }
+
+    // Elements to the right of the start
+    size_t relements = circular->capacity - start;
+    if(relements > nelements) {
+        relements = nelements;
+    }
+    regions[0].data      = circular->buffer + start * circular->element_size;
+    regions[0].nelements = relements;
+
+    // Elements to the left of the start i.e. after the wrap-around
+    regions[1].data      = circular->buffer;
+    regions[1].nelements = nelements - relements;
+
+    return nelements;
+}
+
+// Describe the (up to two) regions of a reservation as an I/O vector, returning the number of entries used
+static int to_iovec(const ring_region_t regions[2], struct iovec iov[2]) {
+    iov[0].iov_base = regions[0].data;
+    iov[0].iov_len  = regions[0].nelements;
+    iov[1].iov_base = regions[1].data;
+    iov[1].iov_len  = regions[1].nelements;
+    return (regions[1].nelements > 0) ? 2 : 1;
+}
 
 // Create a new circular buffer
-circular_t* create(size_t capacity) {
-    if(capacity == 0) {
-        printf("Bad argument\n");
+circular_t* ring_create(size_t capacity, size_t element_size) {
+    if((capacity == 0) || (element_size == 0)) {
+        printf("Bad arguments\n");
         return NULL;
     }
 
@@ -27,24 +59,25 @@ circular_t* create(size_t capacity) {
         printf("Failed to allocate struct\n");
         return NULL;
     }
-    circular->buffer = calloc(capacity, sizeof(char));
-    if(circular == NULL) {
+    circular->buffer = calloc(capacity, element_size);
+    if(circular->buffer == NULL) {
         printf("Failed to allocate buffer\n");
         free(circular);
         return NULL;
     }
 
     // Initialize the parameters
-    circular->capacity = capacity;
-    circular->occupied = 0;
-    circular->head     = 0;
-    circular->tail     = 0;
+    circular->capacity     = capacity;
+    circular->element_size = element_size;
+    circular->occupied     = 0;
+    circular->head         = 0;
+    circular->tail         = 0;
 
     return circular;
 }
 
 // Destroy a circular buffer
-void destroy(circular_t** circular) {
+void ring_destroy(circular_t** circular) {
     if((circular == NULL) || (*circular == NULL)) {
         printf("Bad circular buffer\n");
         return;
@@ -52,315 +85,171 @@ void destroy(circular_t** circular) {
 
     free((*circular)->buffer);
     free(*circular);
-    circular = NULL;
+    *circular = NULL;
 }
 
 // Read a single element from the head
-char read(circular_t* circular) {
-    if(circular == NULL) {
-        printf("Bad circular buffer\n");
-        return 0;
+bool ring_read(circular_t* circular, void* element) {
+    if((circular == NULL) || (element == NULL)) {
+        printf("Bad arguments\n");
+        return false;
     }
 
-    if(circular->occupied > 0) {
-        // Read the element
-        char c = circular->buffer[circular->head];
-
-        // Clear the element
-        circular->buffer[circular->head] = ' ';
-
-        // Update the parameters
-        circular->occupied--;
-        circular->head++;
-        circular->head %= circular->capacity;
-
-        return c;
-    }
-    else {
-        printf("Buffer is empty\n");
-        return 0;
-    }
+    return ring_read_many(circular, element, 1) == 1;
 }
 
 // Read many at a time from the head
-size_t read_many(circular_t* circular, char* data, size_t nelements) {
+size_t ring_read_many(circular_t* circular, void* data, size_t nelements) {
     if((circular == NULL) || (data == NULL) || (nelements == 0)) {
         printf("Bad arguments\n");
         return 0;
     }
 
-    if(nelements > circular->occupied) {
-        printf("Truncating\n");
-        nelements = circular->occupied;
-    }
-
-    if(nelements > 0) {
-        // [..H..T..]
-        if(circular->head < circular->tail) {
-            memcpy(data, circular->buffer + circular->head, nelements * sizeof(data[0]));
-            memset(circular->buffer + circular->head, ' ', nelements * sizeof(data[0]));
-        }
-        // [..T..H..] without wrap-around
-        else if((circular->capacity - circular->head) > nelements) {
-            memcpy(data, circular->buffer + circular->head, nelements * sizeof(data[0]));
-            memset(circular->buffer + circular->head, ' ', nelements * sizeof(data[0]));
-        }
-        // [..T..H..] with wrap-around
-        else {
-            // Elements to the right of the head
-            size_t relements = circular->capacity - circular->head;
-            memcpy(data, circular->buffer + circular->head, relements * sizeof(data[0]));
-            memset(circular->buffer + circular->head, ' ', relements * sizeof(data[0]));
-
-            // Elements to the left of the tail
-            size_t lelements = nelements - relements;
-            memcpy(data + relements, circular->buffer, lelements * sizeof(data[0]));
-            memset(circular->buffer, ' ', lelements * sizeof(data[0]));
-        }
-
-        // Update the parameters
-        circular->occupied -= nelements;
-        circular->head += nelements;
-        circular->head %= circular->capacity;
-    }
-    else {
-        printf("Buffer is empty\n");
-    }
+    // Copy out of the (up to two) occupied regions
+    ring_region_t regions[2];
+    nelements = ring_read_reserve(circular, nelements, regions);
+    size_t rbytes = regions[0].nelements * circular->element_size;
+    size_t lbytes = regions[1].nelements * circular->element_size;
+    memcpy(data, regions[0].data, rbytes);
+    memcpy((uint8_t*)data + rbytes, regions[1].data, lbytes);
+    ring_read_commit(circular, nelements);
 
     // Return the number of elements actually read
     return nelements;
 }
 
 // Write a single element to the tail
-void write(circular_t* circular, char c) {
-    if(circular == NULL) {
-        printf("Bad circular buffer\n");
-        return;
+bool ring_write(circular_t* circular, const void* element) {
+    if((circular == NULL) || (element == NULL)) {
+        printf("Bad arguments\n");
+        return false;
     }
 
-    if((circular->capacity - circular->occupied) > 0) {
-        // Write the element
-        circular->buffer[circular->tail] = c;
-
-        // Update the parameters
-        circular->occupied++;
-        circular->tail++;
-        circular->tail %= circular->capacity;
-    }
-    else {
-        printf("Buffer is full\n");
-    }
+    return ring_write_many(circular, element, 1) == 1;
 }
 
 // Write many at a time to the tail
-size_t write_many(circular_t* circular, const char* data, size_t nelements) {
+size_t ring_write_many(circular_t* circular, const void* data, size_t nelements) {
     if((circular == NULL) || (data == NULL) || (nelements == 0)) {
         printf("Bad arguments\n");
         return 0;
     }
 
-    if(nelements > (circular->capacity - circular->occupied)) {
-        printf("Truncating\n");
-        nelements = (circular->capacity - circular->occupied);
-    }
-
-    if(nelements > 0) {
-        // [..T..H..]
-        if(circular->tail < circular->head) {
-            memcpy(circular->buffer + circular->tail, data, nelements * sizeof(data[0]));
-        }
-        // [..H..T..] without wrap-around
-        else if((circular->capacity - circular->tail) > nelements) {
-            memcpy(circular->buffer + circular->tail, data, nelements * sizeof(data[0]));
-        }
-        // [..H..T..] with wrap-around
-        else {
-            // Elements to the right of the tail
-            size_t relements = circular->capacity - circular->tail;
-            memcpy(circular->buffer + circular->tail, data, relements * sizeof(data[0]));
-
-            // Elements to the left of the head
-            size_t lelements = nelements - relements;
-            memcpy(circular->buffer, data + relements, lelements * sizeof(data[0]));
-        }
-
-        // Update the parameters
-        circular->occupied += nelements;
-        circular->tail     += nelements;
-        circular->tail     %= circular->capacity;
-    }
-    else {
-        printf("Buffer is full\n");
-    }
+    // Copy into the (up to two) free regions
+    ring_region_t regions[2];
+    nelements = ring_write_reserve(circular, nelements, regions);
+    size_t rbytes = regions[0].nelements * circular->element_size;
+    size_t lbytes = regions[1].nelements * circular->element_size;
+    memcpy(regions[0].data, data, rbytes);
+    memcpy(regions[1].data, (const uint8_t*)data + rbytes, lbytes);
+    ring_write_commit(circular, nelements);
 
     // Return the number of elements actually written
     return nelements;
 }
 
-// Print a representation of a circular buffer
-void print(circular_t* circular) {
-    if(circular == NULL) {
-        printf("Bad circular buffer\n");
-        return;
+// Reserve free elements at the tail, to be written in place
+size_t ring_write_reserve(circular_t* circular, size_t nelements, ring_region_t regions[2]) {
+    if((circular == NULL) || (regions == NULL)) {
+        printf("Bad arguments\n");
+        return 0;
     }
 
-    printf("Capacity: %2lu\n", circular->capacity);
-    printf("Occupied: %2lu\n", circular->occupied);
-    printf("Head:     %2lu\n", circular->head);
-    printf("Tail:     %2lu\n", circular->tail);
+    return reserve(circular, circular->tail, circular->capacity - circular->occupied, nelements, regions);
+}
 
-    printf("Contents:\n");
-    for(size_t i = 0; i < circular->capacity; i++) {
-        printf("%2lu ", i);
-    }
-    printf("\n");
-    for(size_t i = 0; i < circular->capacity; i++) {
-        printf("%2c ", circular->buffer[i]);
-    }
-    printf("\n");
-    for(size_t i = 0; i < circular->capacity; i++) {
-        if(circular->head == i) {
-            printf("%*s", (int)i*3+2, "H");
-        }
-    }
-    printf("\n");
-    for(size_t i = 0; i < circular->capacity; i++) {
-        if(circular->tail == i) {
-            printf("%*s", (int)i*3+2, "T");
-        }
+// Commit elements previously reserved at the tail, making them visible to readers
+void ring_write_commit(circular_t* circular, size_t nelements) {
+    if((circular == NULL) || (nelements > (circular->capacity - circular->occupied))) {
+        printf("Bad arguments\n");
+        return;
     }
-    printf("\n");
+
+    // Update the parameters
+    circular->occupied += nelements;
+    circular->tail     += nelements;
+    circular->tail     %= circular->capacity;
 }
 
-int main(void) {
-    // Create a circular buffer
-    printf("Create a circular buffer:\n");
-    circular_t* circular = create(20);
-    if(circular == NULL) {
-        return EXIT_FAILURE;
+// Reserve occupied elements at the head, to be read in place
+size_t ring_read_reserve(circular_t* circular, size_t nelements, ring_region_t regions[2]) {
+    if((circular == NULL) || (regions == NULL)) {
+        printf("Bad arguments\n");
+        return 0;
     }
-    print(circular);
 
-    // Read when the buffer is empty
-    printf("\nRead when the buffer is empty: ");
-    char c = read(circular);
-    if(c != 0) {
-        printf("Bad read\n");
-    }
-    print(circular);
-
-    // Write one at a time to the tail
-    printf("\nWrite one at a time to the tail: ");
-    for(int i = 0; i < 10; i++) {
-        char c = 'a' + i;
-        write(circular, c);
-        printf("%c ", c);
+    return reserve(circular, circular->head, circular->occupied, nelements, regions);
+}
+
+// Commit elements previously reserved at the head, freeing them for writers
+void ring_read_commit(circular_t* circular, size_t nelements) {
+    if((circular == NULL) || (nelements > circular->occupied)) {
+        printf("Bad arguments\n");
+        return;
     }
-    printf("\n");
-    print(circular);
-
-    // Read one at a time from the head
-    printf("\nRead one at a time from the head: ");
-    for(int i = 0; i < 5; i++) {
-        char c = read(circular);
-        printf("%c ", c);
+
+    // Update the parameters
+    circular->occupied -= nelements;
+    circular->head     += nelements;
+    circular->head     %= circular->capacity;
+}
+
+// Fill the free elements at the tail with bytes read from a file descriptor, using a single readv call
+ssize_t ring_fill_from_fd(circular_t* circular, int fd) {
+    if((circular == NULL) || (circular->element_size != 1) || (fd < 0)) {
+        printf("Bad arguments\n");
+        errno = EINVAL;
+        return -1;
     }
-    printf("\n");
-    print(circular);
-
-    // Write one at a time to the tail and wrap-around
-    printf("\nWrite one at a time to the tail and wrap-around: ");
-    for(int i = 10; i < 24; i++) {
-        char c = 'a' + i;
-        write(circular, c);
-        printf("%c ", c);
+
+    // Reserve all of the free space, which may wrap around
+    ring_region_t regions[2];
+    if(ring_write_reserve(circular, circular->capacity, regions) == 0) {
+        errno = ENOBUFS;
+        return -1;
     }
-    printf("\n");
-    print(circular);
-
-    // Read one at a time from the head and wrap-around
-    printf("\nRead one at a time from the head and wrap-around: ");
-    for(int i = 0; i < 17; i++) {
-        char c = read(circular);
-        printf("%c ", c);
+
+    // Read straight into the buffer
+    struct iovec iov[2];
+    int     iovcnt = to_iovec(regions, iov);
+    ssize_t nbytes;
+    do {
+        nbytes = readv(fd, iov, iovcnt);
+    } while((nbytes < 0) && (errno == EINTR));
+
+    // Publish only what was actually read
+    if(nbytes > 0) {
+        ring_write_commit(circular, (size_t)nbytes);
     }
-    printf("\n");
-    print(circular);
-
-    // Write one at a time to the tail and hit the head
-    printf("\nWrite one at a time to the tail and hit the head: ");
-    for(int i = 0; i < 20; i++) {
-        char c = 'a' + i;
-        write(circular, c);
-        printf("%c ", c);
+    return nbytes;
+}
+
+// Drain the occupied elements at the head by writing bytes to a file descriptor, using a single writev call
+ssize_t ring_drain_to_fd(circular_t* circular, int fd) {
+    if((circular == NULL) || (circular->element_size != 1) || (fd < 0)) {
+        printf("Bad arguments\n");
+        errno = EINVAL;
+        return -1;
     }
-    printf("\n");
-    print(circular);
-
-    // Read one at a time from the head and hit the tail
-    printf("\nRead one at a time from the head and hit the tail: ");
-    for(int i = 0; i < 22; i++) {
-        char c = read(circular);
-        printf("%c ", c);
+
+    // Reserve all of the occupied space, which may wrap around
+    ring_region_t regions[2];
+    if(ring_read_reserve(circular, circular->capacity, regions) == 0) {
+        errno = ENODATA;
+        return -1;
     }
-    printf("\n");
-    print(circular);
 
-    // Start anew
-    destroy(&circular);
-    printf("\nStart anew:\n");
-    circular = create(20);
-    if(circular == NULL) {
-        return EXIT_FAILURE;
+    // Write straight out of the buffer
+    struct iovec iov[2];
+    int     iovcnt = to_iovec(regions, iov);
+    ssize_t nbytes;
+    do {
+        nbytes = writev(fd, iov, iovcnt);
+    } while((nbytes < 0) && (errno == EINTR));
+
+    // Free only what was actually written
+    if(nbytes > 0) {
+        ring_read_commit(circular, (size_t)nbytes);
     }
-    print(circular);
-
-    // Write many at a time to the tail
-    printf("\nWrite many at a time to the tail: ");
-    const char* data = "abcdefghijklmno";
-    size_t count = write_many(circular, data, strlen(data));
-    printf("%s (%zu elements)\n", data, count);
-    print(circular);
-
-    // Read many at a time from the head
-    printf("\nRead many at a time from the head: ");
-    char buffer[11];
-    count = read_many(circular, buffer, 10);
-    buffer[10] = '\0';
-    printf("%s (%zu elements)\n", buffer, count);
-    print(circular);
-
-    // Write many at a time to the tail and wrap-around
-    printf("\nWrite many at a time to the tail and wrap-around: ");
-    const char* data2 = "pqrstuvxwyz";
-    count = write_many(circular, data2, strlen(data2));
-    printf("%s (%zu elements)\n", data2, count);
-    print(circular);
-
-    // Read many at a time from the head and wrap-around
-    printf("\nRead many at a time from the head and wrap-around: ");
-    char buffer2[15];
-    count = read_many(circular, buffer2, 14);
-    buffer2[14] = '\0';
-    printf("%s (%zu elements)\n", buffer2, count);
-    print(circular);
-
-    // Write many at a time to the tail and hit the head
-    printf("\nWrite many at a time to the tail and hit the head: ");
-    const char* data3 = "abcdefghijklmnopqrstuvwxyz";
-    count = write_many(circular, data3, strlen(data3));
-    printf("%s (%zu elements)\n", data3, count);
-    print(circular);
-
-    // Read many at a time from the head and hit the tail
-    printf("\nRead many at a time from the head and hit the tail: ");
-    char buffer3[27];
-    count = read_many(circular, buffer3, 26);
-    buffer3[26] = '\0';
-    printf("%s (%zu elements)\n", buffer3, count);
-    print(circular);
-
-    // Clean-up
-    destroy(&circular);
-    return EXIT_SUCCESS;
+    return nbytes;
 }
@@ -0,0 +1,175 @@
+// A circular buffer (or ring buffer).
+//
+// Elements may be of any size, fixed when the buffer is created, and are copied in and out by value.
+//
+// As well as copying elements in and out, the reserve/commit functions hand out pointers into the buffer itself so that
+// producers (e.g. recv or a parser) and consumers can work on the elements in place with no intermediate copy. Because
+// the free or occupied elements may wrap around the end of the buffer, a reservation is made up of at most two
+// contiguous regions. The file descriptor helpers use this to move bytes between a buffer and a socket, pipe or file
+// with one readv/writev call, however the data is split.
+
+#ifndef CIRCULAR_BUFFER_H
+#define CIRCULAR_BUFFER_H
+
+#include <stdbool.h>    // For bool
+#include <stddef.h>     // For size_t
+#include <stdint.h>     // For uint8_t
+#include <sys/types.h>  // For ssize_t
+
+// A circular buffer.
+//
+// Fields:
+//  capacity     : capacity of the buffer i.e. total number of elements.
+//  element_size : size of each element, in bytes.
+//  occupied     : number of elements currently occupied.
+//  head         : index from which to read.
+//  tail         : index at which to write.
+//  buffer       : buffer allocated on the heap.
+typedef struct circular_t {
+    size_t   capacity;
+    size_t   element_size;
+    size_t   occupied;
+    size_t   head;
+    size_t   tail;
+    uint8_t* buffer;
+} circular_t;
+
+// A contiguous region of elements within a circular buffer.
+//
+// Fields:
+//  data      : pointer to the first element of the region.
+//  nelements : number of elements in the region, 0 if the region is unused.
+typedef struct ring_region_t {
+    void*  data;
+    size_t nelements;
+} ring_region_t;
+
+// Create a new circular buffer.
+//
+// Parameters:
+//  capacity     : capacity of the buffer i.e. total number of elements.
+//  element_size : size of each element, in bytes.
+//
+// Returns:
+//  pointer to the circular buffer or NULL if the arguments are bad or memory could not be allocated.
+circular_t* ring_create(size_t capacity, size_t element_size);
+
+// Destroy a circular buffer.
+//
+// Parameters:
+//  circular : pointer to pointer to the circular buffer.
+void ring_destroy(circular_t** circular);
+
+// Read a single element from the head.
+//
+// Parameters:
+//  circular : pointer to the circular buffer.
+//  element  : pointer into which the element will be copied.
+//
+// Returns:
+//  true     : the element was read.
+//  false    : the element was not read i.e. the buffer is empty.
+bool ring_read(circular_t* circular, void* element);
+
+// Read many elements at a time from the head.
+//
+// Parameters:
+//  circular  : pointer to the circular buffer.
+//  data      : pointer into which the elements will be copied.
+//  nelements : maximum number of elements to read.
+//
+// Returns:
+//  the number of elements actually read, fewer than requested if the buffer holds fewer.
+size_t ring_read_many(circular_t* circular, void* data, size_t nelements);
+
+// Write a single element to the tail.
+//
+// Parameters:
+//  circular : pointer to the circular buffer.
+//  element  : pointer to the element to be copied in.
+//
+// Returns:
+//  true     : the element was written.
+//  false    : the element was not written i.e. the buffer is full.
+bool ring_write(circular_t* circular, const void* element);
+
+// Write many elements at a time to the tail.
+//
+// Parameters:
+//  circular  : pointer to the circular buffer.
+//  data      : pointer to the elements to be copied in.
+//  nelements : maximum number of elements to write.
+//
+// Returns:
+//  the number of elements actually written, fewer than requested if the buffer has less space.
+size_t ring_write_many(circular_t* circular, const void* data, size_t nelements);
+
+// Reserve free elements at the tail, to be written in place.
+//
+// The elements are not visible to readers until ring_write_commit is called.
+//
+// Parameters:
+//  circular  : pointer to the circular buffer.
+//  nelements : maximum number of elements to reserve.
+//  regions   : the (up to two) regions reserved, in order.
+//
+// Returns:
+//  the number of elements actually reserved, fewer than requested if the buffer has less space.
+size_t ring_write_reserve(circular_t* circular, size_t nelements, ring_region_t regions[2]);
+
+// Commit elements previously reserved at the tail, making them visible to readers.
+//
+// Parameters:
+//  circular  : pointer to the circular buffer.
+//  nelements : number of elements written, no more than were reserved.
+void ring_write_commit(circular_t* circular, size_t nelements);
+
+// Reserve occupied elements at the head, to be read in place.
+//
+// The elements are not freed until ring_read_commit is called.
+//
+// Parameters:
+//  circular  : pointer to the circular buffer.
+//  nelements : maximum number of elements to reserve.
+//  regions   : the (up to two) regions reserved, in order.
+//
+// Returns:
+//  the number of elements actually reserved, fewer than requested if the buffer holds fewer.
+size_t ring_read_reserve(circular_t* circular, size_t nelements, ring_region_t regions[2]);
+
+// Commit elements previously reserved at the head, freeing them for writers.
+//
+// Parameters:
+//  circular  : pointer to the circular buffer.
+//  nelements : number of elements read, no more than were reserved.
+void ring_read_commit(circular_t* circular, size_t nelements);
+
+// Fill the free elements at the tail with bytes read from a file descriptor, using a single readv call.
+//
+// The buffer must have been created with an element size of 1. Fewer bytes than are free may be read, in which case
+// only those bytes are committed. The call is retried if it is interrupted by a signal.
+//
+// Parameters:
+//  circular : pointer to the circular buffer.
+//  fd       : file descriptor to read from.
+//
+// Returns:
+//  the number of bytes read, 0 at end of file only, or -1 with errno set: ENOBUFS if the buffer is full, or the error
+//  from readv (e.g. EAGAIN for a non-blocking file descriptor with no data available).
+ssize_t ring_fill_from_fd(circular_t* circular, int fd);
+
+// Drain the occupied elements at the head by writing bytes to a file descriptor, using a single writev call.
+//
+// The buffer must have been created with an element size of 1. Fewer bytes than are occupied may be written, in which
+// case only those bytes are freed. The call is retried if it is interrupted by a signal.
+//
+// Parameters:
+//  circular : pointer to the circular buffer.
+//  fd       : file descriptor to write to.
+//
+// Returns:
+//  the number of bytes written, or -1 with errno set: ENODATA if the buffer is empty, or the error from writev (e.g.
+//  EAGAIN for a non-blocking file descriptor that cannot accept more data).
+ssize_t ring_drain_to_fd(circular_t* circular, int fd);
+
+#endif // CIRCULAR_BUFFER_H
@@ -0,0 +1,361 @@
+// A circular buffer (or ring buffer)
+
+#include <errno.h>              // For errno
+#include <pthread.h>            // For pthread_create, pthread_join
+#include <stdbool.h>            // For bool, true, false
+#include <stdio.h>              // For printf
+#include <stdlib.h>             // For NULL, EXIT_FAILURE, EXIT_SUCCESS, size_t
+#include <string.h>             // For strlen, strerror
+#include <unistd.h>             // For pipe, close
+#include "circular_buffer.h"    // For ring_create, ring_read, ring_write et al
+#include "mpmc.h"               // For mpmc_create, mpmc_push, mpmc_pop
+
+// Print a representation of a circular buffer
+void print(circular_t* circular) {
+    if(circular == NULL) {
+        printf("Bad circular buffer\n");
+        return;
+    }
+
+    printf("Capacity: %2lu\n", circular->capacity);
+    printf("Occupied: %2lu\n", circular->occupied);
+    printf("Head:     %2lu\n", circular->head);
+    printf("Tail:     %2lu\n", circular->tail);
+
+    printf("Contents:\n");
+    for(size_t i = 0; i < circular->capacity; i++) {
+        printf("%2lu ", i);
+    }
+    printf("\n");
+    for(size_t i = 0; i < circular->capacity; i++) {
+        // Only the occupied elements, from the head up to the tail, hold characters
+        size_t offset = (i + circular->capacity - circular->head) % circular->capacity;
+        printf("%2c ", (offset < circular->occupied) ? (char)circular->buffer[i] : ' ');
+    }
+    printf("\n");
+    for(size_t i = 0; i < circular->capacity; i++) {
+        if(circular->head == i) {
+            printf("%*s", (int)i*3+2, "H");
+        }
+    }
+    printf("\n");
+    for(size_t i = 0; i < circular->capacity; i++) {
+        if(circular->tail == i) {
+            printf("%*s", (int)i*3+2, "T");
+        }
+    }
+    printf("\n");
+}
+
+// Read a single character from the head, or 0 if the buffer is empty
+char read_char(circular_t* circular) {
+    char c = 0;
+    if(!ring_read(circular, &c)) {
+        printf("Buffer is empty\n");
+    }
+    return c;
+}
+
+// Write a single character to the tail, dropping it if the buffer is full
+void write_char(circular_t* circular, char c) {
+    if(!ring_write(circular, &c)) {
+        printf("Buffer is full\n");
+    }
+}
+
+// Number of producer and consumer threads sharing the multi-producer/multi-consumer queue
+#define NPRODUCERS      4
+#define NCONSUMERS      4
+#define NPUSHES         100000
+
+// Arguments for a producer or consumer thread
+typedef struct worker_t {
+    mpmc_t*   queue;    // queue shared by all of the threads
+    long long sum;      // sum of the elements pushed or popped by this thread
+} worker_t;
+
+// Push a run of elements, blocking whenever the queue is full
+void* producer(void* arg) {
+    worker_t* worker = arg;
+    for(int i = 1; i <= NPUSHES; i++) {
+        mpmc_push(worker->queue, &i);
+        worker->sum += i;
+    }
+    return NULL;
+}
+
+// Pop a run of elements, blocking whenever the queue is empty
+void* consumer(void* arg) {
+    worker_t* worker = arg;
+    for(int i = 1; i <= NPUSHES * NPRODUCERS / NCONSUMERS; i++) {
+        int element;
+        mpmc_pop(worker->queue, &element);
+        worker->sum += element;
+    }
+    return NULL;
+}
+
+// Stand in for the threads that could not be started, pushing and popping their elements without blocking, so that
+// the threads that did start are not left waiting on the queue
+void stand_in(mpmc_t* queue, long long npushes, long long npops) {
+    int element = 1;
+    while((npushes > 0) || (npops > 0)) {
+        if((npushes > 0) && mpmc_try_push(queue, &element)) {
+            npushes--;
+        }
+        if((npops > 0) && mpmc_try_pop(queue, &element)) {
+            npops--;
+        }
+    }
+}
+
+int main(void) {
+    // Create a circular buffer
+    printf("Create a circular buffer:\n");
+    circular_t* circular = ring_create(20, sizeof(char));
+    if(circular == NULL) {
+        return EXIT_FAILURE;
+    }
+    print(circular);
+
+    // Read when the buffer is empty
+    printf("\nRead when the buffer is empty: ");
+    char c = read_char(circular);
+    if(c != 0) {
+        printf("Bad read\n");
+    }
+    print(circular);
+
+    // Write one at a time to the tail
+    printf("\nWrite one at a time to the tail: ");
+    for(int i = 0; i < 10; i++) {
+        char c = 'a' + i;
+        write_char(circular, c);
+        printf("%c ", c);
+    }
+    printf("\n");
+    print(circular);
+
+    // Read one at a time from the head
+    printf("\nRead one at a time from the head: ");
+    for(int i = 0; i < 5; i++) {
+        char c = read_char(circular);
+        printf("%c ", c);
+    }
+    printf("\n");
+    print(circular);
+
+    // Write one at a time to the tail and wrap-around
+    printf("\nWrite one at a time to the tail and wrap-around: ");
+    for(int i = 10; i < 24; i++) {
+        char c = 'a' + i;
+        write_char(circular, c);
+        printf("%c ", c);
+    }
+    printf("\n");
+    print(circular);
+
+    // Read one at a time from the head and wrap-around
+    printf("\nRead one at a time from the head and wrap-around: ");
+    for(int i = 0; i < 17; i++) {
+        char c = read_char(circular);
+        printf("%c ", c);
+    }
+    printf("\n");
+    print(circular);
+
+    // Write one at a time to the tail and hit the head
+    printf("\nWrite one at a time to the tail and hit the head: ");
+    for(int i = 0; i < 20; i++) {
+        char c = 'a' + i;
+        write_char(circular, c);
+        printf("%c ", c);
+    }
+    printf("\n");
+    print(circular);
+
+    // Read one at a time from the head and hit the tail
+    printf("\nRead one at a time from the head and hit the tail: ");
+    for(int i = 0; i < 22; i++) {
+        char c = read_char(circular);
+        printf("%c ", c);
+    }
+    printf("\n");
+    print(circular);
+
+    // Start anew
+    ring_destroy(&circular);
+    printf("\nStart anew:\n");
+    circular = ring_create(20, sizeof(char));
+    if(circular == NULL) {
+        return EXIT_FAILURE;
+    }
+    print(circular);
+
+    // Write many at a time to the tail
+    printf("\nWrite many at a time to the tail: ");
+    const char* data = "abcdefghijklmno";
+    size_t count = ring_write_many(circular, data, strlen(data));
+    printf("%s (%zu elements)\n", data, count);
+    print(circular);
+
+    // Read many at a time from the head
+    printf("\nRead many at a time from the head: ");
+    char buffer[11];
+    count = ring_read_many(circular, buffer, 10);
+    buffer[10] = '\0';
+    printf("%s (%zu elements)\n", buffer, count);
+    print(circular);
+
+    // Write many at a time to the tail and wrap-around
+    printf("\nWrite many at a time to the tail and wrap-around: ");
+    const char* data2 = "pqrstuvxwyz";
+    count = ring_write_many(circular, data2, strlen(data2));
+    printf("%s (%zu elements)\n", data2, count);
+    print(circular);
+
+    // Read many at a time from the head and wrap-around
+    printf("\nRead many at a time from the head and wrap-around: ");
+    char buffer2[15];
+    count = ring_read_many(circular, buffer2, 14);
+    buffer2[14] = '\0';
+    printf("%s (%zu elements)\n", buffer2, count);
+    print(circular);
+
+    // Write many at a time to the tail and hit the head
+    printf("\nWrite many at a time to the tail and hit the head: ");
+    const char* data3 = "abcdefghijklmnopqrstuvwxyz";
+    count = ring_write_many(circular, data3, strlen(data3));
+    printf("%s (%zu elements)\n", data3, count);
+    print(circular);
+
+    // Read many at a time from the head and hit the tail
+    printf("\nRead many at a time from the head and hit the tail: ");
+    char buffer3[27];
+    count = ring_read_many(circular, buffer3, 26);
+    buffer3[26] = '\0';
+    printf("%s (%zu elements)\n", buffer3, count);
+    print(circular);
+
+    // Write in place to the tail and wrap-around, as a producer such as recv would
+    printf("\nWrite in place to the tail and wrap-around: ");
+    ring_region_t regions[2];
+    count = ring_write_reserve(circular, 20, regions);
+    char next = 'A';
+    for(size_t r = 0; r < 2; r++) {
+        char* region = regions[r].data;
+        for(size_t i = 0; i < regions[r].nelements; i++) {
+            region[i] = next++;
+        }
+        printf("%zu ", regions[r].nelements);
+    }
+    ring_write_commit(circular, count);
+    printf("(%zu elements)\n", count);
+    print(circular);
+
+    // Read in place from the head and wrap-around
+    printf("\nRead in place from the head and wrap-around: ");
+    count = ring_read_reserve(circular, 20, regions);
+    for(size_t r = 0; r < 2; r++) {
+        printf("%.*s ", (int)regions[r].nelements, (char*)regions[r].data);
+    }
+    ring_read_commit(circular, count);
+    printf("(%zu elements)\n", count);
+    print(circular);
+
+    // Move data through a pipe with one system call per transfer, however the data wraps around
+    int fds[2];
+    if(pipe(fds) != 0) {
+        printf("Failed to create pipe\n");
+        ring_destroy(&circular);
+        return EXIT_FAILURE;
+    }
+    const char* data4 = "the quick brown fox";
+    ring_write_many(circular, data4, strlen(data4));
+    printf("\nDrain to a pipe from the head and wrap-around: ");
+    printf("%zd bytes\n", ring_drain_to_fd(circular, fds[1]));
+    print(circular);
+    printf("\nFill from a pipe at the tail and wrap-around: ");
+    printf("%zd bytes\n", ring_fill_from_fd(circular, fds[0]));
+    print(circular);
+
+    // A full buffer is reported as an error rather than as the end of the file
+    ring_write(circular, "!");
+    const ssize_t nbytes = ring_fill_from_fd(circular, fds[0]);
+    printf("\nFill a full buffer from a pipe: %zd (%s)\n", nbytes, strerror(errno));
+    close(fds[0]);
+    close(fds[1]);
+
+    // Clean-up
+    ring_destroy(&circular);
+
+    // Elements may be of any size
+    printf("\nStore doubles rather than chars: ");
+    circular = ring_create(4, sizeof(double));
+    if(circular == NULL) {
+        return EXIT_FAILURE;
+    }
+    const double samples[] = { 0.5, 1.5, 2.5, 3.5, 4.5 };
+    count = ring_write_many(circular, samples, sizeof(samples) / sizeof(samples[0]));
+    printf("%zu elements written, ", count);
+    double sample = 0.0;
+    while(ring_read(circular, &sample)) {
+        printf("%.1f ", sample);
+    }
+    printf("\n");
+    ring_destroy(&circular);
+
+    // Share a small multi-producer/multi-consumer queue between many threads
+    printf("\nMulti-producer/multi-consumer queue: ");
+    mpmc_t* queue = mpmc_create(16, sizeof(int));
+    if(queue == NULL) {
+        return EXIT_FAILURE;
+    }
+    printf("%d producers, %d consumers, capacity %zu\n", NPRODUCERS, NCONSUMERS, mpmc_capacity(queue));
+
+    pthread_t threads[NPRODUCERS + NCONSUMERS];
+    worker_t  workers[NPRODUCERS + NCONSUMERS];
+    int       nstarted = 0;
+    for(; nstarted < NPRODUCERS + NCONSUMERS; nstarted++) {
+        workers[nstarted].queue = queue;
+        workers[nstarted].sum   = 0;
+        const int error = pthread_create(&threads[nstarted], NULL, (nstarted < NPRODUCERS) ? producer : consumer,
+                                         &workers[nstarted]);
+        if(error != 0) {
+            printf("pthread_create failed: %s\n", strerror(error));
+            break;
+        }
+    }
+    if(nstarted < NPRODUCERS + NCONSUMERS) {
+        const int nproducers = (nstarted < NPRODUCERS) ? nstarted : NPRODUCERS;
+        const int nconsumers = nstarted - nproducers;
+        stand_in(queue, (long long)(NPRODUCERS - nproducers) * NPUSHES,
+                 (long long)(NCONSUMERS - nconsumers) * (NPUSHES * NPRODUCERS / NCONSUMERS));
+        for(int i = 0; i < nstarted; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        mpmc_destroy(&queue);
+        return EXIT_FAILURE;
+    }
+
+    long long pushed = 0;
+    long long popped = 0;
+    for(int i = 0; i < NPRODUCERS + NCONSUMERS; i++) {
+        pthread_join(threads[i], NULL);
+        if(i < NPRODUCERS) {
+            pushed += workers[i].sum;
+        }
+        else {
+            popped += workers[i].sum;
+        }
+    }
+    printf("Sum pushed: %lld\n", pushed);
+    printf("Sum popped: %lld\n", popped);
+    if(pushed != popped) {
+        printf("Bad queue\n");
+    }
+
+    // Clean-up
+    mpmc_destroy(&queue);
+    return (pushed == popped) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
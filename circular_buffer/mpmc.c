@@ -0,0 +1,312 @@
+// Multi-producer/multi-consumer bounded queue built on a circular buffer.
+//
+// Each slot of the circular buffer carries a sequence number, as described by Dmitry Vyukov. Producers and consumers
+// claim a slot with a single compare-and-swap on the tail or head index, and the sequence number then tells the other
+// side when the slot has been filled or emptied. No locks are taken.
+//
+// The blocking wrappers sleep on a futex (Linux) when the queue is full or empty, rather than dropping elements.
+//
+// See https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+
+#define _DEFAULT_SOURCE     // For syscall
+
+#include <assert.h>         // For assert
+#include <errno.h>          // For errno
+#include <stdint.h>         // For intptr_t, uint8_t, uint32_t
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For malloc, free
+#include <string.h>         // For memcpy, strerror
+#if defined(__linux__)
+#include <linux/futex.h>    // For FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+#include <sys/syscall.h>    // For SYS_futex
+#include <unistd.h>         // For syscall
+#else
+#include <sched.h>          // For sched_yield
+#endif
+#include "mpmc.h"           // This module
+
+// Size of a cache line, in bytes. Indices written by different threads are kept this far apart to avoid false sharing.
+#define CACHE_LINE 64
+
+// Concrete type for a queue, corresponding to typedef mpmc_t.
+//
+// Fields:
+//  tail          : index at which to write, claimed by producers.
+//  head          : index from which to read, claimed by consumers.
+//  not_full      : futex word, incremented when a consumer frees a slot and a producer is waiting.
+//  full_waiters  : number of producers waiting for the queue to become not full.
+//  not_empty     : futex word, incremented when a producer fills a slot and a consumer is waiting.
+//  empty_waiters : number of consumers waiting for the queue to become not empty.
+//  mask          : capacity - 1, the capacity being a power of 2.
+//  element_size  : size of each element, in bytes.
+//  slot_size     : size of each slot i.e. the sequence number followed by the (padded) element, in bytes.
+//  slots         : array of slots, will be allocated when the queue is created.
+struct mpmc_tag {
+    size_t   tail;
+    uint8_t  pad0[CACHE_LINE - sizeof(size_t)];
+    size_t   head;
+    uint8_t  pad1[CACHE_LINE - sizeof(size_t)];
+    uint32_t not_full;
+    uint32_t full_waiters;
+    uint8_t  pad2[CACHE_LINE - 2 * sizeof(uint32_t)];
+    uint32_t not_empty;
+    uint32_t empty_waiters;
+    uint8_t  pad3[CACHE_LINE - 2 * sizeof(uint32_t)];
+    size_t   mask;
+    size_t   element_size;
+    size_t   slot_size;
+    uint8_t* slots;
+};
+
+// Get the sequence number of the slot for an index.
+static inline size_t * sequence_at(const mpmc_t * const queue, size_t index) {
+    return (size_t *)(queue->slots + (index & queue->mask) * queue->slot_size);
+}
+
+// Get the element of the slot for an index.
+static inline uint8_t * element_at(const mpmc_t * const queue, size_t index) {
+    return queue->slots + (index & queue->mask) * queue->slot_size + sizeof(size_t);
+}
+
+// Sleep while a futex word holds the expected value.
+static void futex_wait(uint32_t * const futex, uint32_t expected) {
+#if defined(__linux__)
+    syscall(SYS_futex, futex, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+#else
+    (void)futex;
+    (void)expected;
+    sched_yield();
+#endif
+}
+
+// Wake one thread sleeping on a futex word.
+static void futex_wake(uint32_t * const futex) {
+#if defined(__linux__)
+    syscall(SYS_futex, futex, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+    (void)futex;
+#endif
+}
+
+// Wake a waiter, if there are any, after a slot has been filled or emptied.
+//
+// The fence pairs with the one in the blocking wrappers: either the waiter sees the slot that was just filled or
+// emptied when it checks again, or this sees the waiter and moves the futex word on so that it cannot sleep.
+static void notify(uint32_t * const event, const uint32_t * const waiters) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(waiters, __ATOMIC_RELAXED) > 0) {
+        __atomic_fetch_add(event, 1, __ATOMIC_SEQ_CST);
+        futex_wake(event);
+    }
+}
+
+// Create a queue i.e. allocate and initialise all memory.
+//
+// Parameters:
+//  capacity     : minimum number of elements that the queue can hold, rounded up to a power of 2.
+//  element_size : size of each element, in bytes.
+//
+// Returns:
+//  pointer to the queue or NULL if memory could not be allocated.
+mpmc_t * mpmc_create(size_t capacity, size_t element_size) {
+    assert(capacity     != 0);
+    assert(element_size != 0);
+
+    // Allocate the queue.
+    mpmc_t * queue = malloc(sizeof(mpmc_t));
+    if(queue == NULL) {
+        printf("Failed to allocate queue: %s", strerror(errno));
+        return NULL;
+    }
+
+    // Round the capacity up to a power of 2 (and at least 2) so that indices can wrap with a mask.
+    size_t rounded = 2;
+    while(rounded < capacity) {
+        rounded <<= 1;
+    }
+
+    // Set the metadata, keeping each sequence number aligned.
+    queue->tail          = 0;
+    queue->head          = 0;
+    queue->not_full      = 0;
+    queue->full_waiters  = 0;
+    queue->not_empty     = 0;
+    queue->empty_waiters = 0;
+    queue->mask          = rounded - 1;
+    queue->element_size  = element_size;
+    queue->slot_size     = sizeof(size_t) + ((element_size + sizeof(size_t) - 1) / sizeof(size_t)) * sizeof(size_t);
+
+    // Allocate space for the array of slots.
+    queue->slots = malloc(rounded * queue->slot_size);
+    if(queue->slots == NULL) {
+        printf("Failed to allocate slots: %s", strerror(errno));
+        free(queue);
+        return NULL;
+    }
+
+    // Each slot is initially free for the producer whose tail index matches its sequence number.
+    for(size_t i = 0; i < rounded; i++) {
+        *sequence_at(queue, i) = i;
+    }
+
+    return queue;
+}
+
+// Destroy a queue i.e. free all allocated memory.
+//
+// No other thread may be using the queue.
+//
+// Parameters:
+//  queue : pointer to pointer to the queue.
+void mpmc_destroy(mpmc_t ** queue) {
+    assert(queue != NULL);
+
+    free((*queue)->slots);
+    free(*queue);
+    *queue = NULL;
+}
+
+// Get the capacity of a queue i.e. the number of elements that it can hold.
+//
+// Parameters:
+//  queue   : pointer to the queue.
+//
+// Returns:
+//  the capacity of the queue.
+size_t mpmc_capacity(const mpmc_t * const queue) {
+    assert(queue != NULL);
+
+    return queue->mask + 1;
+}
+
+// Push an element onto the tail of a queue, without blocking.
+//
+// Parameters:
+//  queue   : pointer to the queue.
+//  element : pointer to the element to be copied into the queue.
+//
+// Returns:
+//  true    : the element was pushed.
+//  false   : the element was not pushed i.e. the queue is full.
+bool mpmc_try_push(mpmc_t * const queue, const void * const element) {
+    assert(queue   != NULL);
+    assert(element != NULL);
+
+    size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    for(;;) {
+        size_t * sequence   = sequence_at(queue, tail);
+        intptr_t difference = (intptr_t)__atomic_load_n(sequence, __ATOMIC_ACQUIRE) - (intptr_t)tail;
+
+        // Is the slot free for this lap? Then try to claim it.
+        if(difference == 0) {
+            if(__atomic_compare_exchange_n(&queue->tail, &tail, tail + 1, true, __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED)) {
+                // Copy the element in, then publish it to consumers.
+                memcpy(element_at(queue, tail), element, queue->element_size);
+                __atomic_store_n(sequence, tail + 1, __ATOMIC_RELEASE);
+
+                notify(&queue->not_empty, &queue->empty_waiters);
+                return true;
+            }
+            // Another producer claimed the slot, the tail has been reloaded.
+        }
+        // Is the slot still occupied from the previous lap? Then the queue is full.
+        else if(difference < 0) {
+            return false;
+        }
+        // Another producer has moved the tail on, catch up.
+        else {
+            tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Pop an element from the head of a queue, without blocking.
+//
+// Parameters:
+//  queue   : pointer to the queue.
+//  element : pointer into which the element will be copied.
+//
+// Returns:
+//  true    : the element was popped.
+//  false   : the element was not popped i.e. the queue is empty.
+bool mpmc_try_pop(mpmc_t * const queue, void * const element) {
+    assert(queue   != NULL);
+    assert(element != NULL);
+
+    size_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    for(;;) {
+        size_t * sequence   = sequence_at(queue, head);
+        intptr_t difference = (intptr_t)__atomic_load_n(sequence, __ATOMIC_ACQUIRE) - (intptr_t)(head + 1);
+
+        // Has the slot been filled for this lap? Then try to claim it.
+        if(difference == 0) {
+            if(__atomic_compare_exchange_n(&queue->head, &head, head + 1, true, __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED)) {
+                // Copy the element out, then free the slot for the producer on the next lap.
+                memcpy(element, element_at(queue, head), queue->element_size);
+                __atomic_store_n(sequence, head + queue->mask + 1, __ATOMIC_RELEASE);
+
+                notify(&queue->not_full, &queue->full_waiters);
+                return true;
+            }
+            // Another consumer claimed the slot, the head has been reloaded.
+        }
+        // Is the slot still waiting to be filled? Then the queue is empty.
+        else if(difference < 0) {
+            return false;
+        }
+        // Another consumer has moved the head on, catch up.
+        else {
+            head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Push an element onto the tail of a queue, blocking while the queue is full.
+//
+// Parameters:
+//  queue   : pointer to the queue.
+//  element : pointer to the element to be copied into the queue.
+void mpmc_push(mpmc_t * const queue, const void * const element) {
+    while(!mpmc_try_push(queue, element)) {
+        // Register as a waiter, then check again in case a consumer freed a slot in the meantime.
+        __atomic_fetch_add(&queue->full_waiters, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        uint32_t event  = __atomic_load_n(&queue->not_full, __ATOMIC_SEQ_CST);
+        bool     pushed = mpmc_try_push(queue, element);
+        if(!pushed) {
+            // Sleep until a consumer moves the futex word on.
+            futex_wait(&queue->not_full, event);
+        }
+        __atomic_fetch_sub(&queue->full_waiters, 1, __ATOMIC_SEQ_CST);
+
+        if(pushed) {
+            return;
+        }
+    }
+}
+
+// Pop an element from the head of a queue, blocking while the queue is empty.
+//
+// Parameters:
+//  queue   : pointer to the queue.
+//  element : pointer into which the element will be copied.
+void mpmc_pop(mpmc_t * const queue, void * const element) {
+    while(!mpmc_try_pop(queue, element)) {
+        // Register as a waiter, then check again in case a producer filled a slot in the meantime.
+        __atomic_fetch_add(&queue->empty_waiters, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        uint32_t event  = __atomic_load_n(&queue->not_empty, __ATOMIC_SEQ_CST);
+        bool     popped = mpmc_try_pop(queue, element);
+        if(!popped) {
+            // Sleep until a producer moves the futex word on.
+            futex_wait(&queue->not_empty, event);
+        }
+        __atomic_fetch_sub(&queue->empty_waiters, 1, __ATOMIC_SEQ_CST);
+
+        if(popped) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,83 @@
+// Multi-producer/multi-consumer bounded queue built on a circular buffer.
+//
+// Each slot of the circular buffer carries a sequence number, as described by Dmitry Vyukov. Producers and consumers
+// claim a slot with a single compare-and-swap on the tail or head index, and the sequence number then tells the other
+// side when the slot has been filled or emptied. No locks are taken.
+//
+// The blocking wrappers sleep on a futex (Linux) when the queue is full or empty, rather than dropping elements.
+//
+// See https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+
+#ifndef MPMC_H
+#define MPMC_H
+
+#include <stdbool.h>    // For bool
+#include <stddef.h>     // For size_t
+
+// Opaque type for a multi-producer/multi-consumer queue.
+typedef struct mpmc_tag mpmc_t;
+
+// Create a queue i.e. allocate and initialise all memory.
+//
+// Parameters:
+//  capacity     : minimum number of elements that the queue can hold, rounded up to a power of 2.
+//  element_size : size of each element, in bytes.
+//
+// Returns:
+//  pointer to the queue or NULL if memory could not be allocated.
+mpmc_t * mpmc_create(size_t capacity, size_t element_size);
+
+// Destroy a queue i.e. free all allocated memory.
+//
+// No other thread may be using the queue.
+//
+// Parameters:
+//  queue : pointer to pointer to the queue.
+void mpmc_destroy(mpmc_t ** queue);
+
+// Get the capacity of a queue i.e. the number of elements that it can hold.
+//
+// Parameters:
+//  queue   : pointer to the queue.
+//
+// Returns:
+//  the capacity of the queue.
+size_t mpmc_capacity(const mpmc_t * const queue);
+
+// Push an element onto the tail of a queue, without blocking.
+//
+// Parameters:
+//  queue   : pointer to the queue.
+//  element : pointer to the element to be copied into the queue.
+//
+// Returns:
+//  true    : the element was pushed.
+//  false   : the element was not pushed i.e. the queue is full.
+bool mpmc_try_push(mpmc_t * const queue, const void * const element);
+
+// Pop an element from the head of a queue, without blocking.
+//
+// Parameters:
+//  queue   : pointer to the queue.
+//  element : pointer into which the element will be copied.
+//
+// Returns:
+//  true    : the element was popped.
+//  false   : the element was not popped i.e. the queue is empty.
+bool mpmc_try_pop(mpmc_t * const queue, void * const element);
+
+// Push an element onto the tail of a queue, blocking while the queue is full.
+//
+// Parameters:
+//  queue   : pointer to the queue.
+//  element : pointer to the element to be copied into the queue.
+void mpmc_push(mpmc_t * const queue, const void * const element);
+
+// Pop an element from the head of a queue, blocking while the queue is empty.
+//
+// Parameters:
+//  queue   : pointer to the queue.
+//  element : pointer into which the element will be copied.
+void mpmc_pop(mpmc_t * const queue, void * const element);
+
+#endif // MPMC_H
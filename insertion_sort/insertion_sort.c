@@ -3,17 +3,18 @@
 // This has an average case performance of O(n^2)
 //
 // See https://en.wikipedia.org/wiki/Insertion_sort
+// See https://en.wikipedia.org/wiki/Bitonic_sorter
 
-#include <stdio.h>  // For printf
-#include <stdlib.h> // For EXIT_SUCCESS
-#include <string.h> // For memmove
+#include <limits.h>         // For INT_MAX
+#include <stdio.h>          // For printf
+#include <string.h>         // For memmove
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>      // For the AVX2 intrinsics
+#endif
+#include "insertion_sort.h" // This module
 
-#define NELEMENTS(a)    (sizeof(a) / sizeof(a[0]))
-
-// Comparison function used when sorting
-int compare(int a, int b) {
-    return a - b;
-}
+// Number of int values in an AVX2 register
+#define LANES           8
 
 // Insertion sort moving one element at a time
 void insertion_sort(int* data, size_t nelements, int (*compare)(int a, int b)) {
@@ -59,43 +60,212 @@ void insertion_sort_move(int* data, size_t nelements, int (*compare)(int a, int
         }
 
         // Move the larger elements to the right as a block
-        memmove(data + i + 1, data + i, (j - i) * sizeof(int));
+        memmove(data + i + 2, data + i + 1, (j - i - 1) * sizeof(int));
 
         // Move the sorted element to the left
         data[i+1] = value;
     }
 }
 
-// Print an array of values
-void print(const char* msg, const int *data, size_t nelements) {
-    if((data == NULL) || (nelements == 0)) {
-        printf("Bad arguments\n");
+// Insertion sort in ascending order without branching on the values
+void insertion_sort_branchless(int* data, size_t nelements) {
+    if(data == NULL) {
         return;
     }
 
-    printf("%s", msg);
-    for(size_t i = 0; i < nelements; i++) {
-        printf("%2d ", data[i]);
+    for(size_t j = 1; j < nelements; j++) {
+        // The sorted values greater than the one being sorted are a suffix of the sorted prefix, so shift every value
+        // that is greater than it right by one and count them, rather than stopping at the first that is not
+        const int value = data[j];
+        size_t    moved = 0;
+        for(size_t i = j; i > 0; i--) {
+            const int  left    = data[i - 1];
+            const bool greater = left > value;
+            data[i]  = greater ? left : data[i];
+            moved   += greater;
+        }
+        data[j - moved] = value;
+    }
+}
+
+// Sort a power of 2 number of values with a bitonic network, one compare-exchange at a time
+static void network_scalar(int* data, size_t nelements) {
+    // Merge runs of k/2 values, sorted alternately ascending and descending, into runs of k
+    for(size_t k = 2; k <= nelements; k *= 2) {
+        for(size_t j = k / 2; j > 0; j /= 2) {
+            for(size_t i = 0; i < nelements; i++) {
+                const size_t partner = i ^ j;
+                if(partner > i) {
+                    const int  a         = data[i];
+                    const int  b         = data[partner];
+                    const bool ascending = (i & k) == 0;
+                    const int  lo        = (a < b) ? a : b;
+                    const int  hi        = (a < b) ? b : a;
+                    data[i]       = ascending ? lo : hi;
+                    data[partner] = ascending ? hi : lo;
+                }
+            }
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Exchange the values of a register with those at a distance of 1, 2 or 4 lanes
+#define SWAP_1(v)   _mm256_shuffle_epi32((v), 0xB1)
+#define SWAP_2(v)   _mm256_shuffle_epi32((v), 0x4E)
+#define SWAP_4(v)   _mm256_permute2x128_si256((v), (v), 1)
+
+// Compare-exchange each value of a register with its partner, keeping the minimum in the lanes set in mask and the
+// maximum in the others
+#define EXCHANGE(v, partner, mask)  _mm256_blend_epi32(_mm256_max_epi32((v), (partner)), \
+                                                       _mm256_min_epi32((v), (partner)), (mask))
+
+// Sort the bitonic sequence in a register
+__attribute__((target("avx2")))
+static inline __m256i merge_avx2(__m256i v) {
+    v = EXCHANGE(v, SWAP_4(v), 0x0F);
+    v = EXCHANGE(v, SWAP_2(v), 0x33);
+    v = EXCHANGE(v, SWAP_1(v), 0x55);
+    return v;
+}
+
+// Sort the values in a register, making sorted pairs and then bitonic quads before merging them
+__attribute__((target("avx2")))
+static inline __m256i sort_avx2(__m256i v) {
+    v = EXCHANGE(v, SWAP_1(v), 0x99);
+    v = EXCHANGE(v, SWAP_2(v), 0xC3);
+    v = EXCHANGE(v, SWAP_1(v), 0xA5);
+    return merge_avx2(v);
+}
+
+// Reverse the values in a register
+__attribute__((target("avx2")))
+static inline __m256i reverse_avx2(__m256i v) {
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+// Sort up to 8 registers of values with a bitonic network in AVX2 registers, padding the last with INT_MAX
+//
+// Each register is sorted, then runs of registers are merged in pairs. The second run of each pair is reversed, so that
+// the two make a bitonic sequence, which is merged by min/max between registers at halving distances and finally
+// within each register.
+__attribute__((target("avx2"), always_inline))
+static inline void network_avx2(int* data, size_t nregs, size_t nelements) {
+    // Load the values, padding the last register with values that sort last
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i last  = _mm256_set1_epi32(INT_MAX);
+    __m256i       r[SMALL_SORT_MAX / LANES];
+    for(size_t i = 0; i < nregs; i++) {
+        if((i + 1)*LANES <= nelements) {
+            r[i] = _mm256_loadu_si256((const __m256i*)(data + i*LANES));
+        }
+        else {
+            const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(nelements - i*LANES)), lanes);
+            r[i] = _mm256_blendv_epi8(last, _mm256_maskload_epi32(data + i*LANES, mask), mask);
+        }
+        r[i] = sort_avx2(r[i]);
+    }
+
+    for(size_t width = 1; width < nregs; width *= 2) {
+        for(size_t base = 0; base < nregs; base += 2*width) {
+            __m256i* run = r + base;
+            for(size_t i = 0; i < width / 2; i++) {
+                const __m256i temp = run[width + i];
+                run[width + i]         = run[2*width - 1 - i];
+                run[2*width - 1 - i]   = temp;
+            }
+            for(size_t i = width; i < 2*width; i++) {
+                run[i] = reverse_avx2(run[i]);
+            }
+            for(size_t distance = width; distance > 0; distance /= 2) {
+                for(size_t i = 0; i < 2*width; i++) {
+                    if((i & distance) == 0) {
+                        const __m256i lo = _mm256_min_epi32(run[i], run[i + distance]);
+                        run[i + distance] = _mm256_max_epi32(run[i], run[i + distance]);
+                        run[i]            = lo;
+                    }
+                }
+            }
+            for(size_t i = 0; i < 2*width; i++) {
+                run[i] = merge_avx2(run[i]);
+            }
+        }
+    }
+
+    for(size_t i = 0; i < nregs; i++) {
+        if((i + 1)*LANES <= nelements) {
+            _mm256_storeu_si256((__m256i*)(data + i*LANES), r[i]);
+        }
+        else {
+            const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(nelements - i*LANES)), lanes);
+            _mm256_maskstore_epi32(data + i*LANES, mask, r[i]);
+        }
     }
-    printf("\n");
 }
 
-int main(void) {
-    // Insertion sort moving one element at a time
-    printf("Insertion sort moving one element at a time:\n");
-    int data[] = { 23, 21, 76, 16, 52, 43 };
-    print("Unsorted: ", data, NELEMENTS(data));
-    insertion_sort(data, NELEMENTS(data), compare);
-    print("Sorted:   ", data, NELEMENTS(data));
+// Sort up to 64 values with a bitonic network in AVX2 registers, unrolled for each number of registers
+__attribute__((target("avx2")))
+static void network_avx2_sized(int* data, size_t nelements) {
+    if(nelements <= 8) {
+        network_avx2(data, 1, nelements);
+    }
+    else if(nelements <= 16) {
+        network_avx2(data, 2, nelements);
+    }
+    else if(nelements <= 32) {
+        network_avx2(data, 4, nelements);
+    }
+    else {
+        network_avx2(data, 8, nelements);
+    }
+}
 
-    printf("\n");
+// Whether the CPU supports AVX2: 1 if so, 0 if not, or -1 until it has been checked
+static int avx2_supported = -1;
 
-    // Insertion sort moving elements as a block
-    printf("Insertion sort moving elements as a block:\n");
-    int data2[] = { 96, 54, 57, 4, 76, 85 };
-    print("Unsorted: ", data2, NELEMENTS(data2));
-    insertion_sort_move(data2, NELEMENTS(data2), compare);
-    print("Sorted:   ", data2, NELEMENTS(data2));
+// Check whether the CPU supports AVX2
+static bool has_avx2(void) {
+    int supported = __atomic_load_n(&avx2_supported, __ATOMIC_RELAXED);
+    if(supported < 0) {
+        supported = __builtin_cpu_supports("avx2") ? 1 : 0;
+        __atomic_store_n(&avx2_supported, supported, __ATOMIC_RELAXED);
+    }
+    return supported != 0;
+}
 
-    return EXIT_SUCCESS;
+#endif
+
+// Sort 8, 16, 32 or 64 values with a bitonic sorting network
+bool sort_network(int* data, size_t nelements) {
+    if((data == NULL) ||
+       ((nelements != 8) && (nelements != 16) && (nelements != 32) && (nelements != 64))) {
+        return false;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    if(has_avx2()) {
+        network_avx2_sized(data, nelements);
+        return true;
+    }
+#endif
+    network_scalar(data, nelements);
+    return true;
+}
+
+// Sort a small array of values with a sorting network or branchless insertion sort
+//
+// One compare-exchange at a time, the network is slower than branchless insertion sort, so that is used without AVX2.
+void small_sort(int* data, size_t nelements) {
+    if((data == NULL) || (nelements < 2)) {
+        return;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    if((nelements <= SMALL_SORT_MAX) && has_avx2()) {
+        network_avx2_sized(data, nelements);
+        return;
+    }
+#endif
+    insertion_sort_branchless(data, nelements);
 }
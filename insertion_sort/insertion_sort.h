@@ -0,0 +1,69 @@
+// Sort an array of values using insertion sort
+//
+// This has an average case performance of O(n^2)
+//
+// Small arrays are the base case of every larger sort, so there are also sorts for them that do not branch on the
+// values, and so do not mispredict on random data:
+//  - The branchless insertion sort shifts each value into place with conditional moves, always scanning the whole
+//    sorted prefix rather than stopping at the insertion point.
+//  - The sorting networks are bitonic sorts of 8, 16, 32 or 64 values. With AVX2 the values are held in registers of 8,
+//    each register is sorted by shuffles and min/max, and the registers are merged by min/max between them. Otherwise
+//    the same network is run one compare-exchange at a time.
+//  - small_sort sorts any number of values up to 64 with the AVX2 network, padding the last register with INT_MAX.
+//    Without AVX2 it uses the branchless insertion sort, which is faster than the network run one compare-exchange at
+//    a time.
+//
+// See https://en.wikipedia.org/wiki/Insertion_sort
+// See https://en.wikipedia.org/wiki/Bitonic_sorter
+// See Bramas, "A Novel Hybrid Quicksort Algorithm Vectorized using AVX-512 on Intel Skylake"
+
+#ifndef INSERTION_SORT_H
+#define INSERTION_SORT_H
+
+#include <stdbool.h>    // For bool
+#include <stddef.h>     // For size_t
+
+// Largest number of values sorted by small_sort with a sorting network rather than insertion sort
+#define SMALL_SORT_MAX  64
+
+// Insertion sort moving one element at a time.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+//  compare   : comparison function, returning < 0, 0 or > 0 as a is less than, equal to or greater than b.
+void insertion_sort(int* data, size_t nelements, int (*compare)(int a, int b));
+
+// Insertion sort moving elements as a block.
+//
+// Parameters: as for insertion_sort.
+void insertion_sort_move(int* data, size_t nelements, int (*compare)(int a, int b));
+
+// Insertion sort in ascending order without branching on the values.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+void insertion_sort_branchless(int* data, size_t nelements);
+
+// Sort 8, 16, 32 or 64 values in ascending order with a bitonic sorting network, using AVX2 if the CPU supports it.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+//
+// Returns:
+//  true      : the values were sorted.
+//  false     : there is no network for that number of values, and they were not changed.
+bool sort_network(int* data, size_t nelements);
+
+// Sort a small array of values in ascending order, with a sorting network if the CPU supports AVX2 or otherwise
+// branchless insertion sort.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array, which should be at most SMALL_SORT_MAX. Larger arrays are sorted with
+//              branchless insertion sort, which is O(n^2).
+void small_sort(int* data, size_t nelements);
+
+#endif // INSERTION_SORT_H
@@ -0,0 +1,189 @@
+// Sort an array of values using insertion sort
+//
+// This has an average case performance of O(n^2)
+//
+// The small-array sorts are benchmarked against insertion sort on arrays of up to 64 values with:
+//
+//  ./insertion_sort benchmark [number of values]
+//
+// See https://en.wikipedia.org/wiki/Insertion_sort
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include <errno.h>          // For errno
+#include <stdbool.h>        // For bool, true, false
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For EXIT_SUCCESS, EXIT_FAILURE, malloc, free, qsort, rand, strtoul
+#include <string.h>         // For memcmp, memcpy, strcmp, strerror
+#include <time.h>           // For clock_gettime
+#include "insertion_sort.h" // For insertion_sort, insertion_sort_move, insertion_sort_branchless, sort_network,
+                            //     small_sort
+
+#define NELEMENTS(a)    (sizeof(a) / sizeof(a[0]))
+
+// Comparison function used when sorting, which unlike a - b cannot overflow
+int compare(int a, int b) {
+    return (a > b) - (a < b);
+}
+
+// Print an array of values
+void print(const char* msg, const int *data, size_t nelements) {
+    if((data == NULL) || (nelements == 0)) {
+        printf("Bad arguments\n");
+        return;
+    }
+
+    printf("%s", msg);
+    for(size_t i = 0; i < nelements; i++) {
+        printf("%2d ", data[i]);
+    }
+    printf("\n");
+}
+
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Comparison function for qsort
+int compare_qsort(const void* a, const void* b) {
+    const int x = *(const int*)a;
+    const int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Benchmark the sorts on consecutive small arrays of random values, reporting millions of values sorted per second
+int benchmark(size_t nvalues) {
+    static const size_t sizes[] = { 4, 8, 12, 16, 24, 32, 48, 64 };
+
+    int* data     = malloc(nvalues * sizeof(int));
+    int* original = malloc(nvalues * sizeof(int));
+    if((data == NULL) || (original == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(data); free(original);
+        return EXIT_FAILURE;
+    }
+    for(size_t i = 0; i < nvalues; i++) {
+        original[i] = rand() - RAND_MAX / 2;
+    }
+
+    printf("%zu values, millions sorted per second\n", nvalues);
+    printf("%-6s %12s %12s %12s\n", "size", "insertion", "branchless", "small_sort");
+    for(size_t s = 0; s < NELEMENTS(sizes); s++) {
+        const size_t size   = sizes[s];
+        const size_t narray = nvalues / size;
+        printf("%-6zu ", size);
+
+        memcpy(data, original, nvalues * sizeof(int));
+        double start = now();
+        for(size_t i = 0; i < narray; i++) {
+            insertion_sort(data + i*size, size, compare);
+        }
+        printf("%12.2f ", narray * size / (now() - start) / 1e6);
+
+        memcpy(data, original, nvalues * sizeof(int));
+        start = now();
+        for(size_t i = 0; i < narray; i++) {
+            insertion_sort_branchless(data + i*size, size);
+        }
+        printf("%12.2f ", narray * size / (now() - start) / 1e6);
+
+        memcpy(data, original, nvalues * sizeof(int));
+        start = now();
+        for(size_t i = 0; i < narray; i++) {
+            small_sort(data + i*size, size);
+        }
+        printf("%12.2f\n", narray * size / (now() - start) / 1e6);
+        fflush(stdout);
+    }
+
+    free(data); free(original);
+    return EXIT_SUCCESS;
+}
+
+// Verify the small-array sorts against qsort on random values of every size up to beyond SMALL_SORT_MAX, and the
+// sorting networks of 8 and 16 values on every input of zeros and ones, which by the 0-1 principle is enough
+bool verify(void) {
+    int data[SMALL_SORT_MAX + 8];
+    int data2[SMALL_SORT_MAX + 8];
+    int expected[SMALL_SORT_MAX + 8];
+
+    for(size_t n = 0; n <= SMALL_SORT_MAX + 8; n++) {
+        for(int repeat = 0; repeat < 100; repeat++) {
+            for(size_t i = 0; i < n; i++) {
+                data[i] = (repeat % 2 == 0) ? rand() - RAND_MAX / 2 : rand() % 8;
+            }
+            memcpy(data2, data, n * sizeof(int));
+            memcpy(expected, data, n * sizeof(int));
+            qsort(expected, n, sizeof(int), compare_qsort);
+            small_sort(data, n);
+            insertion_sort_branchless(data2, n);
+            if((memcmp(data, expected, n * sizeof(int)) != 0) || (memcmp(data2, expected, n * sizeof(int)) != 0)) {
+                printf("Mismatch for %zu values\n", n);
+                return false;
+            }
+        }
+    }
+
+    for(size_t n = 8; n <= 16; n += 8) {
+        for(unsigned bits = 0; bits < (1u << n); bits++) {
+            int ones = 0;
+            for(size_t i = 0; i < n; i++) {
+                data[i] = (bits >> i) & 1;
+                ones   += data[i];
+            }
+            if(!sort_network(data, n)) {
+                printf("No network for %zu values\n", n);
+                return false;
+            }
+            for(size_t i = 0; i < n; i++) {
+                if(data[i] != (i >= n - (size_t)ones)) {
+                    printf("Network of %zu values failed for 0x%x\n", n, bits);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    // Benchmark the sorts rather than demonstrating them?
+    if((argc > 1) && (strcmp(argv[1], "benchmark") == 0)) {
+        size_t nvalues = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10000000;
+        return (nvalues > 0) ? benchmark(nvalues) : EXIT_FAILURE;
+    }
+
+    // Insertion sort moving one element at a time
+    printf("Insertion sort moving one element at a time:\n");
+    int data[] = { 23, 21, 76, 16, 52, 43 };
+    print("Unsorted: ", data, NELEMENTS(data));
+    insertion_sort(data, NELEMENTS(data), compare);
+    print("Sorted:   ", data, NELEMENTS(data));
+
+    printf("\n");
+
+    // Insertion sort moving elements as a block
+    printf("Insertion sort moving elements as a block:\n");
+    int data2[] = { 96, 54, 57, 4, 76, 85 };
+    print("Unsorted: ", data2, NELEMENTS(data2));
+    insertion_sort_move(data2, NELEMENTS(data2), compare);
+    print("Sorted:   ", data2, NELEMENTS(data2));
+
+    printf("\n");
+
+    // Small sort, with a sorting network padded to 8 values
+    printf("Small sort:\n");
+    int data3[] = { 23, 21, 76, 16, 52, 43 };
+    print("Unsorted: ", data3, NELEMENTS(data3));
+    small_sort(data3, NELEMENTS(data3));
+    print("Sorted:   ", data3, NELEMENTS(data3));
+
+    // Verify the small-array sorts against qsort
+    const bool ok = verify();
+    printf("\nVerify against qsort: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,268 @@
+// General matrix multiply (GEMM) i.e. C += A * B, for int, float and double elements.
+//
+// All matrices are stored in row-major order. A is m x k, B is k x n and C is m x n. Each has a leading dimension,
+// the distance in elements between the starts of consecutive rows, so that sub-matrices can be multiplied in place.
+//
+// Rather than walking down the columns of B, which misses the cache on every access for large matrices, the
+// multiplication is blocked for the caches in the style of Goto and BLIS:
+//  1. B is cut into KC x NC blocks which are packed into contiguous panels NR columns wide (sized for the L3/L2).
+//  2. A is cut into MC x KC blocks which are packed into contiguous panels MR rows high (sized for the L2).
+//  3. A register-tiled micro-kernel multiplies one MR-row panel of A by one NR-column panel of B, accumulating an
+//     MR x NR tile of C in registers (sized for the L1).
+//
+// There are micro-kernels using AVX2 (with FMA) and AVX-512 as well as a portable one. The best that the CPU supports
+// is chosen at run-time, so the same binary runs on any x86-64 host (or any other architecture).
+//
+// The engine is written once in gemm_template.h and included here for each element type.
+//
+// The parallel versions split C into macro-tiles and schedule them over a pool of worker threads. Each worker starts
+// with an equal, contiguous range of tiles and, once it runs out, steals half of the remaining range of another worker.
+// Each worker packs into its own buffers, and C may be left uninitialised so that each tile is first touched (and so
+// placed on the NUMA node of) the worker that computes it.
+//
+// The Strassen-Winograd versions multiply large square matrices with 7 half-size products per level instead of 8,
+// recursing down to a cutoff below which the blocked multiplication is faster. The temporaries for every level come
+// from one arena allocated up front.
+//
+// See Goto and van de Geijn, "Anatomy of High-Performance Matrix Multiplication"
+// See https://github.com/flame/blis/blob/master/docs/KernelsHowTo.md
+
+#define _POSIX_C_SOURCE 200809L // For posix_memalign, sysconf
+
+#include <assert.h>           // For assert
+#include <errno.h>            // For errno
+#include <pthread.h>          // For pthread_create, pthread_join
+#include <stdint.h>           // For uint8_t, uint32_t, uint64_t
+#include <stdio.h>            // For printf
+#include <stdlib.h>           // For malloc, posix_memalign, free
+#include <string.h>           // For memset, strerror
+#include <unistd.h>           // For sysconf
+#include "gemm.h"             // This module
+#include "gemm_kernels.h"     // For the SIMD micro-kernels
+#include "matrix_transpose.h" // For transpose_32
+
+// Blocking parameters, in elements. MC is a multiple of every MR and NC of every NR.
+#define MC  96      // rows of A per packed block, which should fit in the L2 cache
+#define KC  256     // columns of A and rows of B per packed block
+#define NC  4096    // columns of B per packed block, which should fit in the L3 cache
+
+// Columns of C per macro-tile scheduled onto a worker thread, a multiple of every NR. Each macro-tile is MC rows high.
+#define TILE_NC     512
+
+// Size of a cache line, in bytes. Ranges updated by different threads are kept this far apart to avoid false sharing.
+#define CACHE_LINE  64
+
+// Dimensions of the tile accumulated by the portable micro-kernel
+#define SCALAR_MR   4
+#define SCALAR_NR   8
+
+// Largest dimensions of a tile accumulated by any micro-kernel
+#define MAX_MR      SIMD_MR
+#define MAX_NR      AVX512_NR_FLOAT
+
+// Round up to a multiple
+#define ROUND_UP(x, multiple)   ((((x) + (multiple) - 1) / (multiple)) * (multiple))
+
+// A bump allocator, released all at once (or back to a mark) rather than element by element
+//
+// Fields:
+//  base     : memory allocated on the heap.
+//  capacity : size of the memory, in bytes.
+//  used     : number of bytes handed out, each allocation starting on a cache line.
+typedef struct arena_t {
+    uint8_t * base;
+    size_t    capacity;
+    size_t    used;
+} arena_t;
+
+// Create an arena of the given size
+static bool arena_create(arena_t * arena, size_t capacity) {
+    void * base = NULL;
+    int    error = posix_memalign(&base, CACHE_LINE, ROUND_UP(capacity, CACHE_LINE));
+    arena->base     = base;
+    arena->capacity = capacity;
+    arena->used     = 0;
+    if(error != 0) {
+        printf("posix_memalign failed: %s", strerror(error));
+        return false;
+    }
+    return true;
+}
+
+// Destroy an arena, freeing everything allocated from it
+static void arena_destroy(arena_t * arena) {
+    free(arena->base);
+    arena->base = NULL;
+}
+
+// Allocate from an arena, which must have been sized to hold everything allocated from it
+static void * arena_alloc(arena_t * arena, size_t bytes) {
+    void * p = arena->base + arena->used;
+    arena->used += ROUND_UP(bytes, CACHE_LINE);
+    assert(arena->used <= arena->capacity);
+    return p;
+}
+
+// Get the size of the arena needed for the temporaries of Strassen-Winograd on n x n matrices, in bytes
+static size_t strassen_workspace(size_t n, size_t cutoff, size_t element_size) {
+    size_t bytes = 0;
+    while(n > cutoff) {
+        n /= 2;
+        bytes += 2 * ROUND_UP(n * n * element_size, CACHE_LINE);
+    }
+    return bytes;
+}
+
+// A worker's range of macro-tiles [begin, end), packed into one word so that it can be updated with a single CAS.
+//
+// The worker takes tiles from the front of its own range, and thieves steal half of what remains from the back.
+typedef struct deque_t {
+    uint64_t range;
+    uint8_t  pad[CACHE_LINE - sizeof(uint64_t)];
+} deque_t;
+
+#define RANGE(begin, end)   (((uint64_t)(end) << 32) | (uint32_t)(begin))
+#define RANGE_BEGIN(range)  ((uint32_t)(range))
+#define RANGE_END(range)    ((uint32_t)((range) >> 32))
+
+// Take the next macro-tile from the front of a worker's own range
+static bool deque_pop(deque_t * deque, uint32_t * tile) {
+    uint64_t range = __atomic_load_n(&deque->range, __ATOMIC_ACQUIRE);
+    while(RANGE_BEGIN(range) < RANGE_END(range)) {
+        if(__atomic_compare_exchange_n(&deque->range, &range, RANGE(RANGE_BEGIN(range) + 1, RANGE_END(range)),
+                                       false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            *tile = RANGE_BEGIN(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Steal half of the remaining macro-tiles from the back of another worker's range, visiting the others in turn
+//
+// The first stolen tile is returned and the rest become the thief's own range, which must be empty.
+static bool deque_steal(deque_t * deques, size_t nworkers, size_t self, uint32_t * tile) {
+    for(size_t i = 1; i < nworkers; i++) {
+        deque_t * victim = &deques[(self + i) % nworkers];
+        uint64_t  range  = __atomic_load_n(&victim->range, __ATOMIC_ACQUIRE);
+        while(RANGE_BEGIN(range) < RANGE_END(range)) {
+            const uint32_t end = RANGE_END(range);
+            const uint32_t mid = end - (end - RANGE_BEGIN(range) + 1) / 2;
+            if(__atomic_compare_exchange_n(&victim->range, &range, RANGE(RANGE_BEGIN(range), mid), false,
+                                           __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                *tile = mid;
+                __atomic_store_n(&deques[self].range, RANGE(mid + 1, end), __ATOMIC_RELEASE);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Get the number of worker threads to use
+static size_t count_workers(size_t nthreads, size_t ntiles) {
+    if(nthreads == 0) {
+        long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = (ncpus > 0) ? (size_t)ncpus : 1;
+    }
+    return (nthreads < ntiles) ? nthreads : ntiles;
+}
+
+// Instruction set in use, or GEMM_ISA_COUNT until the best that the CPU supports has been found
+static gemm_isa_t isa_in_use = GEMM_ISA_COUNT;
+
+// Find the best instruction set supported by the CPU
+gemm_isa_t gemm_isa_best(void) {
+    if(gemm_isa_supported(GEMM_ISA_AVX512)) {
+        return GEMM_ISA_AVX512;
+    }
+    else if(gemm_isa_supported(GEMM_ISA_AVX2)) {
+        return GEMM_ISA_AVX2;
+    }
+    else {
+        return GEMM_ISA_SCALAR;
+    }
+}
+
+// Check whether the CPU supports an instruction set
+bool gemm_isa_supported(gemm_isa_t isa) {
+    switch(isa) {
+        case GEMM_ISA_SCALAR:
+            return true;
+#if defined(__x86_64__) || defined(__i386__)
+        case GEMM_ISA_AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case GEMM_ISA_AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+// Get the name of an instruction set
+const char * gemm_isa_name(gemm_isa_t isa) {
+    static const char * names[GEMM_ISA_COUNT] = { "scalar", "avx2", "avx512" };
+    return (isa < GEMM_ISA_COUNT) ? names[isa] : "unknown";
+}
+
+// Get the instruction set whose micro-kernels are used
+gemm_isa_t gemm_get_isa(void) {
+    gemm_isa_t isa = __atomic_load_n(&isa_in_use, __ATOMIC_RELAXED);
+    if(isa == GEMM_ISA_COUNT) {
+        isa = gemm_isa_best();
+        __atomic_store_n(&isa_in_use, isa, __ATOMIC_RELAXED);
+    }
+    return isa;
+}
+
+// Set the instruction set whose micro-kernels are used
+bool gemm_set_isa(gemm_isa_t isa) {
+    if(!gemm_isa_supported(isa)) {
+        return false;
+    }
+    __atomic_store_n(&isa_in_use, isa, __ATOMIC_RELAXED);
+    return true;
+}
+
+#define GEMM_T          int
+#define GEMM_NAME       int
+#define GEMM_NAME_UPPER INT
+#define GEMM_ADD(x, y)  ((int)((unsigned)(x) + (unsigned)(y)))
+#define GEMM_SUB(x, y)  ((int)((unsigned)(x) - (unsigned)(y)))
+#define GEMM_MUL(x, y)  ((int)((unsigned)(x) * (unsigned)(y)))
+#include "gemm_template.h"
+#undef GEMM_T
+#undef GEMM_NAME
+#undef GEMM_NAME_UPPER
+#undef GEMM_ADD
+#undef GEMM_SUB
+#undef GEMM_MUL
+
+#define GEMM_T          float
+#define GEMM_NAME       float
+#define GEMM_NAME_UPPER FLOAT
+#define GEMM_ADD(x, y)  ((x) + (y))
+#define GEMM_SUB(x, y)  ((x) - (y))
+#define GEMM_MUL(x, y)  ((x) * (y))
+#include "gemm_template.h"
+#undef GEMM_T
+#undef GEMM_NAME
+#undef GEMM_NAME_UPPER
+#undef GEMM_ADD
+#undef GEMM_SUB
+#undef GEMM_MUL
+
+#define GEMM_T          double
+#define GEMM_NAME       double
+#define GEMM_NAME_UPPER DOUBLE
+#define GEMM_ADD(x, y)  ((x) + (y))
+#define GEMM_SUB(x, y)  ((x) - (y))
+#define GEMM_MUL(x, y)  ((x) * (y))
+#include "gemm_template.h"
+#undef GEMM_T
+#undef GEMM_NAME
+#undef GEMM_NAME_UPPER
+#undef GEMM_ADD
+#undef GEMM_SUB
+#undef GEMM_MUL
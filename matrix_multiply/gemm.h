@@ -0,0 +1,174 @@
+// General matrix multiply (GEMM) i.e. C += A * B, for int, float and double elements.
+//
+// All matrices are stored in row-major order. A is m x k, B is k x n and C is m x n. Each has a leading dimension,
+// the distance in elements between the starts of consecutive rows, so that sub-matrices can be multiplied in place.
+//
+// Rather than walking down the columns of B, which misses the cache on every access for large matrices, the
+// multiplication is blocked for the caches in the style of Goto and BLIS:
+//  1. B is cut into KC x NC blocks which are packed into contiguous panels NR columns wide (sized for the L3/L2).
+//  2. A is cut into MC x KC blocks which are packed into contiguous panels MR rows high (sized for the L2).
+//  3. A register-tiled micro-kernel multiplies one MR-row panel of A by one NR-column panel of B, accumulating an
+//     MR x NR tile of C in registers (sized for the L1).
+//
+// There are micro-kernels using AVX2 (with FMA) and AVX-512 as well as a portable one. The best that the CPU supports
+// is chosen at run-time, so the same binary runs on any x86-64 host (or any other architecture).
+//
+// The parallel versions split C into macro-tiles and schedule them over a pool of worker threads. Each worker starts
+// with an equal, contiguous range of tiles and, once it runs out, steals half of the remaining range of another worker.
+// Each worker packs into its own buffers, and C may be left uninitialised so that each tile is first touched (and so
+// placed on the NUMA node of) the worker that computes it.
+//
+// The Strassen-Winograd versions multiply large square matrices with 7 half-size products per level instead of 8,
+// recursing down to a cutoff below which the blocked multiplication is faster. This does O(n^2.81) rather than O(n^3)
+// work, at the cost of some accuracy for floating point elements: the error bound grows with n^0.58 * |A| * |B| rather
+// than n * |A| * |B|, and is normwise rather than elementwise. Integer elements wrap around so the result is exact.
+//
+// See Goto and van de Geijn, "Anatomy of High-Performance Matrix Multiplication"
+// See https://github.com/flame/blis/blob/master/docs/KernelsHowTo.md
+
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <stdbool.h>    // For bool
+#include <stddef.h>     // For size_t
+
+// Default size of matrix at or below which Strassen-Winograd uses the blocked multiplication
+#define GEMM_STRASSEN_CUTOFF    512
+
+// Instruction sets for which there are micro-kernels.
+typedef enum gemm_isa_tag {
+    GEMM_ISA_SCALAR,    // portable C, vectorised as far as the compiler can manage
+    GEMM_ISA_AVX2,      // AVX2 and FMA
+    GEMM_ISA_AVX512,    // AVX-512 Foundation
+    GEMM_ISA_COUNT
+} gemm_isa_t;
+
+// Find the best instruction set supported by the CPU.
+//
+// Returns:
+//  the best instruction set supported.
+gemm_isa_t gemm_isa_best(void);
+
+// Check whether the CPU supports an instruction set.
+//
+// Parameters:
+//  isa     : instruction set.
+//
+// Returns:
+//  true    : the instruction set is supported.
+//  false   : the instruction set is not supported.
+bool gemm_isa_supported(gemm_isa_t isa);
+
+// Get the name of an instruction set.
+//
+// Parameters:
+//  isa     : instruction set.
+//
+// Returns:
+//  the name e.g. "avx2".
+const char * gemm_isa_name(gemm_isa_t isa);
+
+// Get the instruction set whose micro-kernels are used, by default the best that the CPU supports.
+//
+// Returns:
+//  the instruction set in use.
+gemm_isa_t gemm_get_isa(void);
+
+// Set the instruction set whose micro-kernels are used e.g. to compare against the portable micro-kernels.
+//
+// Parameters:
+//  isa     : instruction set.
+//
+// Returns:
+//  true    : the instruction set will be used.
+//  false   : the instruction set is not supported, the one in use is unchanged.
+bool gemm_set_isa(gemm_isa_t isa);
+
+// Multiply int matrices i.e. C += A * B.
+//
+// Parameters:
+//  m   : number of rows in A and C.
+//  n   : number of columns in B and C.
+//  k   : number of columns in A and rows in B.
+//  a   : pointer to the first element of A.
+//  lda : leading dimension of A, at least k.
+//  b   : pointer to the first element of B.
+//  ldb : leading dimension of B, at least n.
+//  c   : pointer to the first element of C, accumulated into.
+//  ldc : leading dimension of C, at least n.
+//
+// Returns:
+//  true  : C was accumulated into.
+//  false : C was not changed i.e. memory for the packed panels could not be allocated.
+bool gemm_int(size_t m, size_t n, size_t k, const int * a, size_t lda, const int * b, size_t ldb, int * c,
+              size_t ldc);
+
+// Multiply float matrices i.e. C += A * B.
+//
+// Parameters and return value: as for gemm_int.
+bool gemm_float(size_t m, size_t n, size_t k, const float * a, size_t lda, const float * b, size_t ldb, float * c,
+                size_t ldc);
+
+// Multiply double matrices i.e. C += A * B.
+//
+// Parameters and return value: as for gemm_int.
+bool gemm_double(size_t m, size_t n, size_t k, const double * a, size_t lda, const double * b, size_t ldb,
+                 double * c, size_t ldc);
+
+// Multiply int matrices i.e. C += A * B, or C = A * B, using a pool of threads.
+//
+// Parameters:
+//  nthreads : number of threads to use, including the calling thread, or 0 for the number of online CPUs.
+//  zero     : true if C is uninitialised and should be overwritten i.e. C = A * B. Each macro-tile is then zeroed by
+//             the thread that computes it, so for newly allocated memory the pages are first touched on its NUMA node.
+//  others   : as for gemm_int.
+//
+// Returns:
+//  true     : C was accumulated into or overwritten.
+//  false    : memory could not be allocated, C may be partly accumulated into or overwritten.
+bool gemm_int_parallel(size_t nthreads, bool zero, size_t m, size_t n, size_t k, const int * a, size_t lda,
+                       const int * b, size_t ldb, int * c, size_t ldc);
+
+// Multiply float matrices i.e. C += A * B, or C = A * B, using a pool of threads.
+//
+// Parameters and return value: as for gemm_int_parallel.
+bool gemm_float_parallel(size_t nthreads, bool zero, size_t m, size_t n, size_t k, const float * a, size_t lda,
+                         const float * b, size_t ldb, float * c, size_t ldc);
+
+// Multiply double matrices i.e. C += A * B, or C = A * B, using a pool of threads.
+//
+// Parameters and return value: as for gemm_int_parallel.
+bool gemm_double_parallel(size_t nthreads, bool zero, size_t m, size_t n, size_t k, const double * a, size_t lda,
+                          const double * b, size_t ldb, double * c, size_t ldc);
+
+// Multiply square int matrices with Strassen-Winograd i.e. C = A * B.
+//
+// Parameters:
+//  cutoff : size of matrix at or below which the blocked multiplication is used, or 0 for GEMM_STRASSEN_CUTOFF.
+//  n      : number of rows and columns in A, B and C.
+//  a      : pointer to the first element of A.
+//  lda    : leading dimension of A, at least n.
+//  b      : pointer to the first element of B.
+//  ldb    : leading dimension of B, at least n.
+//  c      : pointer to the first element of C, overwritten. It must not overlap A or B.
+//  ldc    : leading dimension of C, at least n.
+//
+// Returns:
+//  true   : C was overwritten.
+//  false  : C was not changed i.e. memory for the temporaries could not be allocated.
+bool gemm_int_strassen(size_t cutoff, size_t n, const int * a, size_t lda, const int * b, size_t ldb, int * c,
+                       size_t ldc);
+
+// Multiply square float matrices with Strassen-Winograd i.e. C = A * B.
+//
+// Parameters and return value: as for gemm_int_strassen.
+bool gemm_float_strassen(size_t cutoff, size_t n, const float * a, size_t lda, const float * b, size_t ldb,
+                         float * c, size_t ldc);
+
+// Multiply square double matrices with Strassen-Winograd i.e. C = A * B.
+//
+// Parameters and return value: as for gemm_int_strassen.
+bool gemm_double_strassen(size_t cutoff, size_t n, const double * a, size_t lda, const double * b, size_t ldb,
+                          double * c, size_t ldc);
+
+#endif // GEMM_H
@@ -0,0 +1,44 @@
+// SIMD micro-kernel for the general matrix multiply (GEMM), written once for any element type and instruction set.
+//
+// This is included by gemm_kernels.c once per element type and instruction set, with these defined beforehand:
+//  KERNEL_NAME          : name of the micro-kernel e.g. gemm_kernel_avx2_float.
+//  KERNEL_T             : element type e.g. float.
+//  KERNEL_V             : vector type e.g. __m256.
+//  KERNEL_W             : number of elements in a vector e.g. 8.
+//  KERNEL_ZERO()        : a vector of zeros.
+//  KERNEL_LOAD(p)       : load a vector from an unaligned pointer.
+//  KERNEL_STORE(p, v)   : store a vector to an unaligned pointer.
+//  KERNEL_BCAST(p)      : broadcast the element at a pointer into a vector.
+//  KERNEL_MADD(a, b, c) : multiply vectors a and b, then add vector c.
+//  KERNEL_ADD(a, b)     : add vectors a and b.
+//
+// The SIMD_MR x (2 x KERNEL_W) tile is accumulated in 2 x SIMD_MR vector registers, which with the two rows of B and
+// the broadcast element of A fits within the 16 registers of AVX2.
+
+void KERNEL_NAME(size_t k, const KERNEL_T * a, const KERNEL_T * b, KERNEL_T * c, size_t ldc) {
+    KERNEL_V ab[SIMD_MR][2];
+    for(size_t i = 0; i < SIMD_MR; i++) {
+        ab[i][0] = KERNEL_ZERO();
+        ab[i][1] = KERNEL_ZERO();
+    }
+
+    // Accumulate the outer product of each column of the A panel with each row of the B panel
+    for(size_t p = 0; p < k; p++) {
+        const KERNEL_V b0 = KERNEL_LOAD(b);
+        const KERNEL_V b1 = KERNEL_LOAD(b + KERNEL_W);
+        for(size_t i = 0; i < SIMD_MR; i++) {
+            const KERNEL_V ai = KERNEL_BCAST(a + i);
+            ab[i][0] = KERNEL_MADD(ai, b0, ab[i][0]);
+            ab[i][1] = KERNEL_MADD(ai, b1, ab[i][1]);
+        }
+        a += SIMD_MR;
+        b += 2 * KERNEL_W;
+    }
+
+    // Accumulate the tile into C
+    for(size_t i = 0; i < SIMD_MR; i++) {
+        KERNEL_T * row = c + i*ldc;
+        KERNEL_STORE(row,            KERNEL_ADD(KERNEL_LOAD(row),            ab[i][0]));
+        KERNEL_STORE(row + KERNEL_W, KERNEL_ADD(KERNEL_LOAD(row + KERNEL_W), ab[i][1]));
+    }
+}
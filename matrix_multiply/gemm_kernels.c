@@ -0,0 +1,161 @@
+// Micro-kernels for the general matrix multiply (GEMM), using SIMD instructions.
+//
+// Each micro-kernel multiplies a k x SIMD_MR panel of A by a k x NR panel of B, and accumulates the product into an
+// SIMD_MR x NR tile of C with leading dimension ldc. NR is two vectors wide, so depends on the instruction set and the
+// element type.
+//
+// These are compiled for their instruction sets regardless of the flags given to the compiler, so they must only be
+// called once the CPU has been found to support them. The micro-kernel is written once in gemm_kernel_template.h and
+// included here for each element type and instruction set.
+
+#include "gemm_kernels.h"   // This module
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>      // For AVX2 and AVX-512 intrinsics
+
+// AVX2 (and FMA) micro-kernels
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+#define KERNEL_NAME             gemm_kernel_avx2_int
+#define KERNEL_T                int
+#define KERNEL_V                __m256i
+#define KERNEL_W                8
+#define KERNEL_ZERO()           _mm256_setzero_si256()
+#define KERNEL_LOAD(p)          _mm256_loadu_si256((const __m256i *)(p))
+#define KERNEL_STORE(p, v)      _mm256_storeu_si256((__m256i *)(p), (v))
+#define KERNEL_BCAST(p)         _mm256_set1_epi32(*(p))
+#define KERNEL_MADD(a, b, c)    _mm256_add_epi32(_mm256_mullo_epi32((a), (b)), (c))
+#define KERNEL_ADD(a, b)        _mm256_add_epi32((a), (b))
+#include "gemm_kernel_template.h"
+#undef KERNEL_NAME
+#undef KERNEL_T
+#undef KERNEL_V
+#undef KERNEL_W
+#undef KERNEL_ZERO
+#undef KERNEL_LOAD
+#undef KERNEL_STORE
+#undef KERNEL_BCAST
+#undef KERNEL_MADD
+#undef KERNEL_ADD
+
+#define KERNEL_NAME             gemm_kernel_avx2_float
+#define KERNEL_T                float
+#define KERNEL_V                __m256
+#define KERNEL_W                8
+#define KERNEL_ZERO()           _mm256_setzero_ps()
+#define KERNEL_LOAD(p)          _mm256_loadu_ps(p)
+#define KERNEL_STORE(p, v)      _mm256_storeu_ps((p), (v))
+#define KERNEL_BCAST(p)         _mm256_broadcast_ss(p)
+#define KERNEL_MADD(a, b, c)    _mm256_fmadd_ps((a), (b), (c))
+#define KERNEL_ADD(a, b)        _mm256_add_ps((a), (b))
+#include "gemm_kernel_template.h"
+#undef KERNEL_NAME
+#undef KERNEL_T
+#undef KERNEL_V
+#undef KERNEL_W
+#undef KERNEL_ZERO
+#undef KERNEL_LOAD
+#undef KERNEL_STORE
+#undef KERNEL_BCAST
+#undef KERNEL_MADD
+#undef KERNEL_ADD
+
+#define KERNEL_NAME             gemm_kernel_avx2_double
+#define KERNEL_T                double
+#define KERNEL_V                __m256d
+#define KERNEL_W                4
+#define KERNEL_ZERO()           _mm256_setzero_pd()
+#define KERNEL_LOAD(p)          _mm256_loadu_pd(p)
+#define KERNEL_STORE(p, v)      _mm256_storeu_pd((p), (v))
+#define KERNEL_BCAST(p)         _mm256_broadcast_sd(p)
+#define KERNEL_MADD(a, b, c)    _mm256_fmadd_pd((a), (b), (c))
+#define KERNEL_ADD(a, b)        _mm256_add_pd((a), (b))
+#include "gemm_kernel_template.h"
+#undef KERNEL_NAME
+#undef KERNEL_T
+#undef KERNEL_V
+#undef KERNEL_W
+#undef KERNEL_ZERO
+#undef KERNEL_LOAD
+#undef KERNEL_STORE
+#undef KERNEL_BCAST
+#undef KERNEL_MADD
+#undef KERNEL_ADD
+
+#pragma GCC pop_options
+
+// AVX-512 micro-kernels
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+#define KERNEL_NAME             gemm_kernel_avx512_int
+#define KERNEL_T                int
+#define KERNEL_V                __m512i
+#define KERNEL_W                16
+#define KERNEL_ZERO()           _mm512_setzero_si512()
+#define KERNEL_LOAD(p)          _mm512_loadu_si512((const void *)(p))
+#define KERNEL_STORE(p, v)      _mm512_storeu_si512((void *)(p), (v))
+#define KERNEL_BCAST(p)         _mm512_set1_epi32(*(p))
+#define KERNEL_MADD(a, b, c)    _mm512_add_epi32(_mm512_mullo_epi32((a), (b)), (c))
+#define KERNEL_ADD(a, b)        _mm512_add_epi32((a), (b))
+#include "gemm_kernel_template.h"
+#undef KERNEL_NAME
+#undef KERNEL_T
+#undef KERNEL_V
+#undef KERNEL_W
+#undef KERNEL_ZERO
+#undef KERNEL_LOAD
+#undef KERNEL_STORE
+#undef KERNEL_BCAST
+#undef KERNEL_MADD
+#undef KERNEL_ADD
+
+#define KERNEL_NAME             gemm_kernel_avx512_float
+#define KERNEL_T                float
+#define KERNEL_V                __m512
+#define KERNEL_W                16
+#define KERNEL_ZERO()           _mm512_setzero_ps()
+#define KERNEL_LOAD(p)          _mm512_loadu_ps(p)
+#define KERNEL_STORE(p, v)      _mm512_storeu_ps((p), (v))
+#define KERNEL_BCAST(p)         _mm512_set1_ps(*(p))
+#define KERNEL_MADD(a, b, c)    _mm512_fmadd_ps((a), (b), (c))
+#define KERNEL_ADD(a, b)        _mm512_add_ps((a), (b))
+#include "gemm_kernel_template.h"
+#undef KERNEL_NAME
+#undef KERNEL_T
+#undef KERNEL_V
+#undef KERNEL_W
+#undef KERNEL_ZERO
+#undef KERNEL_LOAD
+#undef KERNEL_STORE
+#undef KERNEL_BCAST
+#undef KERNEL_MADD
+#undef KERNEL_ADD
+
+#define KERNEL_NAME             gemm_kernel_avx512_double
+#define KERNEL_T                double
+#define KERNEL_V                __m512d
+#define KERNEL_W                8
+#define KERNEL_ZERO()           _mm512_setzero_pd()
+#define KERNEL_LOAD(p)          _mm512_loadu_pd(p)
+#define KERNEL_STORE(p, v)      _mm512_storeu_pd((p), (v))
+#define KERNEL_BCAST(p)         _mm512_set1_pd(*(p))
+#define KERNEL_MADD(a, b, c)    _mm512_fmadd_pd((a), (b), (c))
+#define KERNEL_ADD(a, b)        _mm512_add_pd((a), (b))
+#include "gemm_kernel_template.h"
+#undef KERNEL_NAME
+#undef KERNEL_T
+#undef KERNEL_V
+#undef KERNEL_W
+#undef KERNEL_ZERO
+#undef KERNEL_LOAD
+#undef KERNEL_STORE
+#undef KERNEL_BCAST
+#undef KERNEL_MADD
+#undef KERNEL_ADD
+
+#pragma GCC pop_options
+
+#endif
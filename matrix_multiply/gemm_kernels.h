@@ -0,0 +1,40 @@
+// Micro-kernels for the general matrix multiply (GEMM), using SIMD instructions.
+//
+// Each micro-kernel multiplies a k x SIMD_MR panel of A by a k x NR panel of B, and accumulates the product into an
+// SIMD_MR x NR tile of C with leading dimension ldc. NR is two vectors wide, so depends on the instruction set and the
+// element type.
+//
+// These are compiled for their instruction sets regardless of the flags given to the compiler, so they must only be
+// called once the CPU has been found to support them.
+
+#ifndef GEMM_KERNELS_H
+#define GEMM_KERNELS_H
+
+#include <stddef.h>     // For size_t
+
+// Rows in the tile accumulated by each SIMD micro-kernel
+#define SIMD_MR             6
+
+// Columns in the tile accumulated by each SIMD micro-kernel
+#define AVX2_NR_INT         16
+#define AVX2_NR_FLOAT       16
+#define AVX2_NR_DOUBLE      8
+#define AVX512_NR_INT       32
+#define AVX512_NR_FLOAT     32
+#define AVX512_NR_DOUBLE    16
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX2 (and FMA) micro-kernels
+void gemm_kernel_avx2_int(size_t k, const int * a, const int * b, int * c, size_t ldc);
+void gemm_kernel_avx2_float(size_t k, const float * a, const float * b, float * c, size_t ldc);
+void gemm_kernel_avx2_double(size_t k, const double * a, const double * b, double * c, size_t ldc);
+
+// AVX-512 micro-kernels
+void gemm_kernel_avx512_int(size_t k, const int * a, const int * b, int * c, size_t ldc);
+void gemm_kernel_avx512_float(size_t k, const float * a, const float * b, float * c, size_t ldc);
+void gemm_kernel_avx512_double(size_t k, const double * a, const double * b, double * c, size_t ldc);
+
+#endif
+
+#endif // GEMM_KERNELS_H
@@ -0,0 +1,452 @@
+// General matrix multiply (GEMM) i.e. C += A * B, written once for any element type.
+//
+// This is included by gemm.c once per element type, with these defined beforehand:
+//  GEMM_T          : element type e.g. float.
+//  GEMM_NAME       : name used to make the function names unique e.g. float.
+//  GEMM_NAME_UPPER : the name in upper case e.g. FLOAT, used to find the dimensions of the SIMD micro-kernels.
+//  GEMM_ADD(x, y)  : x + y, wrapping around rather than overflowing for integers.
+//  GEMM_SUB(x, y)  : x - y, wrapping around rather than overflowing for integers.
+//  GEMM_MUL(x, y)  : x * y, wrapping around rather than overflowing for integers.
+//
+// A micro-kernel multiplies a k x MR panel of A (column i of the panel holding row i of the tile) by a k x NR panel of
+// B, and accumulates the product into an MR x NR tile of C with leading dimension ldc.
+
+// Paste together the names of the functions for this element type
+#define GEMM_CAT2(a, b) a ## _ ## b
+#define GEMM_CAT(a, b)  GEMM_CAT2(a, b)
+#define GEMM_FN(name)   GEMM_CAT(name, GEMM_NAME)
+
+// A micro-kernel for this element type, with the dimensions of the tile that it accumulates
+typedef struct GEMM_FN(kernel_t) {
+    size_t mr;
+    size_t nr;
+    void (*run)(size_t k, const GEMM_T * a, const GEMM_T * b, GEMM_T * c, size_t ldc);
+} GEMM_FN(kernel_t);
+
+// Portable micro-kernel, accumulating the tile in a local array that the compiler can keep in registers
+static void GEMM_FN(kernel_scalar)(size_t k, const GEMM_T * a, const GEMM_T * b, GEMM_T * c, size_t ldc) {
+    GEMM_T ab[SCALAR_MR][SCALAR_NR] = { { 0 } };
+
+    // Accumulate the outer product of each column of the A panel with each row of the B panel
+    for(size_t p = 0; p < k; p++) {
+        for(size_t i = 0; i < SCALAR_MR; i++) {
+            const GEMM_T ai = a[p*SCALAR_MR + i];
+            for(size_t j = 0; j < SCALAR_NR; j++) {
+                ab[i][j] = GEMM_ADD(ab[i][j], GEMM_MUL(ai, b[p*SCALAR_NR + j]));
+            }
+        }
+    }
+
+    // Accumulate the tile into C
+    for(size_t i = 0; i < SCALAR_MR; i++) {
+        for(size_t j = 0; j < SCALAR_NR; j++) {
+            c[i*ldc + j] = GEMM_ADD(c[i*ldc + j], ab[i][j]);
+        }
+    }
+}
+
+// Pack an mc x kc block of A into panels of mr rows, each stored column by column and padded with zeros
+static void GEMM_FN(pack_a)(size_t mc, size_t kc, const GEMM_T * a, size_t lda, size_t mr, GEMM_T * packed) {
+    for(size_t ir = 0; ir < mc; ir += mr) {
+        const size_t rows = (mc - ir < mr) ? mc - ir : mr;
+        if(sizeof(GEMM_T) == 4) {
+            // The panel is the transpose of the rows of A, so 32-bit elements can be transposed in SIMD registers
+            transpose_32(a + ir*lda, rows, kc, lda, packed, mr);
+        }
+        else {
+            for(size_t i = 0; i < rows; i++) {
+                const GEMM_T * row = a + (ir + i)*lda;
+                for(size_t p = 0; p < kc; p++) {
+                    packed[p*mr + i] = row[p];
+                }
+            }
+        }
+        for(size_t i = rows; i < mr; i++) {
+            for(size_t p = 0; p < kc; p++) {
+                packed[p*mr + i] = 0;
+            }
+        }
+        packed += mr * kc;
+    }
+}
+
+// Pack a kc x nc block of B into panels of nr columns, each stored row by row and padded with zeros
+static void GEMM_FN(pack_b)(size_t kc, size_t nc, const GEMM_T * b, size_t ldb, size_t nr, GEMM_T * packed) {
+    for(size_t jr = 0; jr < nc; jr += nr) {
+        const size_t cols = (nc - jr < nr) ? nc - jr : nr;
+        for(size_t p = 0; p < kc; p++) {
+            const GEMM_T * row = b + p*ldb + jr;
+            for(size_t j = 0; j < cols; j++) {
+                packed[j] = row[j];
+            }
+            for(size_t j = cols; j < nr; j++) {
+                packed[j] = 0;
+            }
+            packed += nr;
+        }
+    }
+}
+
+// Multiply a packed mc x kc block of A by a packed kc x nc block of B, accumulating into C one tile at a time
+static void GEMM_FN(macro_kernel)(const GEMM_FN(kernel_t) * kernel, size_t mc, size_t nc, size_t kc,
+                                  const GEMM_T * packed_a, const GEMM_T * packed_b, GEMM_T * c, size_t ldc) {
+    const size_t mr = kernel->mr;
+    const size_t nr = kernel->nr;
+
+    for(size_t jr = 0; jr < nc; jr += nr) {
+        const size_t cols = (nc - jr < nr) ? nc - jr : nr;
+        for(size_t ir = 0; ir < mc; ir += mr) {
+            const size_t rows = (mc - ir < mr) ? mc - ir : mr;
+            const GEMM_T * a = packed_a + ir*kc;
+            const GEMM_T * b = packed_b + jr*kc;
+
+            // Full tiles are accumulated straight into C
+            if((rows == mr) && (cols == nr)) {
+                kernel->run(kc, a, b, c + ir*ldc + jr, ldc);
+            }
+            // Partial tiles at the edges are accumulated into a scratch tile, then the valid part is copied out
+            else {
+                GEMM_T tile[MAX_MR * MAX_NR] = { 0 };
+                kernel->run(kc, a, b, tile, nr);
+                for(size_t i = 0; i < rows; i++) {
+                    for(size_t j = 0; j < cols; j++) {
+                        c[(ir + i)*ldc + jr + j] = GEMM_ADD(c[(ir + i)*ldc + jr + j], tile[i*nr + j]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Multiply matrices i.e. C += A * B, using the given micro-kernel and packing buffers
+static void GEMM_FN(gemm_packed)(const GEMM_FN(kernel_t) * kernel, size_t m, size_t n, size_t k, const GEMM_T * a,
+                                 size_t lda, const GEMM_T * b, size_t ldb, GEMM_T * c, size_t ldc, GEMM_T * packed_a,
+                                 GEMM_T * packed_b) {
+    // Each block of B is packed once and reused for every block of A
+    for(size_t jc = 0; jc < n; jc += NC) {
+        const size_t ncur = (n - jc < NC) ? n - jc : NC;
+        for(size_t pc = 0; pc < k; pc += KC) {
+            const size_t kcur = (k - pc < KC) ? k - pc : KC;
+            GEMM_FN(pack_b)(kcur, ncur, b + pc*ldb + jc, ldb, kernel->nr, packed_b);
+            for(size_t ic = 0; ic < m; ic += MC) {
+                const size_t mcur = (m - ic < MC) ? m - ic : MC;
+                GEMM_FN(pack_a)(mcur, kcur, a + ic*lda + pc, lda, kernel->mr, packed_a);
+                GEMM_FN(macro_kernel)(kernel, mcur, ncur, kcur, packed_a, packed_b, c + ic*ldc + jc, ldc);
+            }
+        }
+    }
+}
+
+// Multiply matrices i.e. C += A * B, using the given micro-kernel
+static bool GEMM_FN(gemm_with)(const GEMM_FN(kernel_t) * kernel, size_t m, size_t n, size_t k, const GEMM_T * a,
+                               size_t lda, const GEMM_T * b, size_t ldb, GEMM_T * c, size_t ldc) {
+    if((m == 0) || (n == 0) || (k == 0)) {
+        return true;
+    }
+
+    // Allocate the packed blocks, no larger than the matrices need
+    const size_t mc = (m < MC) ? m : MC;
+    const size_t nc = (n < NC) ? n : NC;
+    const size_t kc = (k < KC) ? k : KC;
+    GEMM_T * packed_a = malloc(ROUND_UP(mc, kernel->mr) * kc * sizeof(GEMM_T));
+    GEMM_T * packed_b = malloc(ROUND_UP(nc, kernel->nr) * kc * sizeof(GEMM_T));
+    if((packed_a == NULL) || (packed_b == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(packed_a);
+        free(packed_b);
+        return false;
+    }
+
+    GEMM_FN(gemm_packed)(kernel, m, n, k, a, lda, b, ldb, c, ldc, packed_a, packed_b);
+
+    free(packed_a);
+    free(packed_b);
+    return true;
+}
+
+// Micro-kernels for each instruction set, indexed by gemm_isa_t
+static const GEMM_FN(kernel_t) GEMM_FN(kernels)[GEMM_ISA_COUNT] = {
+    { SCALAR_MR, SCALAR_NR, GEMM_FN(kernel_scalar) },
+#if defined(__x86_64__) || defined(__i386__)
+    { SIMD_MR, GEMM_CAT(AVX2_NR, GEMM_NAME_UPPER), GEMM_CAT(gemm_kernel_avx2, GEMM_NAME) },
+    { SIMD_MR, GEMM_CAT(AVX512_NR, GEMM_NAME_UPPER), GEMM_CAT(gemm_kernel_avx512, GEMM_NAME) },
+#endif
+};
+
+// Multiply matrices i.e. C += A * B
+bool GEMM_FN(gemm)(size_t m, size_t n, size_t k, const GEMM_T * a, size_t lda, const GEMM_T * b, size_t ldb,
+                   GEMM_T * c, size_t ldc) {
+    return GEMM_FN(gemm_with)(&GEMM_FN(kernels)[gemm_get_isa()], m, n, k, a, lda, b, ldb, c, ldc);
+}
+
+// A parallel multiplication shared by the worker threads
+typedef struct GEMM_FN(job_t) {
+    const GEMM_FN(kernel_t) * kernel;
+    size_t         m;
+    size_t         n;
+    size_t         k;
+    const GEMM_T * a;
+    size_t         lda;
+    const GEMM_T * b;
+    size_t         ldb;
+    GEMM_T *       c;
+    size_t         ldc;
+    bool           zero;
+    size_t         col_tiles;   // number of macro-tiles across each row of macro-tiles
+    size_t         nworkers;
+    deque_t *      deques;      // range of macro-tiles for each worker
+    size_t         completed;   // number of macro-tiles computed
+} GEMM_FN(job_t);
+
+// A worker thread taking part in a parallel multiplication
+typedef struct GEMM_FN(worker_t) {
+    GEMM_FN(job_t) * job;
+    size_t           self;
+} GEMM_FN(worker_t);
+
+// Compute one macro-tile of C, packing into the worker's own buffers
+static void GEMM_FN(compute_tile)(const GEMM_FN(job_t) * job, uint32_t tile, GEMM_T * packed_a, GEMM_T * packed_b) {
+    const size_t ic = (tile / job->col_tiles) * MC;
+    const size_t jc = (tile % job->col_tiles) * TILE_NC;
+    const size_t mc = (job->m - ic < MC) ? job->m - ic : MC;
+    const size_t nc = (job->n - jc < TILE_NC) ? job->n - jc : TILE_NC;
+    GEMM_T *     c  = job->c + ic*job->ldc + jc;
+
+    // First touch of an uninitialised tile is by the worker that computes it
+    if(job->zero) {
+        for(size_t i = 0; i < mc; i++) {
+            memset(c + i*job->ldc, 0, nc * sizeof(GEMM_T));
+        }
+    }
+
+    for(size_t pc = 0; pc < job->k; pc += KC) {
+        const size_t kc = (job->k - pc < KC) ? job->k - pc : KC;
+        GEMM_FN(pack_b)(kc, nc, job->b + pc*job->ldb + jc, job->ldb, job->kernel->nr, packed_b);
+        GEMM_FN(pack_a)(mc, kc, job->a + ic*job->lda + pc, job->lda, job->kernel->mr, packed_a);
+        GEMM_FN(macro_kernel)(job->kernel, mc, nc, kc, packed_a, packed_b, c, job->ldc);
+    }
+}
+
+// Worker thread, computing macro-tiles from its own range and then stealing from others until none remain
+static void * GEMM_FN(work)(void * arg) {
+    GEMM_FN(worker_t) * worker = arg;
+    GEMM_FN(job_t) *    job    = worker->job;
+
+    // Packing buffers are per worker, so are first touched on its NUMA node. A worker that cannot allocate them
+    // leaves its tiles to be stolen.
+    GEMM_T * packed_a = malloc(ROUND_UP(MC, job->kernel->mr) * KC * sizeof(GEMM_T));
+    GEMM_T * packed_b = malloc(ROUND_UP(TILE_NC, job->kernel->nr) * KC * sizeof(GEMM_T));
+    if((packed_a != NULL) && (packed_b != NULL)) {
+        uint32_t tile;
+        while(deque_pop(&job->deques[worker->self], &tile) ||
+              deque_steal(job->deques, job->nworkers, worker->self, &tile)) {
+            GEMM_FN(compute_tile)(job, tile, packed_a, packed_b);
+            __atomic_fetch_add(&job->completed, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    free(packed_a);
+    free(packed_b);
+    return NULL;
+}
+
+// Multiply matrices i.e. C += A * B, or C = A * B, using a pool of threads
+bool GEMM_CAT(GEMM_FN(gemm), parallel)(size_t nthreads, bool zero, size_t m, size_t n, size_t k, const GEMM_T * a,
+                                        size_t lda, const GEMM_T * b, size_t ldb, GEMM_T * c, size_t ldc) {
+    if((m == 0) || (n == 0)) {
+        return true;
+    }
+
+    // Split C into macro-tiles, and give each worker an equal contiguous range of them
+    const size_t row_tiles = (m + MC - 1) / MC;
+    const size_t col_tiles = (n + TILE_NC - 1) / TILE_NC;
+    const size_t ntiles    = row_tiles * col_tiles;
+    const size_t nworkers  = count_workers(nthreads, ntiles);
+
+    GEMM_FN(job_t) job = {
+        &GEMM_FN(kernels)[gemm_get_isa()], m, n, k, a, lda, b, ldb, c, ldc, zero, col_tiles, nworkers, NULL, 0
+    };
+    job.deques = malloc(nworkers * sizeof(deque_t));
+    GEMM_FN(worker_t) * workers = malloc(nworkers * sizeof(GEMM_FN(worker_t)));
+    pthread_t *         threads = malloc(nworkers * sizeof(pthread_t));
+    bool *              started = calloc(nworkers, sizeof(bool));
+    if((job.deques == NULL) || (workers == NULL) || (threads == NULL) || (started == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(job.deques);
+        free(workers);
+        free(threads);
+        free(started);
+        return false;
+    }
+    for(size_t w = 0; w < nworkers; w++) {
+        job.deques[w].range = RANGE(w * ntiles / nworkers, (w + 1) * ntiles / nworkers);
+        workers[w].job      = &job;
+        workers[w].self     = w;
+    }
+
+    // The calling thread is worker 0. A worker whose thread cannot be started has its tiles stolen by the others.
+    for(size_t w = 1; w < nworkers; w++) {
+        started[w] = (pthread_create(&threads[w], NULL, GEMM_FN(work), &workers[w]) == 0);
+    }
+    GEMM_FN(work)(&workers[0]);
+    for(size_t w = 1; w < nworkers; w++) {
+        if(started[w]) {
+            pthread_join(threads[w], NULL);
+        }
+    }
+
+    free(job.deques);
+    free(workers);
+    free(threads);
+    free(started);
+
+    if(job.completed != ntiles) {
+        printf("Failed to compute %zu of %zu tiles\n", ntiles - job.completed, ntiles);
+        return false;
+    }
+    return true;
+}
+
+// Set an m x n matrix to zero
+static void GEMM_FN(zero)(size_t m, size_t n, GEMM_T * z, size_t ldz) {
+    for(size_t i = 0; i < m; i++) {
+        memset(z + i*ldz, 0, n * sizeof(GEMM_T));
+    }
+}
+
+// Add h x h matrices i.e. Z = X + Y, where Z may be X or Y
+static void GEMM_FN(add)(size_t h, const GEMM_T * x, size_t ldx, const GEMM_T * y, size_t ldy, GEMM_T * z,
+                         size_t ldz) {
+    for(size_t i = 0; i < h; i++) {
+        for(size_t j = 0; j < h; j++) {
+            z[i*ldz + j] = GEMM_ADD(x[i*ldx + j], y[i*ldy + j]);
+        }
+    }
+}
+
+// Subtract h x h matrices i.e. Z = X - Y, where Z may be X or Y
+static void GEMM_FN(sub)(size_t h, const GEMM_T * x, size_t ldx, const GEMM_T * y, size_t ldy, GEMM_T * z,
+                         size_t ldz) {
+    for(size_t i = 0; i < h; i++) {
+        for(size_t j = 0; j < h; j++) {
+            z[i*ldz + j] = GEMM_SUB(x[i*ldx + j], y[i*ldy + j]);
+        }
+    }
+}
+
+// Strassen-Winograd state shared by every level of the recursion
+typedef struct GEMM_FN(strassen_t) {
+    const GEMM_FN(kernel_t) * kernel;
+    size_t    cutoff;
+    arena_t * arena;
+    GEMM_T *  packed_a;
+    GEMM_T *  packed_b;
+} GEMM_FN(strassen_t);
+
+// Multiply n x n matrices with Strassen-Winograd i.e. C = A * B, recursing down to the cutoff
+//
+// The 7 products and 15 additions are scheduled to need only two h x h temporaries, X and Y, per level, as in Boyer,
+// Dumas, Pernet and Zhou, "Memory efficient scheduling of Strassen-Winograd's matrix multiplication algorithm". When n
+// is odd the last row and column are peeled off and computed with the blocked multiplication.
+static void GEMM_FN(strassen_rec)(const GEMM_FN(strassen_t) * st, size_t n, const GEMM_T * a, size_t lda,
+                                  const GEMM_T * b, size_t ldb, GEMM_T * c, size_t ldc) {
+    // Small enough for the blocked multiplication?
+    if(n <= st->cutoff) {
+        GEMM_FN(zero)(n, n, c, ldc);
+        GEMM_FN(gemm_packed)(st->kernel, n, n, n, a, lda, b, ldb, c, ldc, st->packed_a, st->packed_b);
+        return;
+    }
+
+    // Quadrants of the even part
+    const size_t   h   = n / 2;
+    const GEMM_T * a11 = a;
+    const GEMM_T * a12 = a + h;
+    const GEMM_T * a21 = a + h*lda;
+    const GEMM_T * a22 = a + h*lda + h;
+    const GEMM_T * b11 = b;
+    const GEMM_T * b12 = b + h;
+    const GEMM_T * b21 = b + h*ldb;
+    const GEMM_T * b22 = b + h*ldb + h;
+    GEMM_T *       c11 = c;
+    GEMM_T *       c12 = c + h;
+    GEMM_T *       c21 = c + h*ldc;
+    GEMM_T *       c22 = c + h*ldc + h;
+
+    // Temporaries for this level, released on the way out
+    const size_t mark = st->arena->used;
+    GEMM_T *     x    = arena_alloc(st->arena, h * h * sizeof(GEMM_T));
+    GEMM_T *     y    = arena_alloc(st->arena, h * h * sizeof(GEMM_T));
+
+    GEMM_FN(sub)(h, a11, lda, a21, lda, x, h);              // S3 = A11 - A21
+    GEMM_FN(sub)(h, b22, ldb, b12, ldb, y, h);              // T3 = B22 - B12
+    GEMM_FN(strassen_rec)(st, h, x, h, y, h, c21, ldc);     // P7 = S3 * T3
+    GEMM_FN(add)(h, a21, lda, a22, lda, x, h);              // S1 = A21 + A22
+    GEMM_FN(sub)(h, b12, ldb, b11, ldb, y, h);              // T1 = B12 - B11
+    GEMM_FN(strassen_rec)(st, h, x, h, y, h, c22, ldc);     // P5 = S1 * T1
+    GEMM_FN(sub)(h, x, h, a11, lda, x, h);                  // S2 = S1 - A11
+    GEMM_FN(sub)(h, b22, ldb, y, h, y, h);                  // T2 = B22 - T1
+    GEMM_FN(strassen_rec)(st, h, x, h, y, h, c12, ldc);     // P6 = S2 * T2
+    GEMM_FN(sub)(h, a12, lda, x, h, x, h);                  // S4 = A12 - S2
+    GEMM_FN(strassen_rec)(st, h, x, h, b22, ldb, c11, ldc); // P3 = S4 * B22
+    GEMM_FN(strassen_rec)(st, h, a11, lda, b11, ldb, x, h); // P1 = A11 * B11
+    GEMM_FN(add)(h, x, h, c12, ldc, c12, ldc);              // U2 = P1 + P6
+    GEMM_FN(add)(h, c12, ldc, c21, ldc, c21, ldc);          // U3 = U2 + P7
+    GEMM_FN(add)(h, c12, ldc, c22, ldc, c12, ldc);          // U4 = U2 + P5
+    GEMM_FN(add)(h, c21, ldc, c22, ldc, c22, ldc);          // U7 = U3 + P5 = C22
+    GEMM_FN(add)(h, c12, ldc, c11, ldc, c12, ldc);          // U5 = U4 + P3 = C12
+    GEMM_FN(sub)(h, y, h, b21, ldb, y, h);                  // T4 = T2 - B21
+    GEMM_FN(strassen_rec)(st, h, a22, lda, y, h, c11, ldc); // P4 = A22 * T4
+    GEMM_FN(sub)(h, c21, ldc, c11, ldc, c21, ldc);          // U6 = U3 - P4 = C21
+    GEMM_FN(strassen_rec)(st, h, a12, lda, b21, ldb, c11, ldc); // P2 = A12 * B21
+    GEMM_FN(add)(h, x, h, c11, ldc, c11, ldc);              // U1 = P1 + P2 = C11
+
+    st->arena->used = mark;
+
+    // Peel off the last row and column when n is odd
+    if(n % 2 != 0) {
+        const size_t e = n - 1;
+
+        // C11 += A[0:e, e] * B[e, 0:e]
+        GEMM_FN(gemm_packed)(st->kernel, e, e, 1, a + e, lda, b + e*ldb, ldb, c, ldc, st->packed_a, st->packed_b);
+
+        // C[0:e, e] = A[0:e, :] * B[:, e]
+        GEMM_FN(zero)(e, 1, c + e, ldc);
+        GEMM_FN(gemm_packed)(st->kernel, e, 1, n, a, lda, b + e, ldb, c + e, ldc, st->packed_a, st->packed_b);
+
+        // C[e, :] = A[e, :] * B
+        GEMM_FN(zero)(1, n, c + e*ldc, ldc);
+        GEMM_FN(gemm_packed)(st->kernel, 1, n, n, a + e*lda, lda, b, ldb, c + e*ldc, ldc, st->packed_a,
+                             st->packed_b);
+    }
+}
+
+// Multiply square matrices with Strassen-Winograd i.e. C = A * B
+bool GEMM_CAT(GEMM_FN(gemm), strassen)(size_t cutoff, size_t n, const GEMM_T * a, size_t lda, const GEMM_T * b,
+                                        size_t ldb, GEMM_T * c, size_t ldc) {
+    if(n == 0) {
+        return true;
+    }
+
+    GEMM_FN(strassen_t) st = { &GEMM_FN(kernels)[gemm_get_isa()], (cutoff > 0) ? cutoff : GEMM_STRASSEN_CUTOFF, NULL,
+                               NULL, NULL };
+
+    // One arena holds the packing buffers and the temporaries for every level of the recursion
+    const size_t bytes_a = ROUND_UP(ROUND_UP((n < MC) ? n : MC, st.kernel->mr) * KC * sizeof(GEMM_T), CACHE_LINE);
+    const size_t bytes_b = ROUND_UP(ROUND_UP((n < NC) ? n : NC, st.kernel->nr) * KC * sizeof(GEMM_T), CACHE_LINE);
+    arena_t arena;
+    if(!arena_create(&arena, bytes_a + bytes_b + strassen_workspace(n, st.cutoff, sizeof(GEMM_T)))) {
+        return false;
+    }
+    st.arena    = &arena;
+    st.packed_a = arena_alloc(&arena, bytes_a);
+    st.packed_b = arena_alloc(&arena, bytes_b);
+
+    GEMM_FN(strassen_rec)(&st, n, a, lda, b, ldb, c, ldc);
+
+    arena_destroy(&arena);
+    return true;
+}
+
+#undef GEMM_FN
+#undef GEMM_CAT
+#undef GEMM_CAT2
@@ -1,11 +1,42 @@
 // Multiply two matrices with dimensions m x n and n x p
 //
 // The resulting matrix should have dimensions m x p
+//
+// The multiplication is done by the cache-blocked, register-tiled engine in
+// gemm.c. The original triple loop is kept as multiply_naive, as a reference
+// and as a baseline for the benchmark:
+//
+//  ./matrix_multiply benchmark [max size] [scalar|avx2|avx512]
+//
+// multiply_parallel spreads the multiplication over a pool of threads, and its
+// strong scaling (a fixed size over more and more threads) is benchmarked with:
+//
+//  ./matrix_multiply scaling [size] [max threads]
+//
+// multiply_strassen uses Strassen-Winograd for large square matrices, which
+// does O(n^2.81) work rather than O(n^3). It is benchmarked against the
+// blocked multiplication, for a range of cutoffs, with:
+//
+//  ./matrix_multiply strassen [max size]
+//
+// By default the micro-kernels for the best instruction set that the CPU
+// supports are used. Every supported set is verified against the naive
+// multiplication on shapes that are not multiples of the tile sizes.
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
 
 #include <errno.h>  // For errno
-#include <string.h> // For strerror
+#include <math.h>   // For fabs, fmax, log2, pow
+#include <string.h> // For strcmp, strerror
+#include <stdbool.h> // For bool, true, false
 #include <stdio.h>  // For printf
-#include <stdlib.h> // For calloc, free, EXIT_SUCCESS
+#include <stdlib.h> // For calloc, free, malloc, rand, strtoul, EXIT_SUCCESS
+#include <time.h>   // For clock_gettime
+#include "gemm.h"   // For gemm_int, gemm_float, gemm_double
+
+// The naive multiplication is very slow for large matrices, so is not
+// benchmarked beyond this size
+#define NAIVE_MAX   2048
 
 int* multiply(int* a, unsigned int arows, unsigned int acols,
               int* b, unsigned int brows, unsigned int bcols) {
@@ -22,6 +53,79 @@ int* multiply(int* a, unsigned int arows, unsigned int acols,
         return NULL;
     }
 
+    // Multiply the matrices
+    if(!gemm_int(arows, bcols, acols, a, acols, b, bcols, c, bcols)) {
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+// Multiply using a pool of threads, or one per online CPU if nthreads is 0
+int* multiply_parallel(int* a, unsigned int arows, unsigned int acols,
+                       int* b, unsigned int brows, unsigned int bcols,
+                       unsigned int nthreads) {
+    // To multiply matrices the dimensions need to be m x n and n x p
+    if(acols != brows) {
+        printf("Cannot multiply matrices with dimensions %d x %d and %d x %d\n", arows, acols, brows, bcols);
+        return NULL;
+    }
+
+    // Resulting matrix has dimensions m x p, and is left untouched so that
+    // each part is first touched by the thread that computes it
+    int *c = malloc(arows * bcols * sizeof(int));
+    if(c == NULL) {
+        printf("malloc failed: %s", strerror(errno));
+        return NULL;
+    }
+
+    // Multiply the matrices
+    if(!gemm_int_parallel(nthreads, true, arows, bcols, acols, a, acols, b, bcols, c, bcols)) {
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+// Multiply with Strassen-Winograd, for large square matrices. Otherwise, or for
+// small matrices, this is the same as multiply.
+int* multiply_strassen(int* a, unsigned int arows, unsigned int acols,
+                       int* b, unsigned int brows, unsigned int bcols) {
+    if((arows != acols) || (brows != bcols) || (acols != brows)) {
+        return multiply(a, arows, acols, b, brows, bcols);
+    }
+
+    // Resulting matrix has dimensions n x n, and is overwritten
+    int *c = malloc(arows * bcols * sizeof(int));
+    if(c == NULL) {
+        printf("malloc failed: %s", strerror(errno));
+        return NULL;
+    }
+
+    // Multiply the matrices
+    if(!gemm_int_strassen(0, arows, a, acols, b, bcols, c, bcols)) {
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+// Multiply using a naive m-p-n triple loop, which strides down the columns of b
+int* multiply_naive(int* a, unsigned int arows, unsigned int acols,
+                    int* b, unsigned int brows, unsigned int bcols) {
+    // To multiply matrices the dimensions need to be m x n and n x p
+    if(acols != brows) {
+        printf("Cannot multiply matrices with dimensions %d x %d and %d x %d\n", arows, acols, brows, bcols);
+        return NULL;
+    }
+
+    // Resulting matrix has dimensions m x p
+    int *c = calloc(arows * bcols, sizeof(int));
+    if(c == NULL) {
+        printf("malloc failed: %s", strerror(errno));
+        return NULL;
+    }
+
     // Multiply the matrices
     for(unsigned int m = 0; m < arows; m++) {
         for(unsigned int p = 0; p < bcols; p++) {
@@ -44,7 +148,337 @@ void print(char *label, int *matrix, unsigned int rows, unsigned int cols) {
     }
 }
 
-int main(void) {
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Utility function to fill a matrix with small random values
+void fill(int *matrix, unsigned int rows, unsigned int cols) {
+    for(unsigned int i = 0; i < rows * cols; i++) {
+        matrix[i] = rand() % 19 - 9;
+    }
+}
+
+// Verify the blocked multiplication against the naive multiplication for int,
+// float and double, on shapes that leave partial tiles and blocks at the edges,
+// and multiply_parallel and multiply_strassen, which for shapes that are not
+// square falls back to multiply
+bool verify(void) {
+    static const unsigned int shapes[][3] = {
+        { 2, 4, 2 }, { 4, 2, 4 }, { 1, 1, 1 }, { 7, 13, 5 }, { 5, 3, 33 },
+        { 37, 300, 19 }, { 97, 257, 129 }, { 101, 513, 4099 }
+    };
+
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        const unsigned int m = shapes[s][0];
+        const unsigned int k = shapes[s][1];
+        const unsigned int n = shapes[s][2];
+        int    *a  = malloc(m * k * sizeof(int));
+        int    *b  = malloc(k * n * sizeof(int));
+        int    *ic = calloc(m * n, sizeof(int));
+        float  *fa = malloc(m * k * sizeof(float));
+        float  *fb = malloc(k * n * sizeof(float));
+        float  *fc = calloc(m * n, sizeof(float));
+        double *da = malloc(m * k * sizeof(double));
+        double *db = malloc(k * n * sizeof(double));
+        double *dc = calloc(m * n, sizeof(double));
+        int    *pc = NULL;
+        int    *sc = NULL;
+        int    *r  = NULL;
+        bool   ok  = false;
+        if(a && b && ic && fa && fb && fc && da && db && dc) {
+            fill(a, m, k);
+            fill(b, k, n);
+            for(unsigned int i = 0; i < m * k; i++) {
+                fa[i] = da[i] = a[i];
+            }
+            for(unsigned int i = 0; i < k * n; i++) {
+                fb[i] = db[i] = b[i];
+            }
+
+            // The small integer values are exact in float and double too
+            r  = multiply_naive(a, m, k, b, k, n);
+            ok = (r != NULL) &&
+                 gemm_int(m, n, k, a, k, b, n, ic, n) &&
+                 gemm_float(m, n, k, fa, k, fb, n, fc, n) &&
+                 gemm_double(m, n, k, da, k, db, n, dc, n);
+            pc = multiply_parallel(a, m, k, b, k, n, 3);
+            sc = multiply_strassen(a, m, k, b, k, n);
+            ok = ok && (pc != NULL) && (sc != NULL);
+            for(unsigned int i = 0; ok && (i < m * n); i++) {
+                ok = (ic[i] == r[i]) && (fc[i] == r[i]) && (dc[i] == r[i]) && (pc[i] == r[i]) && (sc[i] == r[i]);
+            }
+        }
+        free(a); free(b); free(ic); free(fa); free(fb); free(fc); free(da); free(db); free(dc); free(r);
+        free(pc); free(sc);
+
+        if(!ok) {
+            printf("Mismatch for %u x %u * %u x %u\n", m, k, k, n);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Verify Strassen-Winograd against the blocked multiplication, for sizes that
+// are odd at some level of the recursion and for small cutoffs so that there
+// are several levels, and multiply_strassen with the default cutoff. Integers
+// wrap around so must match exactly, with values large enough to overflow.
+// Floating point is checked against the normwise error bound for Winograd's
+// variant in Higham, "Accuracy and Stability of Numerical Algorithms", with a
+// constant of 2, which a result with one element off by as much as the
+// largest element must fail.
+bool verify_strassen(void) {
+    static const unsigned int sizes[][2] = {
+        { 1, 0 }, { 2, 1 }, { 3, 1 }, { 17, 2 }, { 64, 8 }, { 100, 7 }, { 255, 16 }, { 301, 40 }, { 1100, 0 }
+    };
+
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        const unsigned int n      = sizes[s][0];
+        const unsigned int cutoff = sizes[s][1];
+        int    *a  = malloc(n * n * sizeof(int));
+        int    *b  = malloc(n * n * sizeof(int));
+        int    *ic = malloc(n * n * sizeof(int));
+        int    *r  = calloc(n * n, sizeof(int));
+        float  *fa = malloc(n * n * sizeof(float));
+        float  *fb = malloc(n * n * sizeof(float));
+        float  *fc = malloc(n * n * sizeof(float));
+        double *da = malloc(n * n * sizeof(double));
+        double *db = malloc(n * n * sizeof(double));
+        double *dc = malloc(n * n * sizeof(double));
+        double *dr = calloc(n * n, sizeof(double));
+        int    *sc = NULL;
+        bool   ok  = false;
+        if(a && b && ic && r && fa && fb && fc && da && db && dc && dr) {
+            for(unsigned int i = 0; i < n * n; i++) {
+                a[i]  = rand() * (rand() % 2 ? 1 : -1);
+                b[i]  = rand() * (rand() % 2 ? 1 : -1);
+
+                // The float values are exact in double, so the double result is
+                // the reference for both
+                fa[i] = (float)(rand() / (double)RAND_MAX - 0.5);
+                fb[i] = (float)(rand() / (double)RAND_MAX - 0.5);
+                da[i] = fa[i];
+                db[i] = fb[i];
+            }
+            ok = gemm_int(n, n, n, a, n, b, n, r, n) &&
+                 gemm_double(n, n, n, da, n, db, n, dr, n) &&
+                 gemm_int_strassen(cutoff, n, a, n, b, n, ic, n) &&
+                 gemm_float_strassen(cutoff, n, fa, n, fb, n, fc, n) &&
+                 gemm_double_strassen(cutoff, n, da, n, db, n, dc, n);
+            sc = multiply_strassen(a, n, n, b, n, n);
+            ok = ok && (sc != NULL);
+
+            // Max norms of A, B and C, and the errors against the blocked
+            // double result
+            double norm_a = 0.0, norm_b = 0.0, norm_c = 0.0, err_f = 0.0, err_d = 0.0;
+            for(unsigned int i = 0; ok && (i < n * n); i++) {
+                ok     = (ic[i] == r[i]) && (sc[i] == r[i]);
+                norm_a = fmax(norm_a, fabs(da[i]));
+                norm_b = fmax(norm_b, fabs(db[i]));
+                norm_c = fmax(norm_c, fabs(dr[i]));
+                err_f  = fmax(err_f, fabs(fc[i] - dr[i]));
+                err_d  = fmax(err_d, fabs(dc[i] - dr[i]));
+            }
+
+            // The bound is ((n / n0)^log2(18) * (n0^2 + 6 n0) - 6 n) * u *
+            // |A| * |B|, where n0 is the size of the matrices at the leaves of
+            // the recursion
+            unsigned int n0 = n;
+            while(n0 > ((cutoff > 0) ? cutoff : GEMM_STRASSEN_CUTOFF)) {
+                n0 /= 2;
+            }
+            const double bound = 2.0 * (pow((double)n / n0, log2(18.0)) * (n0 * (n0 + 6.0)) - 6.0 * n) *
+                                 norm_a * norm_b;
+            ok = ok && (err_f <= bound * 0x1p-24) && (err_d <= bound * 0x1p-53);
+
+            // Check that the bound is tight enough to catch a wrong element
+            fc[0] = (float)(dr[0] + norm_c);
+            ok    = ok && (fabs(fc[0] - dr[0]) > bound * 0x1p-24);
+        }
+        free(a); free(b); free(ic); free(r); free(fa); free(fb); free(fc); free(da); free(db); free(dc); free(dr);
+        free(sc);
+
+        if(!ok) {
+            printf("Mismatch for %u x %u with cutoff %u\n", n, n, cutoff);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Benchmark square multiplications, reporting billions of multiply-adds x 2
+// per second (GFLOP/s, or GOP/s for int)
+int benchmark(unsigned int max) {
+    printf("%6s %12s %12s %12s %12s\n", "n", "naive int", "gemm int", "gemm float", "gemm double");
+    for(unsigned int n = 64; n <= max; n *= 2) {
+        const double ops = 2.0 * n * n * n;
+        int    *ia = malloc(n * n * sizeof(int));
+        int    *ib = malloc(n * n * sizeof(int));
+        int    *ic = calloc(n * n, sizeof(int));
+        float  *fa = malloc(n * n * sizeof(float));
+        float  *fb = malloc(n * n * sizeof(float));
+        float  *fc = calloc(n * n, sizeof(float));
+        double *da = malloc(n * n * sizeof(double));
+        double *db = malloc(n * n * sizeof(double));
+        double *dc = calloc(n * n, sizeof(double));
+        if(!ia || !ib || !ic || !fa || !fb || !fc || !da || !db || !dc) {
+            printf("malloc failed: %s", strerror(errno));
+            free(ia); free(ib); free(ic); free(fa); free(fb); free(fc); free(da); free(db); free(dc);
+            return EXIT_FAILURE;
+        }
+        fill(ia, n, n);
+        fill(ib, n, n);
+        for(unsigned int i = 0; i < n * n; i++) {
+            fa[i] = da[i] = ia[i];
+            fb[i] = db[i] = ib[i];
+        }
+
+        printf("%6u ", n);
+        if(n <= NAIVE_MAX) {
+            double start = now();
+            int *m = multiply_naive(ia, n, n, ib, n, n);
+            printf("%12.2f ", ops / (now() - start) / 1e9);
+            free(m);
+        }
+        else {
+            printf("%12s ", "-");
+        }
+
+        double start = now();
+        gemm_int(n, n, n, ia, n, ib, n, ic, n);
+        printf("%12.2f ", ops / (now() - start) / 1e9);
+
+        start = now();
+        gemm_float(n, n, n, fa, n, fb, n, fc, n);
+        printf("%12.2f ", ops / (now() - start) / 1e9);
+
+        start = now();
+        gemm_double(n, n, n, da, n, db, n, dc, n);
+        printf("%12.2f\n", ops / (now() - start) / 1e9);
+        fflush(stdout);
+
+        free(ia); free(ib); free(ic); free(fa); free(fb); free(fc); free(da); free(db); free(dc);
+    }
+    return EXIT_SUCCESS;
+}
+
+// Benchmark the strong scaling of a float multiplication of a fixed size,
+// doubling the number of threads each time
+int scaling(unsigned int n, unsigned int max) {
+    const double ops = 2.0 * n * n * n;
+    float *a = malloc(n * n * sizeof(float));
+    float *b = malloc(n * n * sizeof(float));
+    if((a == NULL) || (b == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(a); free(b);
+        return EXIT_FAILURE;
+    }
+    for(unsigned int i = 0; i < n * n; i++) {
+        a[i] = rand() % 19 - 9;
+        b[i] = rand() % 19 - 9;
+    }
+
+    printf("%8s %12s %12s %12s\n", "threads", "GFLOP/s", "speedup", "efficiency");
+    double base = 0.0;
+    for(unsigned int t = 1; t <= max; t *= 2) {
+        // Overwrite an uninitialised result, as multiply_parallel does
+        float *c = malloc(n * n * sizeof(float));
+        if(c == NULL) {
+            printf("malloc failed: %s", strerror(errno));
+            break;
+        }
+        double start = now();
+        gemm_float_parallel(t, true, n, n, n, a, n, b, n, c, n);
+        double seconds = now() - start;
+        if(t == 1) {
+            base = seconds;
+        }
+        printf("%8u %12.2f %12.2f %11.0f%%\n", t, ops / seconds / 1e9, base / seconds, 100.0 * base / seconds / t);
+        fflush(stdout);
+        free(c);
+    }
+
+    free(a); free(b);
+    return EXIT_SUCCESS;
+}
+
+// Benchmark Strassen-Winograd against the blocked multiplication for float,
+// reporting the effective GFLOP/s i.e. as if 2 n^3 operations were done, and
+// the largest difference from the blocked result
+int strassen(unsigned int max) {
+    static const unsigned int cutoffs[] = { 256, 512, 1024 };
+
+    printf("%6s %12s", "n", "gemm");
+    for(size_t i = 0; i < sizeof(cutoffs) / sizeof(cutoffs[0]); i++) {
+        printf("   cutoff %4u", cutoffs[i]);
+    }
+    printf(" %12s\n", "max error");
+    for(unsigned int n = 512; n <= max; n *= 2) {
+        const double ops = 2.0 * n * n * n;
+        float *a = malloc(n * n * sizeof(float));
+        float *b = malloc(n * n * sizeof(float));
+        float *c = calloc(n * n, sizeof(float));
+        float *s = malloc(n * n * sizeof(float));
+        if(!a || !b || !c || !s) {
+            printf("malloc failed: %s", strerror(errno));
+            free(a); free(b); free(c); free(s);
+            return EXIT_FAILURE;
+        }
+        for(unsigned int i = 0; i < n * n; i++) {
+            a[i] = rand() / (float)RAND_MAX - 0.5f;
+            b[i] = rand() / (float)RAND_MAX - 0.5f;
+        }
+
+        double start = now();
+        gemm_float(n, n, n, a, n, b, n, c, n);
+        printf("%6u %12.2f", n, ops / (now() - start) / 1e9);
+
+        double error = 0.0;
+        for(size_t i = 0; i < sizeof(cutoffs) / sizeof(cutoffs[0]); i++) {
+            start = now();
+            gemm_float_strassen(cutoffs[i], n, a, n, b, n, s, n);
+            printf(" %14.2f", ops / (now() - start) / 1e9);
+            for(unsigned int j = 0; j < n * n; j++) {
+                error = fmax(error, fabs(s[j] - c[j]));
+            }
+        }
+        printf(" %12.2e\n", error);
+        fflush(stdout);
+
+        free(a); free(b); free(c); free(s);
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+    // Benchmark the multiplication rather than demonstrating it?
+    if((argc > 1) && (strcmp(argv[1], "benchmark") == 0)) {
+        unsigned int max = (argc > 2) ? strtoul(argv[2], NULL, 10) : 4096;
+        for(int isa = 0; (argc > 3) && (isa < GEMM_ISA_COUNT); isa++) {
+            if((strcmp(argv[3], gemm_isa_name(isa)) == 0) && !gemm_set_isa(isa)) {
+                printf("%s is not supported\n", argv[3]);
+                return EXIT_FAILURE;
+            }
+        }
+        printf("Micro-kernels: %s\n", gemm_isa_name(gemm_get_isa()));
+        return benchmark(max);
+    }
+    if((argc > 1) && (strcmp(argv[1], "scaling") == 0)) {
+        unsigned int n   = (argc > 2) ? strtoul(argv[2], NULL, 10) : 2048;
+        unsigned int max = (argc > 3) ? strtoul(argv[3], NULL, 10) : 64;
+        printf("Micro-kernels: %s\n", gemm_isa_name(gemm_get_isa()));
+        return scaling(n, max);
+    }
+    if((argc > 1) && (strcmp(argv[1], "strassen") == 0)) {
+        unsigned int max = (argc > 2) ? strtoul(argv[2], NULL, 10) : 4096;
+        printf("Micro-kernels: %s\n", gemm_isa_name(gemm_get_isa()));
+        return strassen(max);
+    }
+
     int a[2][4] = {
         { -1,  2, -4, 8 },
         { -3, -5,  7, 9 }
@@ -105,5 +539,21 @@ int main(void) {
         free(m);
     }
 
-    return EXIT_SUCCESS;
+    // Verify the micro-kernels for every instruction set that is supported
+    printf("\nVerify against the naive multiplication:\n");
+    const gemm_isa_t best = gemm_get_isa();
+    bool             ok   = true;
+    for(int isa = 0; isa < GEMM_ISA_COUNT; isa++) {
+        if(gemm_set_isa(isa)) {
+            const bool verified = verify() && verify_strassen();
+            printf("%-8s %s\n", gemm_isa_name(isa), verified ? "ok" : "FAILED");
+            ok = ok && verified;
+        }
+        else {
+            printf("%-8s not supported\n", gemm_isa_name(isa));
+        }
+    }
+    gemm_set_isa(best);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
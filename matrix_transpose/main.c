@@ -0,0 +1,226 @@
+// Transpose a matrix with dimensions m x n to dimensions n x m
+//
+// The transpose is done by the cache-oblivious functions in
+// matrix_transpose.c, using SIMD registers for small tiles, which can also
+// transpose in place or transpose bytes. The original loop is
+// kept as transpose_naive, as a reference and as a baseline for the benchmark:
+//
+//  ./matrix_transpose benchmark [max size]
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include <errno.h>              // For errno
+#include <string.h>             // For memcpy, strcmp, strerror
+#include <stdbool.h>            // For bool, true, false
+#include <stdio.h>              // For printf
+#include <stdlib.h>             // For calloc, free, malloc, rand, strtoul, EXIT_SUCCESS
+#include <time.h>               // For clock_gettime
+#include "matrix_transpose.h"   // For transpose_32, transpose_8, transpose_square_32 et al
+
+int* transpose(int* matrix, unsigned int rows, unsigned int cols) {
+    // Resulting matrix has dimensions cols x rows
+    int *transp = malloc(cols * rows * sizeof(int));
+    if(transp == NULL) {
+        printf("malloc failed: %s", strerror(errno));
+        return NULL;
+    }
+
+    // Transpose the matrix
+    transpose_32(matrix, rows, cols, cols, transp, rows);
+
+    return transp;
+}
+
+// Transpose with a naive loop, which strides down the columns of the result
+int* transpose_naive(int* matrix, unsigned int rows, unsigned int cols) {
+    // Resulting matrix has dimensions cols x rows
+    int *transp = calloc(cols * rows, sizeof(int));
+    if(transp == NULL) {
+        printf("malloc failed: %s", strerror(errno));
+        return NULL;
+    }
+
+    // Transpose the matrix
+    for(unsigned int m = 0; m < rows; m++) {
+        for(unsigned int n = 0; n < cols; n++) {
+            transp[n*rows + m] = matrix[m*cols + n];
+        }
+    }
+
+    return transp;
+}
+
+// Utility function to print a matrix
+void print(char *label, int *matrix, unsigned int rows, unsigned int cols) {
+    printf("\n%s\n", label);
+    for(unsigned int m = 0; m < rows; m++) {
+        for(unsigned int n = 0; n < cols; n++) {
+            printf("%3d ", matrix[m*cols + n]);
+        }
+        printf("\n");
+    }
+}
+
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Verify every transpose against the naive transpose, on shapes that leave
+// partial blocks at the edges
+bool verify(void) {
+    static const unsigned int shapes[][2] = {
+        { 1, 1 }, { 1, 7 }, { 7, 1 }, { 2, 3 }, { 33, 33 }, { 31, 65 }, { 100, 37 }, { 257, 513 }, { 1000, 1000 }
+    };
+
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        const unsigned int rows = shapes[s][0];
+        const unsigned int cols = shapes[s][1];
+        int           *a  = malloc(rows * cols * sizeof(int));
+        int           *t  = NULL;
+        int           *r  = NULL;
+        unsigned char *ba = malloc(rows * cols);
+        unsigned char *bt = malloc(rows * cols);
+        bool          ok  = false;
+        if((a != NULL) && (ba != NULL) && (bt != NULL)) {
+            for(unsigned int i = 0; i < rows * cols; i++) {
+                a[i]  = rand();
+                ba[i] = (unsigned char)a[i];
+            }
+            r  = transpose_naive(a, rows, cols);
+            t  = transpose(a, rows, cols);
+            ok = (r != NULL) && (t != NULL) && (memcmp(r, t, rows * cols * sizeof(int)) == 0);
+
+            // Transpose in place, which for square shapes is the recursive swap
+            transpose_inplace_32(a, rows, cols);
+            ok = ok && (memcmp(r, a, rows * cols * sizeof(int)) == 0);
+
+            // Transpose bytes, which should match the low bytes of the ints
+            transpose_8(ba, rows, cols, cols, bt, rows);
+            for(unsigned int i = 0; ok && (i < rows * cols); i++) {
+                ok = (bt[i] == (unsigned char)r[i]);
+            }
+        }
+        free(a); free(t); free(r); free(ba); free(bt);
+
+        if(!ok) {
+            printf("Mismatch for %u x %u\n", rows, cols);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Benchmark transposes of n x n and n x 2n matrices, reporting the bytes read
+// and written per second (GB/s)
+int benchmark(unsigned int max) {
+    printf("%6s %12s %12s %12s %12s %12s\n", "n", "naive", "oblivious", "in place", "n x 2n cycle", "bytes");
+    for(unsigned int n = 256; n <= max; n *= 2) {
+        const double bytes = 2.0 * n * n * sizeof(int);
+        int *a = malloc(2 * n * n * sizeof(int));
+        if(a == NULL) {
+            printf("malloc failed: %s", strerror(errno));
+            return EXIT_FAILURE;
+        }
+        for(unsigned int i = 0; i < 2 * n * n; i++) {
+            a[i] = rand();
+        }
+
+        double start = now();
+        int *t = transpose_naive(a, n, n);
+        printf("%6u %12.2f ", n, bytes / (now() - start) / 1e9);
+        free(t);
+
+        start = now();
+        t = transpose(a, n, n);
+        printf("%12.2f ", bytes / (now() - start) / 1e9);
+        free(t);
+
+        start = now();
+        transpose_square_32(a, n, n);
+        printf("%12.2f ", bytes / (now() - start) / 1e9);
+
+        start = now();
+        transpose_inplace_32(a, n, 2 * n);
+        printf("%12.2f ", 2.0 * bytes / (now() - start) / 1e9);
+
+        // Transpose the first quarter of the matrix as bytes, for the same n x n shape
+        unsigned char *bt = malloc(n * n);
+        if(bt != NULL) {
+            start = now();
+            transpose_8(a, n, n, n, bt, n);
+            printf("%12.2f\n", bytes / sizeof(int) / (now() - start) / 1e9);
+            free(bt);
+        }
+        fflush(stdout);
+
+        free(a);
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+    // Benchmark the transpose rather than demonstrating it?
+    if((argc > 1) && (strcmp(argv[1], "benchmark") == 0)) {
+        unsigned int max = (argc > 2) ? strtoul(argv[2], NULL, 10) : 8192;
+        return benchmark(max);
+    }
+
+    int a[2][4] = {
+        { 1, 2, 3, 4 },
+        { 5, 6, 7, 8 }
+    };
+
+    int b[4][2] = {
+        { 1, 2 },
+        { 3, 4 },
+        { 5, 6 },
+        { 7, 8 }
+    };
+
+    int c[3][3] = {
+        { 1, 2, 3 },
+        { 4, 5, 6 },
+        { 7, 8, 9 }
+    };
+
+    int * m = NULL;
+
+    // Transpose a to a'
+    print("Matrix a:",  (int*)a, 2, 4);
+    m = transpose((int*)a, 2, 4);
+    if(m != NULL) {
+        print("Matrix a':", (int*)m, 4, 2);
+        free(m);
+    }
+
+    // Transpose b to b'
+    print("Matrix b:",  (int*)b, 4, 2);
+    m = transpose((int*)b, 4, 2);
+    if(m != NULL) {
+        print("Matrix b':", (int*)m, 2, 4);
+        free(m);
+    }
+
+    // Transpose c to c'
+    print("Matrix c:",  (int*)c, 3, 3);
+    m = transpose((int*)c, 3, 3);
+    if(m != NULL) {
+        print("Matrix c':", (int*)m, 3, 3);
+        free(m);
+    }
+
+    // Transpose a and c in place
+    transpose_inplace_32(a, 2, 4);
+    print("Matrix a' in place:", (int*)a, 4, 2);
+    transpose_inplace_32(c, 3, 3);
+    print("Matrix c' in place:", (int*)c, 3, 3);
+
+    // Verify against the naive transpose
+    const bool ok = verify();
+    printf("\nVerify against the naive transpose: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,83 +1,315 @@
-// Transpose a matrix with dimensions m x n to dimensions n x m
+// Transpose matrices of 32-bit elements (e.g. int or float) or bytes, out of place or in place.
+//
+// All matrices are stored in row-major order. A naive transpose reads along the rows of the source but writes down the
+// columns of the destination, touching a new cache line (and for large matrices a new page) on every write. Instead:
+//  - The out-of-place transpose is cache-oblivious: it recursively halves the longer side until a block fits in the
+//    L1 cache, whatever its size, and then transposes the block.
+//  - Within a block, tiles are transposed in SIMD registers with unpack/shuffle sequences: 8 x 8 (AVX) or 4 x 4 (SSE)
+//    for 32-bit elements and 16 x 16 (SSE2) for bytes, chosen at run-time. Only the edges are copied one by one.
+//  - The in-place square transpose recursively transposes the two diagonal quadrants in place and swaps the other two,
+//    transposing them as it goes.
+//  - The in-place non-square transpose follows the cycles of the permutation that takes each element to its new
+//    position, so that huge matrices need no second matrix. Only a bitmap of the elements already moved is allocated.
+//
+// See Frigo, Leiserson, Prokop and Ramachandran, "Cache-Oblivious Algorithms"
+// See https://en.wikipedia.org/wiki/In-place_matrix_transposition
 
-#include <errno.h>  // For errno
-#include <string.h> // For strerror
-#include <stdio.h>  // For printf
-#include <stdlib.h> // For calloc, free, EXIT_SUCCESS
+#include <stdbool.h>            // For bool
+#include <stdint.h>             // For uint8_t, uint32_t
+#include <stdlib.h>             // For calloc, free
+#include <string.h>             // For memcpy
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>          // For the SSE2 and AVX intrinsics
+#endif
+#include "matrix_transpose.h"   // This module
 
-int* transpose(int* matrix, unsigned int rows, unsigned int cols) {
-    // Resulting matrix has dimensions cols x rows
-    int *transp = calloc(cols * rows, sizeof(int));
-    if(transp == NULL) {
-        printf("malloc failed: %s", strerror(errno));
-        return NULL;
+// Largest side of a block transposed directly. Two 32 x 32 blocks of 32-bit elements take 8 KiB, well within the L1.
+#define BLOCK 32
+
+// Largest side of a block of bytes transposed directly
+#define BLOCK_8 64
+
+// A 32-bit element, which may alias an int, float or any other 32-bit type
+typedef uint32_t __attribute__((may_alias)) word_t;
+
+// Transpose a block of elements directly, a function for each element size
+typedef void (*block_fn)(const void* src, size_t rows, size_t cols, size_t src_stride, void* dst, size_t dst_stride);
+
+// Transpose a block of 32-bit elements one by one i.e. dst = src'
+static void block_scalar_32(const word_t* src, size_t rows, size_t cols, size_t src_stride, word_t* dst,
+                            size_t dst_stride) {
+    for(size_t j = 0; j < cols; j++) {
+        for(size_t i = 0; i < rows; i++) {
+            dst[j*dst_stride + i] = src[i*src_stride + j];
+        }
     }
+}
 
-    // Transpose the matrix
-    for(unsigned int m = 0; m < rows; m++) {
-        for(unsigned int n = 0; n < cols; n++) {
-            transp[n*rows + m] = matrix[m*cols + n];
+// Transpose a block of bytes one by one i.e. dst = src'
+static void block_scalar_8(const uint8_t* src, size_t rows, size_t cols, size_t src_stride, uint8_t* dst,
+                           size_t dst_stride) {
+    for(size_t j = 0; j < cols; j++) {
+        for(size_t i = 0; i < rows; i++) {
+            dst[j*dst_stride + i] = src[i*src_stride + j];
         }
     }
+}
 
-    return transp;
+#if defined(__x86_64__) || defined(__i386__)
+
+// Transpose a 4 x 4 tile of 32-bit elements in SSE registers
+static void kernel_4x4_sse(const word_t* src, size_t src_stride, word_t* dst, size_t dst_stride) {
+    __m128 r0 = _mm_loadu_ps((const float*)(src + 0*src_stride));
+    __m128 r1 = _mm_loadu_ps((const float*)(src + 1*src_stride));
+    __m128 r2 = _mm_loadu_ps((const float*)(src + 2*src_stride));
+    __m128 r3 = _mm_loadu_ps((const float*)(src + 3*src_stride));
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps((float*)(dst + 0*dst_stride), r0);
+    _mm_storeu_ps((float*)(dst + 1*dst_stride), r1);
+    _mm_storeu_ps((float*)(dst + 2*dst_stride), r2);
+    _mm_storeu_ps((float*)(dst + 3*dst_stride), r3);
+}
+
+// Transpose an 8 x 8 tile of 32-bit elements in AVX registers
+//
+// Interleave pairs of rows, then pairs of pairs, giving the transposed 4 x 4 quadrants in each 128-bit lane, and
+// finally exchange the lanes. Only AVX is needed, the shuffles being on floating point registers.
+__attribute__((target("avx")))
+static void kernel_8x8_avx(const word_t* src, size_t src_stride, word_t* dst, size_t dst_stride) {
+    __m256 r[8];
+    __m256 t[8];
+    for(size_t i = 0; i < 8; i++) {
+        r[i] = _mm256_loadu_ps((const float*)(src + i*src_stride));
+    }
+    for(size_t i = 0; i < 8; i += 2) {
+        t[i]     = _mm256_unpacklo_ps(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for(size_t i = 0; i < 8; i += 4) {
+        r[i]     = _mm256_shuffle_ps(t[i],     t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        r[i + 1] = _mm256_shuffle_ps(t[i],     t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    for(size_t i = 0; i < 4; i++) {
+        _mm256_storeu_ps((float*)(dst + i*dst_stride),       _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+        _mm256_storeu_ps((float*)(dst + (i + 4)*dst_stride), _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+    }
 }
 
-// Utility function to print a matrix
-void print(char *label, int *matrix, unsigned int rows, unsigned int cols) {
-    printf("\n%s\n", label);
-    for(unsigned int m = 0; m < rows; m++) {
-        for(unsigned int n = 0; n < cols; n++) {
-            printf("%3d ", matrix[m*cols + n]);
+// Transpose a 16 x 16 tile of bytes in SSE2 registers
+//
+// Each round interleaves pairs of rows at twice the width of the last (bytes, then 16, 32 and 64 bits), so that after
+// four rounds row i holds what was column i.
+static void kernel_16x16_sse2(const uint8_t* src, size_t src_stride, uint8_t* dst, size_t dst_stride) {
+    __m128i r[16];
+    __m128i t[16];
+    for(size_t i = 0; i < 16; i++) {
+        r[i] = _mm_loadu_si128((const __m128i*)(src + i*src_stride));
+    }
+    for(size_t i = 0; i < 8; i++) {
+        t[2*i]     = _mm_unpacklo_epi8(r[2*i], r[2*i + 1]);
+        t[2*i + 1] = _mm_unpackhi_epi8(r[2*i], r[2*i + 1]);
+    }
+    for(size_t i = 0; i < 16; i += 4) {
+        for(size_t j = 0; j < 2; j++) {
+            r[i + 2*j]     = _mm_unpacklo_epi16(t[i + j], t[i + j + 2]);
+            r[i + 2*j + 1] = _mm_unpackhi_epi16(t[i + j], t[i + j + 2]);
+        }
+    }
+    for(size_t i = 0; i < 16; i += 8) {
+        for(size_t j = 0; j < 4; j++) {
+            t[i + 2*j]     = _mm_unpacklo_epi32(r[i + j], r[i + j + 4]);
+            t[i + 2*j + 1] = _mm_unpackhi_epi32(r[i + j], r[i + j + 4]);
         }
-        printf("\n");
+    }
+    for(size_t j = 0; j < 8; j++) {
+        r[2*j]     = _mm_unpacklo_epi64(t[j], t[j + 8]);
+        r[2*j + 1] = _mm_unpackhi_epi64(t[j], t[j + 8]);
+    }
+    for(size_t i = 0; i < 16; i++) {
+        _mm_storeu_si128((__m128i*)(dst + i*dst_stride), r[i]);
     }
 }
 
-int main(void) {
-    int a[2][4] = {
-        { 1, 2, 3, 4 },
-        { 5, 6, 7, 8 }
-    };
+// Whether the CPU supports AVX: 1 if so, 0 if not, or -1 until it has been checked
+static int avx_supported = -1;
 
-    int b[4][2] = {
-        { 1, 2 },
-        { 3, 4 },
-        { 5, 6 },
-        { 7, 8 }
-    };
+// Check whether the CPU supports AVX
+static bool has_avx(void) {
+    int supported = __atomic_load_n(&avx_supported, __ATOMIC_RELAXED);
+    if(supported < 0) {
+        supported = __builtin_cpu_supports("avx") ? 1 : 0;
+        __atomic_store_n(&avx_supported, supported, __ATOMIC_RELAXED);
+    }
+    return supported != 0;
+}
 
-    int c[3][3] = {
-        { 1, 2, 3 },
-        { 4, 5, 6 },
-        { 7, 8, 9 }
-    };
+#endif
 
-    int * m = NULL;
+// Transpose a block of 32-bit elements directly i.e. dst = src', in 8 x 8 and 4 x 4 tiles in registers where possible
+static void block_32(const void* source, size_t rows, size_t cols, size_t src_stride, void* destination,
+                     size_t dst_stride) {
+    const word_t* src = source;
+    word_t*       dst = destination;
+    size_t        i   = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    if(has_avx()) {
+        for(; i + 8 <= rows; i += 8) {
+            size_t j = 0;
+            for(; j + 8 <= cols; j += 8) {
+                kernel_8x8_avx(src + i*src_stride + j, src_stride, dst + j*dst_stride + i, dst_stride);
+            }
+            block_scalar_32(src + i*src_stride + j, 8, cols - j, src_stride, dst + j*dst_stride + i, dst_stride);
+        }
+    }
+    for(; i + 4 <= rows; i += 4) {
+        size_t j = 0;
+        for(; j + 4 <= cols; j += 4) {
+            kernel_4x4_sse(src + i*src_stride + j, src_stride, dst + j*dst_stride + i, dst_stride);
+        }
+        block_scalar_32(src + i*src_stride + j, 4, cols - j, src_stride, dst + j*dst_stride + i, dst_stride);
+    }
+#endif
+    block_scalar_32(src + i*src_stride, rows - i, cols, src_stride, dst + i, dst_stride);
+}
 
-    // Transpose a to a'
-    print("Matrix a:",  (int*)a, 2, 4);
-    m = transpose((int*)a, 2, 4);
-    if(m != NULL) {
-        print("Matrix a':", (int*)m, 4, 2);
-        free(m);
+// Transpose a block of bytes directly i.e. dst = src', in 16 x 16 tiles in registers where possible
+static void block_8(const void* source, size_t rows, size_t cols, size_t src_stride, void* destination,
+                    size_t dst_stride) {
+    const uint8_t* src = source;
+    uint8_t*       dst = destination;
+    size_t         i   = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    for(; i + 16 <= rows; i += 16) {
+        size_t j = 0;
+        for(; j + 16 <= cols; j += 16) {
+            kernel_16x16_sse2(src + i*src_stride + j, src_stride, dst + j*dst_stride + i, dst_stride);
+        }
+        block_scalar_8(src + i*src_stride + j, 16, cols - j, src_stride, dst + j*dst_stride + i, dst_stride);
+    }
+#endif
+    block_scalar_8(src + i*src_stride, rows - i, cols, src_stride, dst + i, dst_stride);
+}
+
+// Transpose recursively i.e. dst = src', halving the longer side until the block is small enough
+static void transpose_recursive(block_fn block, size_t side, size_t size, const uint8_t* src, size_t rows, size_t cols,
+                                size_t src_stride, uint8_t* dst, size_t dst_stride) {
+    if((rows <= side) && (cols <= side)) {
+        block(src, rows, cols, src_stride, dst, dst_stride);
     }
+    else if(rows >= cols) {
+        const size_t half = rows / 2;
+        transpose_recursive(block, side, size, src, half, cols, src_stride, dst, dst_stride);
+        transpose_recursive(block, side, size, src + half*src_stride*size, rows - half, cols, src_stride,
+                            dst + half*size, dst_stride);
+    }
+    else {
+        const size_t half = cols / 2;
+        transpose_recursive(block, side, size, src, rows, half, src_stride, dst, dst_stride);
+        transpose_recursive(block, side, size, src + half*size, rows, cols - half, src_stride,
+                            dst + half*dst_stride*size, dst_stride);
+    }
+}
+
+// Swap a rows x cols block with the transpose of a cols x rows block recursively i.e. a, b = b', a'
+//
+// Small blocks are swapped through a copy of one of them, so that both are transposed in registers.
+static void swap_recursive(word_t* a, word_t* b, size_t rows, size_t cols, size_t stride) {
+    if((rows <= BLOCK) && (cols <= BLOCK)) {
+        word_t copy[BLOCK * BLOCK];
+        for(size_t j = 0; j < cols; j++) {
+            memcpy(copy + j*rows, b + j*stride, rows * sizeof(word_t));
+        }
+        block_32(a, rows, cols, stride, b, stride);
+        block_32(copy, cols, rows, rows, a, stride);
+    }
+    else if(rows >= cols) {
+        const size_t half = rows / 2;
+        swap_recursive(a, b, half, cols, stride);
+        swap_recursive(a + half*stride, b + half, rows - half, cols, stride);
+    }
+    else {
+        const size_t half = cols / 2;
+        swap_recursive(a, b, rows, half, stride);
+        swap_recursive(a + half, b + half*stride, rows, cols - half, stride);
+    }
+}
 
-    // Transpose b to b'
-    print("Matrix b:",  (int*)b, 4, 2);
-    m = transpose((int*)b, 4, 2);
-    if(m != NULL) {
-        print("Matrix b':", (int*)m, 2, 4);
-        free(m);
+// Transpose a square matrix in place recursively
+static void square_recursive(word_t* matrix, size_t n, size_t stride) {
+    if(n <= BLOCK) {
+        word_t copy[BLOCK * BLOCK];
+        for(size_t i = 0; i < n; i++) {
+            memcpy(copy + i*n, matrix + i*stride, n * sizeof(word_t));
+        }
+        block_32(copy, n, n, n, matrix, stride);
+        return;
     }
 
-    // Transpose c to c'
-    print("Matrix c:",  (int*)c, 3, 3);
-    m = transpose((int*)c, 3, 3);
-    if(m != NULL) {
-        print("Matrix c':", (int*)m, 3, 3);
-        free(m);
+    // Transpose the diagonal quadrants in place, and swap the others with each other's transpose
+    const size_t half = n / 2;
+    square_recursive(matrix, half, stride);
+    square_recursive(matrix + half*stride + half, n - half, stride);
+    swap_recursive(matrix + half, matrix + half*stride, half, n - half, stride);
+}
+
+// Transpose a matrix out of place i.e. dst = src'
+void transpose_32(const void* src, size_t rows, size_t cols, size_t src_stride, void* dst, size_t dst_stride) {
+    transpose_recursive(block_32, BLOCK, sizeof(word_t), src, rows, cols, src_stride, dst, dst_stride);
+}
+
+// Transpose a matrix of bytes out of place i.e. dst = src'
+void transpose_8(const void* src, size_t rows, size_t cols, size_t src_stride, void* dst, size_t dst_stride) {
+    transpose_recursive(block_8, BLOCK_8, 1, src, rows, cols, src_stride, dst, dst_stride);
+}
+
+// Transpose a square matrix in place
+void transpose_square_32(void* matrix, size_t n, size_t stride) {
+    square_recursive(matrix, n, stride);
+}
+
+// Transpose a contiguous matrix in place, so that a rows x cols matrix becomes cols x rows
+void transpose_inplace_32(void* matrix, size_t rows, size_t cols) {
+    if(rows == cols) {
+        transpose_square_32(matrix, rows, cols);
+        return;
     }
 
-    return EXIT_SUCCESS;
+    // The element at index i (other than the first and last, which stay put) moves to index i * rows mod (size - 1)
+    word_t*      m       = matrix;
+    const size_t size    = rows * cols;
+    uint8_t*     visited = calloc((size + 7) / 8, 1);
+    for(size_t start = 1; start + 1 < size; start++) {
+        // Has this cycle already been moved?
+        if(visited != NULL) {
+            if(visited[start / 8] & (1u << (start % 8))) {
+                continue;
+            }
+        }
+        else {
+            // Without the bitmap, only follow the cycle from its smallest index
+            size_t i = start;
+            do {
+                i = (i * rows) % (size - 1);
+            } while(i > start);
+            if(i < start) {
+                continue;
+            }
+        }
+
+        // Carry each element along the cycle to where it belongs, displacing the next
+        word_t carried = m[start];
+        size_t i       = start;
+        do {
+            i = (i * rows) % (size - 1);
+            const word_t t = m[i];
+            m[i]    = carried;
+            carried = t;
+            if(visited != NULL) {
+                visited[i / 8] |= (uint8_t)(1u << (i % 8));
+            }
+        } while(i != start);
+    }
+    free(visited);
 }
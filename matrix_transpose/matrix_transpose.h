@@ -0,0 +1,60 @@
+// Transpose matrices of 32-bit elements (e.g. int or float) or bytes, out of place or in place.
+//
+// All matrices are stored in row-major order. A naive transpose reads along the rows of the source but writes down the
+// columns of the destination, touching a new cache line (and for large matrices a new page) on every write. Instead:
+//  - The out-of-place transpose is cache-oblivious: it recursively halves the longer side until a block fits in the
+//    L1 cache, whatever its size, and then transposes the block.
+//  - Within a block, tiles are transposed in SIMD registers with unpack/shuffle sequences: 8 x 8 (AVX) or 4 x 4 (SSE)
+//    for 32-bit elements and 16 x 16 (SSE2) for bytes, chosen at run-time. Only the edges are copied one by one.
+//  - The in-place square transpose recursively transposes the two diagonal quadrants in place and swaps the other two,
+//    transposing them as it goes.
+//  - The in-place non-square transpose follows the cycles of the permutation that takes each element to its new
+//    position, so that huge matrices need no second matrix. Only a bitmap of the elements already moved is allocated.
+//
+// Elements are accessed as 32-bit words, so the same functions serve int, unsigned and float matrices.
+//
+// See Frigo, Leiserson, Prokop and Ramachandran, "Cache-Oblivious Algorithms"
+// See https://en.wikipedia.org/wiki/In-place_matrix_transposition
+
+#ifndef MATRIX_TRANSPOSE_H
+#define MATRIX_TRANSPOSE_H
+
+#include <stddef.h>     // For size_t
+
+// Transpose a matrix out of place i.e. dst = src'.
+//
+// Parameters:
+//  src        : pointer to the first element of the source, rows x cols.
+//  rows       : number of rows in the source i.e. columns in the destination.
+//  cols       : number of columns in the source i.e. rows in the destination.
+//  src_stride : distance in elements between the starts of consecutive rows of the source, at least cols.
+//  dst        : pointer to the first element of the destination, cols x rows. It must not overlap the source.
+//  dst_stride : distance in elements between the starts of consecutive rows of the destination, at least rows.
+void transpose_32(const void* src, size_t rows, size_t cols, size_t src_stride, void* dst, size_t dst_stride);
+
+// Transpose a matrix of bytes (e.g. an 8-bit image plane) out of place i.e. dst = src'.
+//
+// Parameters: as for transpose_32, with strides in bytes.
+void transpose_8(const void* src, size_t rows, size_t cols, size_t src_stride, void* dst, size_t dst_stride);
+
+// Transpose a square matrix in place.
+//
+// Parameters:
+//  matrix : pointer to the first element of the matrix, n x n.
+//  n      : number of rows and columns.
+//  stride : distance in elements between the starts of consecutive rows, at least n.
+void transpose_square_32(void* matrix, size_t n, size_t stride);
+
+// Transpose a contiguous matrix in place, so that a rows x cols matrix becomes cols x rows.
+//
+// Square matrices are passed to transpose_square_32. Otherwise the elements are moved by cycle-following, which is
+// slower than an out-of-place transpose but needs only rows * cols / 8 bytes of extra memory. If even that cannot be
+// allocated, each cycle is instead only followed from its smallest index, which needs no memory but more time.
+//
+// Parameters:
+//  matrix : pointer to the first element of the matrix, rows x cols.
+//  rows   : number of rows in the matrix before the transpose.
+//  cols   : number of columns in the matrix before the transpose.
+void transpose_inplace_32(void* matrix, size_t rows, size_t cols);
+
+#endif // MATRIX_TRANSPOSE_H
@@ -0,0 +1,223 @@
+// Sort an array of values using an adaptive, stable merge sort in the style of Timsort
+//
+// The merge sort is benchmarked against qsort and pdqsort on random and nearly
+// sorted input, with the number of comparisons it makes per value, with:
+//
+//  ./merge_sort benchmark [number of values]
+//
+// See https://en.wikipedia.org/wiki/Timsort
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include <errno.h>          // For errno
+#include <stdbool.h>        // For bool, true, false
+#include <stdint.h>         // For uint32_t
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For EXIT_SUCCESS, EXIT_FAILURE, malloc, free, qsort, rand, strtoul
+#include <string.h>         // For memcmp, memcpy, strcmp, strerror
+#include <time.h>           // For clock_gettime
+#include "merge_sort.h"     // For merge_sort, merge_arena_t
+#include "quick_sort.h"     // For pdqsort
+
+#define NELEMENTS(a)    (sizeof(a)/sizeof(a[0]))
+
+// A record sorted by its key, with an id to check that records with equal keys keep their order
+typedef struct record_t {
+    uint32_t key;
+    uint32_t id;
+} record_t;
+
+// Generate merge sort for records, by key
+#define MERGE_T             record_t
+#define MERGE_NAME          record
+#define MERGE_LESS(a, b)    ((a).key < (b).key)
+#include "merge_sort_template.h"
+#undef MERGE_T
+#undef MERGE_NAME
+#undef MERGE_LESS
+
+// Number of comparisons made by merge_sort_counted
+static size_t ncompares = 0;
+
+// Generate merge sort for int values, counting the comparisons
+#define MERGE_T             int
+#define MERGE_NAME          counted
+#define MERGE_LESS(a, b)    (ncompares++, (a) < (b))
+#include "merge_sort_template.h"
+#undef MERGE_T
+#undef MERGE_NAME
+#undef MERGE_LESS
+
+// Patterns of input
+typedef enum pattern_t {
+    RANDOM,         // uniformly random values
+    SORTED,         // already in ascending order
+    NEARLY_SORTED,  // in ascending order but for 1% of the values swapped at random
+    APPENDED,       // in ascending order with 1% random values appended
+    REVERSED,       // in descending order
+    RUNS,           // 16 ascending runs, one after the other
+    DUPLICATES,     // random values from only a few distinct ones
+    NPATTERNS
+} pattern_t;
+
+// Print an array of values
+void print(const char* msg, const int *data, size_t nelements) {
+    printf("%s", msg);
+    for(size_t i = 0; i < nelements; i++) {
+        printf("%2d ", data[i]);
+    }
+    printf("\n");
+}
+
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Comparison function for qsort
+int compare(const void* a, const void* b) {
+    const int x = *(const int*)a;
+    const int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Fill an array with a pattern of values
+void fill(int* data, size_t nelements, pattern_t pattern) {
+    const size_t sorted = (pattern == APPENDED) ? nelements - nelements / 100 : nelements;
+    for(size_t i = 0; i < nelements; i++) {
+        switch(pattern) {
+            case RANDOM:        data[i] = rand() - RAND_MAX / 2;                            break;
+            case REVERSED:      data[i] = (int)(nelements - i);                             break;
+            case RUNS:          data[i] = (int)(i % (nelements / 16 + 1));                  break;
+            case DUPLICATES:    data[i] = rand() % 16;                                      break;
+            default:            data[i] = (i < sorted) ? (int)i : rand() % (int)nelements;  break;
+        }
+    }
+    if(pattern == NEARLY_SORTED) {
+        for(size_t swaps = 0; swaps < nelements / 200; swaps++) {
+            const size_t i    = (size_t)rand() % nelements;
+            const size_t j    = (size_t)rand() % nelements;
+            const int    temp = data[i];
+            data[i] = data[j];
+            data[j] = temp;
+        }
+    }
+}
+
+// Get the name of a pattern
+const char* pattern_name(pattern_t pattern) {
+    static const char* names[NPATTERNS] = { "random", "sorted", "nearly", "appended", "reversed", "runs",
+                                            "duplicates" };
+    return names[pattern];
+}
+
+// Benchmark the sorts on each pattern, reporting millions of values sorted per second
+int benchmark(size_t nelements) {
+    int* data     = malloc(nelements * sizeof(int));
+    int* original = malloc(nelements * sizeof(int));
+    int* expected = malloc(nelements * sizeof(int));
+    if((data == NULL) || (original == NULL) || (expected == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(data); free(original); free(expected);
+        return EXIT_FAILURE;
+    }
+
+    merge_arena_t arena = MERGE_ARENA_INIT;
+    printf("%zu values, millions sorted per second\n", nelements);
+    printf("%-12s %12s %12s %12s %12s\n", "pattern", "qsort", "pdqsort", "merge_sort", "compares");
+    bool passed = true;
+    for(pattern_t pattern = 0; pattern < NPATTERNS; pattern++) {
+        fill(original, nelements, pattern);
+        printf("%-12s ", pattern_name(pattern));
+
+        memcpy(expected, original, nelements * sizeof(int));
+        double start = now();
+        qsort(expected, nelements, sizeof(int), compare);
+        printf("%12.2f ", nelements / (now() - start) / 1e6);
+
+        memcpy(data, original, nelements * sizeof(int));
+        start = now();
+        pdqsort(data, nelements);
+        printf("%12.2f ", nelements / (now() - start) / 1e6);
+
+        memcpy(data, original, nelements * sizeof(int));
+        start = now();
+        bool         sorted = merge_sort(data, nelements, &arena);
+        const double rate   = nelements / (now() - start) / 1e6;
+        sorted = sorted && (memcmp(data, expected, nelements * sizeof(int)) == 0);
+        printf("%12.2f%s ", rate, sorted ? "" : " FAILED");
+        passed = passed && sorted;
+
+        // Count the comparisons per value, which is log2 n for a plain merge sort and close to 1 for sorted runs
+        memcpy(data, original, nelements * sizeof(int));
+        ncompares = 0;
+        merge_sort_counted(data, nelements, &arena);
+        printf("%12.2f\n", (double)ncompares / nelements);
+        fflush(stdout);
+    }
+
+    merge_arena_destroy(&arena);
+    free(data); free(original); free(expected);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Verify merge sort against qsort, for every pattern and a range of sizes including those around the minimum run
+// length, and that records with equal keys keep their order
+bool verify(void) {
+    static const size_t sizes[] = { 1, 2, 3, 63, 64, 65, 100, 1000, 54321, 300000 };
+
+    merge_arena_t arena = MERGE_ARENA_INIT;
+    bool          ok    = true;
+    for(size_t s = 0; ok && (s < NELEMENTS(sizes)); s++) {
+        for(pattern_t pattern = 0; ok && (pattern < NPATTERNS); pattern++) {
+            const size_t n        = sizes[s];
+            int*         data     = malloc(n * sizeof(int));
+            int*         expected = malloc(n * sizeof(int));
+            record_t*    records  = malloc(n * sizeof(record_t));
+            ok = false;
+            if((data != NULL) && (expected != NULL) && (records != NULL)) {
+                fill(data, n, pattern);
+                memcpy(expected, data, n * sizeof(int));
+                qsort(expected, n, sizeof(int), compare);
+                for(size_t i = 0; i < n; i++) {
+                    records[i] = (record_t){ (uint32_t)data[i] % 8, (uint32_t)i };
+                }
+                ok = merge_sort(data, n, &arena) && (memcmp(data, expected, n * sizeof(int)) == 0) &&
+                     merge_sort_record(records, n, (s % 2 == 0) ? &arena : NULL);
+                for(size_t i = 1; ok && (i < n); i++) {
+                    ok = (records[i - 1].key < records[i].key) ||
+                         ((records[i - 1].key == records[i].key) && (records[i - 1].id < records[i].id));
+                }
+            }
+            free(data); free(expected); free(records);
+
+            if(!ok) {
+                printf("Mismatch for %zu %s values\n", n, pattern_name(pattern));
+            }
+        }
+    }
+    merge_arena_destroy(&arena);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    // Benchmark the sorts rather than demonstrating them?
+    if((argc > 1) && (strcmp(argv[1], "benchmark") == 0)) {
+        size_t nelements = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10000000;
+        return (nelements > 0) ? benchmark(nelements) : EXIT_FAILURE;
+    }
+
+    // Sort two runs, one descending, which are reversed and merged
+    int data[] = { 76, 52, 43, 23, 16, 21, 24, 57, 85, 96 };
+    print("Unsorted: ", data, NELEMENTS(data));
+    merge_sort(data, NELEMENTS(data), NULL);
+    print("Sorted:   ", data, NELEMENTS(data));
+
+    // Verify against qsort
+    const bool ok = verify();
+    printf("\nVerify against qsort: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,46 @@
+// Sort an array of values using an adaptive, stable merge sort in the style of Timsort
+//
+// This has a worst case performance of O(n log n), and of O(n) on data that is already sorted or nearly so.
+//
+// See https://en.wikipedia.org/wiki/Timsort
+// See https://github.com/python/cpython/blob/main/Objects/listsort.txt
+
+#include <errno.h>          // For errno
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For malloc, free
+#include <string.h>         // For strerror
+#include "merge_sort.h"     // This module
+
+// Get memory from an arena, growing it if it is too small
+void* merge_arena_reserve(merge_arena_t* arena, size_t bytes) {
+    if(arena->capacity < bytes) {
+        // The contents need not be kept, so free and allocate rather than reallocate
+        free(arena->base);
+        arena->base     = malloc(bytes);
+        arena->capacity = (arena->base != NULL) ? bytes : 0;
+        if(arena->base == NULL) {
+            printf("malloc failed: %s", strerror(errno));
+        }
+    }
+    return arena->base;
+}
+
+// Destroy an arena, freeing its memory
+void merge_arena_destroy(merge_arena_t* arena) {
+    free(arena->base);
+    arena->base     = NULL;
+    arena->capacity = 0;
+}
+
+#define MERGE_T             int
+#define MERGE_NAME          int
+#define MERGE_LESS(a, b)    ((a) < (b))
+#include "merge_sort_template.h"
+#undef MERGE_T
+#undef MERGE_NAME
+#undef MERGE_LESS
+
+// Sort an array of values using adaptive merge sort
+bool merge_sort(int* data, size_t nelements, merge_arena_t* arena) {
+    return merge_sort_int(data, nelements, arena);
+}
@@ -0,0 +1,72 @@
+// Sort an array of values using an adaptive, stable merge sort in the style of Timsort
+//
+// This has a worst case performance of O(n log n), and of O(n) on data that is already sorted or nearly so.
+//
+// Rather than splitting the array blindly, the sort finds the runs that are already in order (reversing any that are
+// strictly descending) and merges those. Runs shorter than a minimum length of 32 to 64 are extended to it with binary
+// insertion sort. The runs are kept on a stack whose lengths grow at least as fast as the Fibonacci numbers, so that
+// merges are balanced and the stack stays small.
+//
+// Each merge copies the shorter run into a buffer and merges back into the array. When one run keeps winning, the
+// merge switches to galloping: it searches exponentially then binary for how many values it can take from that run in
+// one go, so that merging runs which barely interleave costs O(log n) comparisons rather than O(n).
+//
+// The buffer comes from an arena which can be kept and reused from one sort to the next, so that sorting repeatedly
+// does not allocate every time.
+//
+// merge_sort_template.h generates the sort for other element types, such as records sorted by a key, where stability
+// matters.
+//
+// See https://en.wikipedia.org/wiki/Timsort
+// See https://github.com/python/cpython/blob/main/Objects/listsort.txt
+// See de Gouw et al., "OpenJDK's java.utils.Collection.sort() is broken: The good, the bad and the worst case"
+
+#ifndef MERGE_SORT_H
+#define MERGE_SORT_H
+
+#include <stdbool.h>    // For bool
+#include <stddef.h>     // For size_t
+
+// A buffer for merging, kept from one sort to the next and only grown when a sort needs more.
+//
+// Fields:
+//  base     : memory allocated on the heap, or NULL.
+//  capacity : size of the memory, in bytes.
+typedef struct merge_arena_t {
+    void*  base;
+    size_t capacity;
+} merge_arena_t;
+
+// Initialiser for an empty arena
+#define MERGE_ARENA_INIT    { NULL, 0 }
+
+// Get memory from an arena, growing it if it holds fewer than the given number of bytes.
+//
+// Parameters:
+//  arena : pointer to the arena.
+//  bytes : number of bytes needed.
+//
+// Returns:
+//  a pointer to the memory, which is only valid until the arena is next grown or destroyed, or NULL if it could not be
+//  allocated.
+void* merge_arena_reserve(merge_arena_t* arena, size_t bytes);
+
+// Destroy an arena, freeing its memory and leaving it empty.
+//
+// Parameters:
+//  arena : pointer to the arena.
+void merge_arena_destroy(merge_arena_t* arena);
+
+// Sort an array of values using adaptive merge sort, which is stable.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+//  arena     : arena to take the merge buffer from, or NULL to allocate one for this sort only.
+//
+// Returns:
+//  true      : the values were sorted.
+//  false     : memory for the merge buffer could not be allocated, and the values are in an unspecified order.
+bool merge_sort(int* data, size_t nelements, merge_arena_t* arena);
+
+#endif // MERGE_SORT_H
@@ -0,0 +1,532 @@
+// Adaptive, stable merge sort in the style of Timsort, written once for any element type.
+//
+// This is included once per element type, with these defined beforehand:
+//  MERGE_T          : element type e.g. int.
+//  MERGE_NAME       : name used to make the function names unique e.g. int.
+//  MERGE_LESS(a, b) : comparison of two elements by value, true if a sorts before b.
+//
+// It generates:
+//  static bool merge_sort_<MERGE_NAME>(MERGE_T* data, size_t nelements, merge_arena_t* arena)
+// with the parameters and return value of merge_sort.
+//
+// A merge takes two adjacent runs a and b, after trimming off the values of a that are no greater than the first of b
+// and the values of b that are no less than the last of a, which are already in place. So the first value out is from
+// b and the last is from a, and the merges stop when one run is down to the value that must come last (or first).
+
+#include <stdint.h>         // For SIZE_MAX
+#include <stdio.h>          // For printf
+#include <string.h>         // For memcpy, memmove
+#include "merge_sort.h"     // For merge_arena_t, merge_arena_reserve, merge_arena_destroy
+
+// Paste together the names of the functions for this element type
+#define MERGE_CAT2(a, b) a ## _ ## b
+#define MERGE_CAT(a, b)  MERGE_CAT2(a, b)
+#define MERGE_FN(name)   MERGE_CAT(name, MERGE_NAME)
+
+#ifndef MERGE_SORT_CONSTANTS
+#define MERGE_SORT_CONSTANTS
+
+// Arrays of fewer than this many values are a single run, sorted with binary insertion sort
+#define MERGE_MIN_RUN   64
+
+// Number of consecutive values taken from one run before a merge starts galloping
+#define MERGE_GALLOP    7
+
+// Most runs on the stack. Their lengths grow at least as fast as the Fibonacci numbers, so this is enough for 2^64.
+#define MERGE_MAX_RUNS  85
+
+#endif
+
+// State of a sort: the stack of runs waiting to be merged and the merge buffer
+//
+// Fields:
+//  base       : index of the first value of each run.
+//  length     : number of values in each run.
+//  nruns      : number of runs on the stack.
+//  min_gallop : number of consecutive values taken from one run before galloping, adapted to the data.
+//  arena      : arena holding the merge buffer.
+typedef struct MERGE_FN(merge_state_t) {
+    size_t         base[MERGE_MAX_RUNS];
+    size_t         length[MERGE_MAX_RUNS];
+    size_t         nruns;
+    size_t         min_gallop;
+    merge_arena_t* arena;
+} MERGE_FN(merge_state_t);
+
+// Positions in a merge: the next place to write to and what is left of each run
+typedef struct MERGE_FN(merge_cursor_t) {
+    MERGE_T* dest;
+    MERGE_T* a;
+    size_t   na;
+    MERGE_T* b;
+    size_t   nb;
+} MERGE_FN(merge_cursor_t);
+
+// Sort a range with binary insertion sort, the first start values being sorted already
+//
+// Each value is inserted after any equal to it, so that the sort is stable, and the larger values are moved as a block.
+static void MERGE_FN(binary_insertion_sort)(MERGE_T* data, size_t nelements, size_t start) {
+    for(size_t j = start; j < nelements; j++) {
+        const MERGE_T value = data[j];
+        size_t        lo    = 0;
+        size_t        hi    = j;
+        while(lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if(MERGE_LESS(value, data[mid])) {
+                hi = mid;
+            }
+            else {
+                lo = mid + 1;
+            }
+        }
+        memmove(data + lo + 1, data + lo, (j - lo) * sizeof(MERGE_T));
+        data[lo] = value;
+    }
+}
+
+// Get the length of the run at the start of a range, reversing it if it is strictly descending
+//
+// Only strictly descending runs are reversed, as reversing equal values would make the sort unstable.
+static size_t MERGE_FN(count_run)(MERGE_T* data, size_t nelements) {
+    size_t length = 1;
+    if(nelements < 2) {
+        return length;
+    }
+
+    if(MERGE_LESS(data[1], data[0])) {
+        length = 2;
+        while((length < nelements) && MERGE_LESS(data[length], data[length - 1])) {
+            length++;
+        }
+        for(size_t i = 0, j = length - 1; i < j; i++, j--) {
+            const MERGE_T temp = data[i];
+            data[i] = data[j];
+            data[j] = temp;
+        }
+    }
+    else {
+        length = 2;
+        while((length < nelements) && !MERGE_LESS(data[length], data[length - 1])) {
+            length++;
+        }
+    }
+    return length;
+}
+
+// Find where a key goes in a sorted range, before any values equal to it, starting the search from a hint
+//
+// Gallops out from the hint by 1, 3, 7, 15, ... values until the key is bracketed, then binary searches the bracket.
+//
+// Returns k such that data[k - 1] < key <= data[k].
+static size_t MERGE_FN(gallop_left)(MERGE_T key, const MERGE_T* data, size_t nelements, size_t hint) {
+    size_t last = 0;
+    size_t ofs  = 1;
+    size_t lo;
+    size_t hi;
+    if(MERGE_LESS(data[hint], key)) {
+        // Gallop right, keeping data[hint + last] < key
+        const size_t max_ofs = nelements - hint;
+        while((ofs < max_ofs) && MERGE_LESS(data[hint + ofs], key)) {
+            last = ofs;
+            ofs  = (ofs <= SIZE_MAX / 2) ? 2*ofs + 1 : max_ofs;
+        }
+        if(ofs > max_ofs) {
+            ofs = max_ofs;
+        }
+        lo = hint + last + 1;
+        hi = hint + ofs;
+    }
+    else {
+        // Gallop left, keeping key <= data[hint - last]
+        const size_t max_ofs = hint + 1;
+        while((ofs < max_ofs) && !MERGE_LESS(data[hint - ofs], key)) {
+            last = ofs;
+            ofs  = (ofs <= SIZE_MAX / 2) ? 2*ofs + 1 : max_ofs;
+        }
+        if(ofs > max_ofs) {
+            ofs = max_ofs;
+        }
+        lo = hint + 1 - ofs;
+        hi = hint - last;
+    }
+
+    // The answer is in [lo, hi]
+    while(lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if(MERGE_LESS(data[mid], key)) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return hi;
+}
+
+// Find where a key goes in a sorted range, after any values equal to it, starting the search from a hint
+//
+// Returns k such that data[k - 1] <= key < data[k].
+static size_t MERGE_FN(gallop_right)(MERGE_T key, const MERGE_T* data, size_t nelements, size_t hint) {
+    size_t last = 0;
+    size_t ofs  = 1;
+    size_t lo;
+    size_t hi;
+    if(MERGE_LESS(key, data[hint])) {
+        // Gallop left, keeping key < data[hint - last]
+        const size_t max_ofs = hint + 1;
+        while((ofs < max_ofs) && MERGE_LESS(key, data[hint - ofs])) {
+            last = ofs;
+            ofs  = (ofs <= SIZE_MAX / 2) ? 2*ofs + 1 : max_ofs;
+        }
+        if(ofs > max_ofs) {
+            ofs = max_ofs;
+        }
+        lo = hint + 1 - ofs;
+        hi = hint - last;
+    }
+    else {
+        // Gallop right, keeping data[hint + last] <= key
+        const size_t max_ofs = nelements - hint;
+        while((ofs < max_ofs) && !MERGE_LESS(key, data[hint + ofs])) {
+            last = ofs;
+            ofs  = (ofs <= SIZE_MAX / 2) ? 2*ofs + 1 : max_ofs;
+        }
+        if(ofs > max_ofs) {
+            ofs = max_ofs;
+        }
+        lo = hint + last + 1;
+        hi = hint + ofs;
+    }
+
+    // The answer is in [lo, hi]
+    while(lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if(MERGE_LESS(key, data[mid])) {
+            hi = mid;
+        }
+        else {
+            lo = mid + 1;
+        }
+    }
+    return hi;
+}
+
+// Merge forwards, a having been copied to the buffer, until a is down to its last value or b is empty
+static void MERGE_FN(merge_lo_loop)(MERGE_FN(merge_state_t)* st, MERGE_FN(merge_cursor_t)* c) {
+    // The first value of b comes first
+    *c->dest++ = *c->b++;
+    if((--c->nb == 0) || (c->na == 1)) {
+        return;
+    }
+
+    size_t min_gallop = st->min_gallop;
+    for(;;) {
+        // Merge one value at a time until one run wins min_gallop times in a row
+        size_t acount = 0;
+        size_t bcount = 0;
+        do {
+            if(MERGE_LESS(*c->b, *c->a)) {
+                *c->dest++ = *c->b++;
+                bcount++;
+                acount = 0;
+                if(--c->nb == 0) {
+                    return;
+                }
+            }
+            else {
+                *c->dest++ = *c->a++;
+                acount++;
+                bcount = 0;
+                if(--c->na == 1) {
+                    return;
+                }
+            }
+        } while((acount < min_gallop) && (bcount < min_gallop));
+
+        // Gallop while it keeps paying off, making it easier to start again the longer it does
+        min_gallop++;
+        do {
+            min_gallop -= (min_gallop > 1);
+            st->min_gallop = min_gallop;
+
+            acount = MERGE_FN(gallop_right)(*c->b, c->a, c->na, 0);
+            if(acount > 0) {
+                memcpy(c->dest, c->a, acount * sizeof(MERGE_T));
+                c->dest += acount;
+                c->a    += acount;
+                c->na   -= acount;
+                if(c->na <= 1) {
+                    return;
+                }
+            }
+            *c->dest++ = *c->b++;
+            if(--c->nb == 0) {
+                return;
+            }
+
+            bcount = MERGE_FN(gallop_left)(*c->a, c->b, c->nb, 0);
+            if(bcount > 0) {
+                memmove(c->dest, c->b, bcount * sizeof(MERGE_T));
+                c->dest += bcount;
+                c->b    += bcount;
+                c->nb   -= bcount;
+                if(c->nb == 0) {
+                    return;
+                }
+            }
+            *c->dest++ = *c->a++;
+            if(--c->na == 1) {
+                return;
+            }
+        } while((acount >= MERGE_GALLOP) || (bcount >= MERGE_GALLOP));
+
+        // Galloping stopped paying off, so make it harder to start again
+        min_gallop++;
+        st->min_gallop = min_gallop;
+    }
+}
+
+// Merge adjacent runs, where a is no longer than b, copying a to the buffer and merging forwards
+static bool MERGE_FN(merge_lo)(MERGE_FN(merge_state_t)* st, MERGE_T* a, size_t na, MERGE_T* b, size_t nb) {
+    MERGE_T* buffer = merge_arena_reserve(st->arena, na * sizeof(MERGE_T));
+    if(buffer == NULL) {
+        return false;
+    }
+    memcpy(buffer, a, na * sizeof(MERGE_T));
+
+    MERGE_FN(merge_cursor_t) c = { a, buffer, na, b, nb };
+    MERGE_FN(merge_lo_loop)(st, &c);
+
+    // Any values left in b are already in place, so move them down and finish with what is left of a
+    memmove(c.dest, c.b, c.nb * sizeof(MERGE_T));
+    memcpy(c.dest + c.nb, c.a, c.na * sizeof(MERGE_T));
+    return true;
+}
+
+// Merge backwards, b having been copied to the buffer, until b is down to its first value or a is empty
+//
+// The cursor points at the last value of what is left of each run and at the last place to write to.
+static void MERGE_FN(merge_hi_loop)(MERGE_FN(merge_state_t)* st, MERGE_FN(merge_cursor_t)* c) {
+    // The last value of a comes last
+    *c->dest-- = *c->a--;
+    if((--c->na == 0) || (c->nb == 1)) {
+        return;
+    }
+
+    size_t min_gallop = st->min_gallop;
+    for(;;) {
+        // Merge one value at a time until one run wins min_gallop times in a row
+        size_t acount = 0;
+        size_t bcount = 0;
+        do {
+            if(MERGE_LESS(*c->b, *c->a)) {
+                *c->dest-- = *c->a--;
+                acount++;
+                bcount = 0;
+                if(--c->na == 0) {
+                    return;
+                }
+            }
+            else {
+                *c->dest-- = *c->b--;
+                bcount++;
+                acount = 0;
+                if(--c->nb == 1) {
+                    return;
+                }
+            }
+        } while((acount < min_gallop) && (bcount < min_gallop));
+
+        // Gallop while it keeps paying off, making it easier to start again the longer it does
+        min_gallop++;
+        do {
+            min_gallop -= (min_gallop > 1);
+            st->min_gallop = min_gallop;
+
+            // Take the values of a greater than the last of b
+            MERGE_T* const a_first = c->a + 1 - c->na;
+            acount = c->na - MERGE_FN(gallop_right)(*c->b, a_first, c->na, c->na - 1);
+            if(acount > 0) {
+                c->dest -= acount;
+                c->a    -= acount;
+                c->na   -= acount;
+                memmove(c->dest + 1, c->a + 1, acount * sizeof(MERGE_T));
+                if(c->na == 0) {
+                    return;
+                }
+            }
+            *c->dest-- = *c->b--;
+            if(--c->nb == 1) {
+                return;
+            }
+
+            // Take the values of b no less than the last of a
+            MERGE_T* const b_first = c->b + 1 - c->nb;
+            bcount = c->nb - MERGE_FN(gallop_left)(*c->a, b_first, c->nb, c->nb - 1);
+            if(bcount > 0) {
+                c->dest -= bcount;
+                c->b    -= bcount;
+                c->nb   -= bcount;
+                memcpy(c->dest + 1, c->b + 1, bcount * sizeof(MERGE_T));
+                if(c->nb <= 1) {
+                    return;
+                }
+            }
+            *c->dest-- = *c->a--;
+            if(--c->na == 0) {
+                return;
+            }
+        } while((acount >= MERGE_GALLOP) || (bcount >= MERGE_GALLOP));
+
+        // Galloping stopped paying off, so make it harder to start again
+        min_gallop++;
+        st->min_gallop = min_gallop;
+    }
+}
+
+// Merge adjacent runs, where b is no longer than a, copying b to the buffer and merging backwards
+static bool MERGE_FN(merge_hi)(MERGE_FN(merge_state_t)* st, MERGE_T* a, size_t na, MERGE_T* b, size_t nb) {
+    MERGE_T* buffer = merge_arena_reserve(st->arena, nb * sizeof(MERGE_T));
+    if(buffer == NULL) {
+        return false;
+    }
+    memcpy(buffer, b, nb * sizeof(MERGE_T));
+
+    MERGE_FN(merge_cursor_t) c = { b + nb - 1, a + na - 1, na, buffer + nb - 1, nb };
+    MERGE_FN(merge_hi_loop)(st, &c);
+
+    // Any values left in a are already in place, so move them up and start with what is left of b
+    memmove(a + c.nb, a, c.na * sizeof(MERGE_T));
+    memcpy(a, buffer, c.nb * sizeof(MERGE_T));
+    return true;
+}
+
+// Merge the runs at i and i + 1 on the stack
+static bool MERGE_FN(merge_at)(MERGE_FN(merge_state_t)* st, MERGE_T* data, size_t i) {
+    MERGE_T* a  = data + st->base[i];
+    size_t   na = st->length[i];
+    MERGE_T* b  = data + st->base[i + 1];
+    size_t   nb = st->length[i + 1];
+
+    // Record the merged run, dropping the one above it
+    st->length[i] = na + nb;
+    if(i + 3 == st->nruns) {
+        st->base[i + 1]   = st->base[i + 2];
+        st->length[i + 1] = st->length[i + 2];
+    }
+    st->nruns--;
+
+    // Values of a no greater than the first of b, and of b no less than the last of a, are already in place
+    const size_t k = MERGE_FN(gallop_right)(*b, a, na, 0);
+    a  += k;
+    na -= k;
+    if(na == 0) {
+        return true;
+    }
+    nb = MERGE_FN(gallop_left)(a[na - 1], b, nb, nb - 1);
+    if(nb == 0) {
+        return true;
+    }
+
+    return (na <= nb) ? MERGE_FN(merge_lo)(st, a, na, b, nb) : MERGE_FN(merge_hi)(st, a, na, b, nb);
+}
+
+// Merge runs until the lengths on the stack grow at least as fast as the Fibonacci numbers, from the top down
+//
+// The invariants are checked on the top four runs rather than three, as otherwise they can be broken further down.
+static bool MERGE_FN(merge_collapse)(MERGE_FN(merge_state_t)* st, MERGE_T* data) {
+    const size_t* length = st->length;
+    while(st->nruns > 1) {
+        size_t n = st->nruns - 2;
+        if(((n > 0) && (length[n - 1] <= length[n] + length[n + 1])) ||
+           ((n > 1) && (length[n - 2] <= length[n - 1] + length[n]))) {
+            if(length[n - 1] < length[n + 1]) {
+                n--;
+            }
+        }
+        else if(length[n] > length[n + 1]) {
+            break;
+        }
+        if(!MERGE_FN(merge_at)(st, data, n)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Merge all the runs on the stack
+static bool MERGE_FN(merge_force_collapse)(MERGE_FN(merge_state_t)* st, MERGE_T* data) {
+    while(st->nruns > 1) {
+        size_t n = st->nruns - 2;
+        if((n > 0) && (st->length[n - 1] < st->length[n + 1])) {
+            n--;
+        }
+        if(!MERGE_FN(merge_at)(st, data, n)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Get the minimum length of a run, so that the number of runs is a power of 2 or a little less
+//
+// Takes the top 6 bits of the number of values, adding 1 if any of the rest are set.
+static size_t MERGE_FN(min_run)(size_t nelements) {
+    size_t rest = 0;
+    while(nelements >= MERGE_MIN_RUN) {
+        rest      |= nelements & 1;
+        nelements >>= 1;
+    }
+    return nelements + rest;
+}
+
+// Sort the runs of a range, using the arena for the merge buffer
+static bool MERGE_FN(merge_runs)(MERGE_T* data, size_t nelements, merge_arena_t* arena) {
+    MERGE_FN(merge_state_t) st;
+    st.nruns      = 0;
+    st.min_gallop = MERGE_GALLOP;
+    st.arena      = arena;
+
+    const size_t min_run = MERGE_FN(min_run)(nelements);
+    size_t       lo      = 0;
+    while(lo < nelements) {
+        // Find the next run, extending it to the minimum length if it is shorter
+        const size_t remaining = nelements - lo;
+        size_t       length    = MERGE_FN(count_run)(data + lo, remaining);
+        if(length < min_run) {
+            const size_t extended = (remaining < min_run) ? remaining : min_run;
+            MERGE_FN(binary_insertion_sort)(data + lo, extended, length);
+            length = extended;
+        }
+
+        // Push it and restore the invariants on the stack
+        st.base[st.nruns]   = lo;
+        st.length[st.nruns] = length;
+        st.nruns++;
+        if(!MERGE_FN(merge_collapse)(&st, data)) {
+            return false;
+        }
+        lo += length;
+    }
+    return MERGE_FN(merge_force_collapse)(&st, data);
+}
+
+// Sort an array using adaptive merge sort, which is stable
+static bool MERGE_FN(merge_sort)(MERGE_T* data, size_t nelements, merge_arena_t* arena) {
+    if((data == NULL) || (nelements < 2)) {
+        return true;
+    }
+
+    // Use an arena for this sort only if none was given
+    if(arena == NULL) {
+        merge_arena_t temporary = MERGE_ARENA_INIT;
+        const bool    sorted    = MERGE_FN(merge_runs)(data, nelements, &temporary);
+        merge_arena_destroy(&temporary);
+        return sorted;
+    }
+    return MERGE_FN(merge_runs)(data, nelements, arena);
+}
+
+#undef MERGE_FN
+#undef MERGE_CAT
+#undef MERGE_CAT2
@@ -0,0 +1,136 @@
+// Sort an array of int values in parallel using sample sort
+//
+// The parallel sort is verified against qsort, and its strong scaling (a fixed
+// number of values over more and more threads) is benchmarked with:
+//
+//  ./parallel_sort scaling [number of values] [max threads]
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include <errno.h>          // For errno
+#include <stdbool.h>        // For bool, true, false
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For EXIT_SUCCESS, EXIT_FAILURE, NULL, malloc, free, qsort, rand, strtoul
+#include <string.h>         // For memcmp, memcpy, strcmp, strerror
+#include <time.h>           // For clock_gettime
+#include "parallel_sort.h"  // For parallel_sort
+
+#define NELEMENTS(a)    (sizeof(a)/sizeof(a[0]))
+
+// Print an array of values
+void print(const char* msg, const int *data, size_t nelements) {
+    printf("%s", msg);
+    for(size_t i = 0; i < nelements; i++) {
+        printf("%3d ", data[i]);
+    }
+    printf("\n");
+}
+
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Comparison function for qsort
+int compare(const void* a, const void* b) {
+    const int x = *(const int*)a;
+    const int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Utility function to get a random value over the whole range of int
+int random_int(void) {
+    return (int)(((unsigned)rand() << 16) ^ (unsigned)rand());
+}
+
+// Verify the parallel sort against qsort, for a range of sizes and numbers of
+// threads, on random, sorted, few distinct and all equal values
+bool verify(void) {
+    static const size_t sizes[]   = { 1, 1000, 65536, 100000, 1000003 };
+    static const size_t threads[] = { 1, 2, 3, 8, 64 };
+
+    for(size_t s = 0; s < NELEMENTS(sizes); s++) {
+        for(size_t t = 0; t < NELEMENTS(threads); t++) {
+            for(int pattern = 0; pattern < 4; pattern++) {
+                const size_t n        = sizes[s];
+                int*         data     = malloc(n * sizeof(int));
+                int*         expected = malloc(n * sizeof(int));
+                bool         ok       = false;
+                if((data != NULL) && (expected != NULL)) {
+                    for(size_t i = 0; i < n; i++) {
+                        data[i] = (pattern == 0) ? random_int() :
+                                  (pattern == 1) ? (int)i :
+                                  (pattern == 2) ? rand() % 5 : 42;
+                    }
+                    memcpy(expected, data, n * sizeof(int));
+                    qsort(expected, n, sizeof(int), compare);
+                    ok = parallel_sort(data, n, threads[t]) && (memcmp(data, expected, n * sizeof(int)) == 0);
+                }
+                free(data); free(expected);
+
+                if(!ok) {
+                    printf("Mismatch for %zu values on %zu threads\n", n, threads[t]);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Benchmark the strong scaling of the sort of a fixed number of random values,
+// doubling the number of threads each time
+int scaling(size_t nelements, size_t max) {
+    int* original = malloc(nelements * sizeof(int));
+    int* data     = malloc(nelements * sizeof(int));
+    if((original == NULL) || (data == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(original); free(data);
+        return EXIT_FAILURE;
+    }
+    for(size_t i = 0; i < nelements; i++) {
+        original[i] = random_int();
+    }
+
+    printf("%zu values\n", nelements);
+    printf("%8s %12s %12s %12s\n", "threads", "M/s", "speedup", "efficiency");
+    double base = 0.0;
+    for(size_t t = 1; t <= max; t *= 2) {
+        memcpy(data, original, nelements * sizeof(int));
+        double start = now();
+        parallel_sort(data, nelements, t);
+        double seconds = now() - start;
+        if(t == 1) {
+            base = seconds;
+        }
+        printf("%8zu %12.2f %12.2f %11.0f%%\n", t, nelements / seconds / 1e6, base / seconds,
+               100.0 * base / seconds / t);
+        fflush(stdout);
+    }
+
+    free(original); free(data);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[]) {
+    // Benchmark the sort rather than demonstrating it?
+    if((argc > 1) && (strcmp(argv[1], "scaling") == 0)) {
+        size_t nelements = (argc > 2) ? strtoul(argv[2], NULL, 10) : 100000000;
+        size_t max       = (argc > 3) ? strtoul(argv[3], NULL, 10) : 64;
+        return scaling(nelements, max);
+    }
+
+    // Sort a small array, which is done serially
+    int data[] = { 23, -21, 76, 16, -52, 43, 0, -1 };
+    print("Unsorted: ", data, NELEMENTS(data));
+    parallel_sort(data, NELEMENTS(data), 0);
+    print("Sorted:   ", data, NELEMENTS(data));
+
+    // Verify against qsort
+    const bool ok = verify();
+    printf("\nVerify against qsort: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,259 @@
+// Sort an array of int values in parallel using sample sort
+//
+// See Blelloch et al, "A Comparison of Sorting Algorithms for the Connection Machine CM-2"
+// See Axtmann, Witt, Ferizovic and Sanders, "In-place Parallel Super Scalar Samplesort (IPS4o)"
+
+#define _POSIX_C_SOURCE 200809L // For sysconf
+
+#include <errno.h>              // For errno
+#include <pthread.h>            // For pthread_create, pthread_join
+#include <stdint.h>             // For uint8_t, uint64_t
+#include <stdio.h>              // For printf
+#include <stdlib.h>             // For calloc, malloc, free
+#include <string.h>             // For memcpy, strerror
+#include <unistd.h>             // For sysconf
+#include "parallel_sort.h"      // This module
+#include "quick_sort.h"         // For introsort
+#include "radix_sort.h"         // For radix_sort
+
+// Arrays of fewer than this many values are sorted serially
+#define PARALLEL_MIN    65536
+
+// Number of ranges between splitters per thread, so that threads that finish early can take more buckets
+#define RANGES_PER_THREAD   4
+
+// Most ranges between splitters. With a bucket for each range and for each splitter, the bucket index fits a byte.
+#define MAX_RANGES      128
+
+// Number of values sampled per range
+#define OVERSAMPLE      32
+
+// State shared by the threads of a sort
+//
+// Fields:
+//  data        : the values being sorted.
+//  buffer      : buffer of the same size into which the values are scattered.
+//  nelements   : number of values.
+//  nthreads    : number of threads.
+//  splitters   : sorted values between the ranges.
+//  nsplitters  : number of splitters, one fewer than the ranges.
+//  nbuckets    : number of buckets i.e. 2 * nsplitters + 1, the odd-numbered ones holding values equal to a splitter.
+//  ids         : bucket of each value.
+//  counts      : number of values in each bucket for each thread's chunk, then the offset at which each is scattered.
+//  starts      : offset of each bucket in the buffer, plus one past the end.
+//  next_bucket : next bucket to be sorted by whichever thread gets to it first.
+typedef struct sorter_t {
+    int*     data;
+    int*     buffer;
+    size_t   nelements;
+    size_t   nthreads;
+    int      splitters[MAX_RANGES - 1];
+    size_t   nsplitters;
+    size_t   nbuckets;
+    uint8_t* ids;
+    size_t*  counts;
+    size_t   starts[2 * MAX_RANGES];
+    size_t   next_bucket;
+} sorter_t;
+
+// A thread's part in a phase of the sort
+typedef struct worker_t {
+    sorter_t* sorter;
+    size_t    index;
+    pthread_t thread;
+    int       error;
+} worker_t;
+
+// Get the number of threads to use
+static size_t count_threads(size_t nthreads) {
+    if(nthreads == 0) {
+        long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = (ncpus > 0) ? (size_t)ncpus : 1;
+    }
+    return nthreads;
+}
+
+// Get the chunk [begin, end) of the values for a thread
+static void chunk(const sorter_t* sorter, size_t index, size_t* begin, size_t* end) {
+    *begin = sorter->nelements * index / sorter->nthreads;
+    *end   = sorter->nelements * (index + 1) / sorter->nthreads;
+}
+
+// Classify a value i.e. find its bucket by binary search of the splitters
+static inline uint8_t classify(const sorter_t* sorter, int value) {
+    // Find the first splitter no less than the value, without branching on the comparisons
+    const int* base = sorter->splitters;
+    size_t     n    = sorter->nsplitters;
+    while(n > 1) {
+        const size_t half = n / 2;
+        base = (base[half] < value) ? base + half : base;
+        n   -= half;
+    }
+    const size_t range = (size_t)(base - sorter->splitters) + (base[0] < value);
+
+    // Values equal to the splitter go into the bucket after the range
+    const int equal = (range < sorter->nsplitters) && (sorter->splitters[range] == value);
+    return (uint8_t)(2 * range + equal);
+}
+
+// Phase 2: classify a chunk of the values and count how many fall into each bucket
+static void* count_phase(void* arg) {
+    worker_t* worker = arg;
+    sorter_t* sorter = worker->sorter;
+    size_t*   counts = sorter->counts + worker->index * sorter->nbuckets;
+    size_t    begin, end;
+    chunk(sorter, worker->index, &begin, &end);
+    for(size_t i = begin; i < end; i++) {
+        const uint8_t id = classify(sorter, sorter->data[i]);
+        sorter->ids[i] = id;
+        counts[id]++;
+    }
+    return NULL;
+}
+
+// Phase 3: scatter a chunk of the values into the buckets, keeping their order
+static void* scatter_phase(void* arg) {
+    worker_t* worker  = arg;
+    sorter_t* sorter  = worker->sorter;
+    size_t*   offsets = sorter->counts + worker->index * sorter->nbuckets;
+    size_t    begin, end;
+    chunk(sorter, worker->index, &begin, &end);
+    for(size_t i = begin; i < end; i++) {
+        sorter->buffer[offsets[sorter->ids[i]]++] = sorter->data[i];
+    }
+    return NULL;
+}
+
+// Phase 4: take buckets in turn, sort each and copy it back
+static void* sort_phase(void* arg) {
+    worker_t* worker = arg;
+    sorter_t* sorter = worker->sorter;
+    for(;;) {
+        const size_t bucket = __atomic_fetch_add(&sorter->next_bucket, 1, __ATOMIC_RELAXED);
+        if(bucket >= sorter->nbuckets) {
+            break;
+        }
+        int*         values    = sorter->buffer + sorter->starts[bucket];
+        const size_t nelements = sorter->starts[bucket + 1] - sorter->starts[bucket];
+
+        // Buckets for a splitter hold only values equal to it
+        if(bucket % 2 == 0) {
+            radix_sort(values, nelements);
+        }
+        memcpy(sorter->data + sorter->starts[bucket], values, nelements * sizeof(int));
+    }
+    return NULL;
+}
+
+// Run a phase on every thread, the calling thread being the first
+//
+// If a thread cannot be created, its part is run by the calling thread once the others are under way.
+static void run_phase(worker_t* workers, size_t nthreads, void* (*phase)(void*)) {
+    for(size_t i = 1; i < nthreads; i++) {
+        workers[i].error = pthread_create(&workers[i].thread, NULL, phase, &workers[i]);
+    }
+    phase(&workers[0]);
+    for(size_t i = 1; i < nthreads; i++) {
+        if(workers[i].error == 0) {
+            pthread_join(workers[i].thread, NULL);
+        }
+        else {
+            phase(&workers[i]);
+        }
+    }
+}
+
+// Choose the splitters from a sample of the values
+static bool choose_splitters(sorter_t* sorter) {
+    const size_t nranges = (sorter->nthreads * RANGES_PER_THREAD < MAX_RANGES) ?
+                           sorter->nthreads * RANGES_PER_THREAD : MAX_RANGES;
+    const size_t nsample = nranges * OVERSAMPLE;
+    int*         sample  = malloc(nsample * sizeof(int));
+    if(sample == NULL) {
+        printf("malloc failed: %s", strerror(errno));
+        return false;
+    }
+
+    // Sample at pseudo-random positions from a fixed seed, so that the splitters are the same every time
+    uint64_t state = 0x9E3779B97F4A7C15u;
+    for(size_t i = 0; i < nsample; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        sample[i] = sorter->data[state % sorter->nelements];
+    }
+    introsort(sample, nsample);
+
+    sorter->nsplitters = nranges - 1;
+    sorter->nbuckets   = 2 * sorter->nsplitters + 1;
+    for(size_t i = 0; i < sorter->nsplitters; i++) {
+        sorter->splitters[i] = sample[(i + 1) * OVERSAMPLE];
+    }
+    free(sample);
+    return true;
+}
+
+// Sort an array of values using a pool of threads
+bool parallel_sort(int* data, size_t nelements, size_t nthreads) {
+    if((data == NULL) || (nelements < 2)) {
+        return true;
+    }
+    nthreads = count_threads(nthreads);
+    if((nthreads == 1) || (nelements < PARALLEL_MIN)) {
+        radix_sort(data, nelements);
+        return true;
+    }
+
+    sorter_t* sorter  = calloc(1, sizeof(sorter_t));
+    worker_t* workers = calloc(nthreads, sizeof(worker_t));
+    if((sorter == NULL) || (workers == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(sorter);
+        free(workers);
+        return false;
+    }
+    sorter->data      = data;
+    sorter->nelements = nelements;
+    sorter->nthreads  = nthreads;
+    bool ok = choose_splitters(sorter);
+    if(ok) {
+        sorter->buffer = malloc(nelements * sizeof(int));
+        sorter->ids    = malloc(nelements);
+        sorter->counts = calloc(nthreads * sorter->nbuckets, sizeof(size_t));
+        ok = (sorter->buffer != NULL) && (sorter->ids != NULL) && (sorter->counts != NULL);
+        if(!ok) {
+            printf("malloc failed: %s", strerror(errno));
+        }
+    }
+
+    if(ok) {
+        for(size_t i = 0; i < nthreads; i++) {
+            workers[i].sorter = sorter;
+            workers[i].index  = i;
+        }
+
+        run_phase(workers, nthreads, count_phase);
+
+        // Turn the counts into the offset at which each thread scatters into each bucket, in thread order
+        size_t offset = 0;
+        for(size_t bucket = 0; bucket < sorter->nbuckets; bucket++) {
+            sorter->starts[bucket] = offset;
+            for(size_t t = 0; t < nthreads; t++) {
+                const size_t count = sorter->counts[t * sorter->nbuckets + bucket];
+                sorter->counts[t * sorter->nbuckets + bucket] = offset;
+                offset += count;
+            }
+        }
+        sorter->starts[sorter->nbuckets] = offset;
+
+        run_phase(workers, nthreads, scatter_phase);
+        run_phase(workers, nthreads, sort_phase);
+    }
+
+    free(sorter->buffer);
+    free(sorter->ids);
+    free(sorter->counts);
+    free(sorter);
+    free(workers);
+    return ok;
+}
@@ -0,0 +1,39 @@
+// Sort an array of int values in parallel using sample sort
+//
+// The values are split into buckets whose ranges are chosen from a sample, so that each bucket can be sorted by a
+// different thread and the sorted buckets simply laid end to end:
+//  1. A sample of the values is sorted and evenly spaced splitters are picked from it. Values equal to a splitter go
+//     into a bucket of their own, which needs no sorting, so that heavily duplicated values cannot make one bucket
+//     hold most of the values.
+//  2. Each thread classifies a contiguous chunk of the values and counts how many fall into each bucket.
+//  3. Each thread scatters its chunk into the buckets, in a buffer, at offsets found by summing the counts in thread
+//     order. The order of the values within each bucket is therefore the order in which they were given.
+//  4. The threads take buckets in turn, sort each with radix_sort and copy it back.
+//
+// The splitters are sampled at fixed positions, so the work done, and the result, depend only on the values and the
+// number of threads. Both the scatter and the LSD radix sort used for the buckets are stable.
+//
+// See Blelloch et al, "A Comparison of Sorting Algorithms for the Connection Machine CM-2"
+// See Axtmann, Witt, Ferizovic and Sanders, "In-place Parallel Super Scalar Samplesort (IPS4o)"
+
+#ifndef PARALLEL_SORT_H
+#define PARALLEL_SORT_H
+
+#include <stdbool.h>    // For bool
+#include <stddef.h>     // For size_t
+
+// Sort an array of values using a pool of threads.
+//
+// Small arrays, or a single thread, are sorted serially with radix_sort.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+//  nthreads  : number of threads to use, including the calling thread, or 0 for the number of online CPUs.
+//
+// Returns:
+//  true      : the values were sorted.
+//  false     : the values were not changed i.e. memory for the buckets could not be allocated.
+bool parallel_sort(int* data, size_t nelements, size_t nthreads);
+
+#endif // PARALLEL_SORT_H
@@ -0,0 +1,228 @@
+// Estimate quantiles of a stream of values too large to keep, using a KLL sketch
+//
+// Values are streamed through sketches of several sizes, and the quantiles they estimate are checked against the exact
+// ones found with multi_select, reporting the rank error as a fraction of the number of values.
+//
+// Adding values is benchmarked, with the rank error and memory of each size of sketch, with:
+//
+//  ./quantile_sketch benchmark [number of values]
+//
+// See Karnin, Lang and Liberty, "Optimal Quantile Approximation in Streams"
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include <errno.h>              // For errno
+#include <stdbool.h>            // For bool, true, false
+#include <stdio.h>              // For printf
+#include <stdlib.h>             // For EXIT_SUCCESS, EXIT_FAILURE, malloc, free, rand, strtoul
+#include <string.h>             // For memcpy, strcmp, strerror
+#include <time.h>               // For clock_gettime
+#include "quantile_sketch.h"    // For quantile_sketch_t and its functions
+#include "quick_select.h"       // For multi_select
+
+#define NELEMENTS(a)    (sizeof(a)/sizeof(a[0]))
+
+// Quantiles estimated, for latency reporting
+static const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+// Patterns of input
+typedef enum pattern_t {
+    RANDOM,         // uniformly random values
+    SORTED,         // already in ascending order
+    REVERSED,       // in descending order
+    LATENCY,        // long-tailed, mostly small with a few very large
+    NPATTERNS
+} pattern_t;
+
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Fill an array with a pattern of values
+void fill(int* data, size_t nelements, pattern_t pattern) {
+    for(size_t i = 0; i < nelements; i++) {
+        switch(pattern) {
+            case RANDOM:    data[i] = rand() - RAND_MAX / 2;                                    break;
+            case SORTED:    data[i] = (int)i;                                                   break;
+            case REVERSED:  data[i] = (int)(nelements - i);                                     break;
+            default:        data[i] = 1000 + rand() % 1000 / (1 + rand() % 1000) * 1000;        break;
+        }
+    }
+}
+
+// Get the name of a pattern
+const char* pattern_name(pattern_t pattern) {
+    static const char* names[NPATTERNS] = { "random", "sorted", "reversed", "latency" };
+    return names[pattern];
+}
+
+// Get the rank error of an estimate of a quantile, as a fraction of the number of values, which is 0 if the value at
+// the rank wanted is equal to the estimate
+double rank_error(const int* data, size_t nelements, double quantile, int estimate) {
+    size_t less  = 0;
+    size_t equal = 0;
+    for(size_t i = 0; i < nelements; i++) {
+        less  += (data[i] < estimate);
+        equal += (data[i] == estimate);
+    }
+    const double rank = quantile * nelements;
+    if(rank < less) {
+        return (less - rank) / nelements;
+    }
+    if(rank > less + equal) {
+        return (rank - less - equal) / nelements;
+    }
+    return 0.0;
+}
+
+// Stream values through a sketch and get the largest rank error of the quantiles estimated, or a negative error if the
+// sketch failed
+double sketch_error(const int* data, size_t nelements, size_t k, double* seconds, size_t* retained) {
+    quantile_sketch_t* sketch = quantile_sketch_create(k);
+    if(sketch == NULL) {
+        return -1.0;
+    }
+
+    bool         ok    = true;
+    const double start = now();
+    for(size_t i = 0; ok && (i < nelements); i++) {
+        ok = quantile_sketch_add(sketch, data[i]);
+    }
+    *seconds  = now() - start;
+    *retained = quantile_sketch_retained(sketch);
+
+    int estimates[NELEMENTS(quantiles)];
+    ok = ok && (quantile_sketch_count(sketch) == nelements) &&
+         quantile_sketch_query(sketch, quantiles, NELEMENTS(quantiles), estimates);
+    quantile_sketch_destroy(&sketch);
+
+    double error = ok ? 0.0 : -1.0;
+    for(size_t q = 0; ok && (q < NELEMENTS(quantiles)); q++) {
+        const double e = rank_error(data, nelements, quantiles[q], estimates[q]);
+        error = (e > error) ? e : error;
+    }
+    return error;
+}
+
+// Benchmark adding values to sketches of each size, reporting millions of values per second, the largest rank error of
+// p50, p90, p99 and p999 and the number of values kept
+int benchmark(size_t nelements) {
+    static const size_t ks[] = { 50, 200, 800 };
+
+    int* data = malloc(nelements * sizeof(int));
+    if(data == NULL) {
+        printf("malloc failed: %s", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    printf("%zu values, millions added per second, largest rank error of p50, p90, p99 and p999, values kept\n",
+           nelements);
+    printf("%-12s %6s %12s %12s %12s\n", "pattern", "k", "added", "error", "kept");
+    bool passed = true;
+    for(pattern_t pattern = 0; pattern < NPATTERNS; pattern++) {
+        fill(data, nelements, pattern);
+        for(size_t i = 0; i < NELEMENTS(ks); i++) {
+            double       seconds;
+            size_t       retained;
+            const double error = sketch_error(data, nelements, ks[i], &seconds, &retained);
+            if(error < 0.0) {
+                printf("%-12s %6zu FAILED\n", pattern_name(pattern), ks[i]);
+                passed = false;
+                continue;
+            }
+            printf("%-12s %6zu %12.2f %11.3f%% %12zu\n", pattern_name(pattern), ks[i], nelements / seconds / 1e6,
+                   100.0 * error, retained);
+            fflush(stdout);
+        }
+    }
+
+    free(data);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Verify that the rank error is within 1% with k = 200, for every pattern and a range of sizes including those that
+// the sketch keeps exactly
+bool verify(void) {
+    static const size_t sizes[] = { 1, 2, 100, 201, 1000, 54321, 300000 };
+
+    for(size_t s = 0; s < NELEMENTS(sizes); s++) {
+        for(pattern_t pattern = 0; pattern < NPATTERNS; pattern++) {
+            const size_t n    = sizes[s];
+            int*         data = malloc(n * sizeof(int));
+            double       seconds;
+            size_t       retained;
+            double       error = -1.0;
+            if(data != NULL) {
+                fill(data, n, pattern);
+                error = sketch_error(data, n, 200, &seconds, &retained);
+            }
+            free(data);
+
+            if((error < 0.0) || (error > 0.01) || ((n <= 200) && (error > 0.0))) {
+                printf("Mismatch for %zu %s values\n", n, pattern_name(pattern));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    // Benchmark the sketch rather than demonstrating it?
+    if((argc > 1) && (strcmp(argv[1], "benchmark") == 0)) {
+        size_t nelements = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10000000;
+        return (nelements > 0) ? benchmark(nelements) : EXIT_FAILURE;
+    }
+
+    // Stream a million long-tailed latencies through a sketch
+    const size_t nelements = 1000000;
+    int*         data      = malloc(nelements * sizeof(int));
+    int*         exact     = malloc(nelements * sizeof(int));
+    if((data == NULL) || (exact == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(data); free(exact);
+        return EXIT_FAILURE;
+    }
+    fill(data, nelements, LATENCY);
+
+    quantile_sketch_t* sketch = quantile_sketch_create(200);
+    if(sketch == NULL) {
+        free(data); free(exact);
+        return EXIT_FAILURE;
+    }
+    bool sketched = true;
+    for(size_t i = 0; sketched && (i < nelements); i++) {
+        sketched = quantile_sketch_add(sketch, data[i]);
+    }
+    int estimates[NELEMENTS(quantiles)];
+    sketched = sketched && quantile_sketch_query(sketch, quantiles, NELEMENTS(quantiles), estimates);
+    printf("%zu latencies, %zu kept\n", nelements, quantile_sketch_retained(sketch));
+    quantile_sketch_destroy(&sketch);
+    if(!sketched) {
+        free(data); free(exact);
+        return EXIT_FAILURE;
+    }
+
+    // Find the exact quantiles to compare
+    size_t ranks[NELEMENTS(quantiles)];
+    for(size_t q = 0; q < NELEMENTS(quantiles); q++) {
+        const size_t rank = (size_t)(quantiles[q] * nelements);
+        ranks[q] = (rank < nelements) ? rank : nelements - 1;
+    }
+    memcpy(exact, data, nelements * sizeof(int));
+    multi_select(exact, nelements, ranks, NELEMENTS(ranks));
+    for(size_t q = 0; q < NELEMENTS(quantiles); q++) {
+        printf("p%-5g estimate %8d exact %8d rank error %.3f%%\n", 100.0 * quantiles[q], estimates[q],
+               exact[ranks[q]], 100.0 * rank_error(data, nelements, quantiles[q], estimates[q]));
+    }
+    free(data); free(exact);
+
+    // Verify the rank error
+    const bool ok = verify();
+    printf("\nVerify rank error: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,229 @@
+// Estimate quantiles of a stream of values too large to keep, using a KLL sketch
+//
+// See Karnin, Lang and Liberty, "Optimal Quantile Approximation in Streams"
+
+#include <math.h>               // For ceil, pow
+#include <stdio.h>              // For printf
+#include <stdlib.h>             // For calloc, malloc, realloc, free, NULL
+#include "quantile_sketch.h"    // This module
+#include "quick_sort.h"         // For pdqsort
+#include "sort_define.h"        // For SORT_DEFINE
+
+// Ratio of the capacity of each level to that of the level above
+#define CAPACITY_RATIO  (2.0 / 3.0)
+
+// Seed for the generator that picks which values are promoted, fixed so that runs are repeatable
+#define RANDOM_SEED     0x9E3779B97F4A7C15ULL
+
+// A value kept by the sketch and the number of values added that it stands for
+typedef struct weighted_t {
+    int      value;
+    uint64_t weight;
+} weighted_t;
+
+// Generate sort_weighted, by value
+#define WEIGHTED_LESS(a, b) ((a).value < (b).value)
+SORT_DEFINE(weighted, weighted_t, WEIGHTED_LESS)
+
+// Get a random bit from a xorshift generator
+static inline unsigned random_bit(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return (unsigned)(x >> 63);
+}
+
+// Set the capacity of each level from its distance below the top level
+static void set_capacities(quantile_sketch_t* sketch) {
+    for(size_t h = 0; h < sketch->nlevels; h++) {
+        const double depth = (double)(sketch->nlevels - 1 - h);
+        sketch->capacities[h] = (size_t)ceil(sketch->k * pow(CAPACITY_RATIO, depth)) + 1;
+    }
+}
+
+// Make room for at least nelements values at a level, growing it geometrically
+static bool reserve(quantile_sketch_t* sketch, size_t h, size_t nelements) {
+    if(nelements <= sketch->allocated[h]) {
+        return true;
+    }
+    size_t allocated = 2 * sketch->allocated[h];
+    if(allocated < nelements) {
+        allocated = nelements;
+    }
+    int* level = realloc(sketch->levels[h], allocated * sizeof(int));
+    if(level == NULL) {
+        printf("Failed to allocate level\n");
+        return false;
+    }
+    sketch->levels[h]    = level;
+    sketch->allocated[h] = allocated;
+    return true;
+}
+
+// Compact a full level, promoting every other value, from a random start, to the level above
+static bool compact(quantile_sketch_t* sketch, size_t h) {
+    if(h + 1 == sketch->nlevels) {
+        if(sketch->nlevels == QUANTILE_LEVELS_MAX) {
+            printf("Too many levels\n");
+            return false;
+        }
+        sketch->nlevels++;
+        set_capacities(sketch);
+    }
+
+    // With an odd number of values the smallest stays behind, so that the weight of the rest is conserved exactly
+    int*         level  = sketch->levels[h];
+    const size_t size   = sketch->sizes[h];
+    const size_t first  = size % 2;
+    const size_t npairs = size / 2;
+    const size_t above  = sketch->sizes[h + 1];
+    if(!reserve(sketch, h + 1, above + npairs)) {
+        return false;
+    }
+    pdqsort(level, size);
+
+    int*         promoted = sketch->levels[h + 1] + above;
+    const size_t offset   = first + random_bit(&sketch->random);
+    for(size_t i = 0; i < npairs; i++) {
+        promoted[i] = level[offset + 2*i];
+    }
+    sketch->sizes[h + 1] = above + npairs;
+    sketch->sizes[h]     = first;
+    return true;
+}
+
+// Create a new quantile sketch
+quantile_sketch_t* quantile_sketch_create(size_t k) {
+    if(k < 8) {
+        printf("Bad arguments\n");
+        return NULL;
+    }
+
+    // Allocate memory for the sketch, with every level empty
+    quantile_sketch_t* sketch = calloc(1, sizeof(quantile_sketch_t));
+    if(sketch == NULL) {
+        printf("Failed to allocate struct\n");
+        return NULL;
+    }
+
+    // Initialize the parameters, with just level 0
+    sketch->k       = k;
+    sketch->nlevels = 1;
+    sketch->random  = RANDOM_SEED;
+    set_capacities(sketch);
+    if(!reserve(sketch, 0, sketch->capacities[0])) {
+        free(sketch);
+        return NULL;
+    }
+
+    return sketch;
+}
+
+// Destroy a quantile sketch
+void quantile_sketch_destroy(quantile_sketch_t** sketch) {
+    if((sketch == NULL) || (*sketch == NULL)) {
+        printf("Bad quantile sketch\n");
+        return;
+    }
+
+    for(size_t h = 0; h < (*sketch)->nlevels; h++) {
+        free((*sketch)->levels[h]);
+    }
+    free(*sketch);
+    *sketch = NULL;
+}
+
+// Add a value to a quantile sketch
+bool quantile_sketch_add(quantile_sketch_t* sketch, int value) {
+    if(sketch == NULL) {
+        printf("Bad arguments\n");
+        return false;
+    }
+
+    // Level 0 never holds more than its capacity, which only shrinks as levels are added
+    sketch->levels[0][sketch->sizes[0]++] = value;
+    sketch->count++;
+
+    // Compacting one level may fill the next, so work up from the bottom
+    if(sketch->sizes[0] >= sketch->capacities[0]) {
+        for(size_t h = 0; h < sketch->nlevels; h++) {
+            if((sketch->sizes[h] >= sketch->capacities[h]) && !compact(sketch, h)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Get the number of values added to a quantile sketch
+uint64_t quantile_sketch_count(const quantile_sketch_t* sketch) {
+    return (sketch != NULL) ? sketch->count : 0;
+}
+
+// Get the number of values kept by a quantile sketch
+size_t quantile_sketch_retained(const quantile_sketch_t* sketch) {
+    size_t retained = 0;
+    if(sketch != NULL) {
+        for(size_t h = 0; h < sketch->nlevels; h++) {
+            retained += sketch->sizes[h];
+        }
+    }
+    return retained;
+}
+
+// Estimate several quantiles of the values added to a quantile sketch
+bool quantile_sketch_query(const quantile_sketch_t* sketch, const double* quantiles, size_t nquantiles, int* values) {
+    if((sketch == NULL) || (sketch->count == 0) || (quantiles == NULL) || (values == NULL)) {
+        printf("Bad arguments\n");
+        return false;
+    }
+    for(size_t i = 0; i < nquantiles; i++) {
+        if(!((quantiles[i] >= 0.0) && (quantiles[i] <= 1.0))) {
+            printf("Bad quantile\n");
+            return false;
+        }
+    }
+
+    // Gather the values kept with their weights
+    const size_t retained = quantile_sketch_retained(sketch);
+    weighted_t*  items    = malloc(retained * sizeof(weighted_t));
+    if(items == NULL) {
+        printf("Failed to allocate items\n");
+        return false;
+    }
+    size_t nitems = 0;
+    for(size_t h = 0; h < sketch->nlevels; h++) {
+        for(size_t i = 0; i < sketch->sizes[h]; i++) {
+            items[nitems++] = (weighted_t){ sketch->levels[h][i], (uint64_t)1 << h };
+        }
+    }
+
+    // Sort by value and accumulate the weights, so that each weight becomes the estimated number of values less than
+    // or equal to that value, and the last is the number added
+    sort_weighted(items, nitems);
+    for(size_t i = 1; i < nitems; i++) {
+        items[i].weight += items[i - 1].weight;
+    }
+
+    // Binary search for the first value whose rank reaches each quantile
+    for(size_t q = 0; q < nquantiles; q++) {
+        const double rank = quantiles[q] * (double)sketch->count;
+        size_t       lo   = 0;
+        size_t       hi   = nitems - 1;
+        while(lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if((double)items[mid].weight < rank) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        values[q] = items[lo].value;
+    }
+
+    free(items);
+    return true;
+}
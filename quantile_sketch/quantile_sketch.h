@@ -0,0 +1,112 @@
+// Estimate quantiles of a stream of values too large to keep, using a KLL sketch
+//
+// The sketch keeps a stack of levels ("compactors"). Values are added to level 0, and each value at level h stands
+// for 2^h of the values added. When a level fills, it is sorted and every other value, starting at the first or the
+// second at random, is promoted to the level above, where it stands for twice as many. The rank of any value among
+// those kept therefore stays within a few of its rank among all those added, in expectation, while the number kept
+// grows only with the log of the number added.
+//
+// The capacity of a level shrinks geometrically (by 2/3) with its distance below the top level, so that most of the
+// memory goes to the top levels, whose values carry the most weight. Fewer than 3k values are kept (typically about
+// 1.5k), and the rank error of a quantile is typically well under 1% of the number of values added with k = 200. The
+// error is the same at every rank, so it is large relative to the tail for p99.9 and beyond.
+//
+// Adding a value is amortised O(log k) for the sorting. A query sorts the values kept, by value, and reads off the
+// cumulative weights.
+//
+// See Karnin, Lang and Liberty, "Optimal Quantile Approximation in Streams"
+
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <stdbool.h>    // For bool
+#include <stddef.h>     // For size_t
+#include <stdint.h>     // For uint64_t
+
+// Maximum number of levels, enough for 2^64 values
+#define QUANTILE_LEVELS_MAX 64
+
+// A KLL quantile sketch.
+//
+// Fields:
+//  k          : capacity of the top level, which sets the accuracy.
+//  count      : number of values added.
+//  nlevels    : number of levels in use.
+//  random     : state of the xorshift generator that picks which values are promoted.
+//  sizes      : number of values at each level.
+//  capacities : number of values at which each level is compacted.
+//  allocated  : number of values allocated for each level.
+//  levels     : values at each level, allocated on the heap.
+typedef struct quantile_sketch_t {
+    size_t   k;
+    uint64_t count;
+    size_t   nlevels;
+    uint64_t random;
+    size_t   sizes[QUANTILE_LEVELS_MAX];
+    size_t   capacities[QUANTILE_LEVELS_MAX];
+    size_t   allocated[QUANTILE_LEVELS_MAX];
+    int*     levels[QUANTILE_LEVELS_MAX];
+} quantile_sketch_t;
+
+// Create a new, empty quantile sketch.
+//
+// Parameters:
+//  k : capacity of the top level, at least 8. The rank error falls as 1/k, and fewer than 3k values are kept.
+//
+// Returns:
+//  pointer to the quantile sketch or NULL if the arguments are bad or memory could not be allocated.
+quantile_sketch_t* quantile_sketch_create(size_t k);
+
+// Destroy a quantile sketch.
+//
+// Parameters:
+//  sketch : pointer to pointer to the quantile sketch.
+void quantile_sketch_destroy(quantile_sketch_t** sketch);
+
+// Add a value to a quantile sketch.
+//
+// Parameters:
+//  sketch : pointer to the quantile sketch.
+//  value  : value to add.
+//
+// Returns:
+//  true     : the value was added.
+//  false    : the value was not added i.e. the arguments are bad or memory could not be allocated.
+bool quantile_sketch_add(quantile_sketch_t* sketch, int value);
+
+// Get the number of values added to a quantile sketch.
+//
+// Parameters:
+//  sketch : pointer to the quantile sketch.
+//
+// Returns:
+//  the number of values added, 0 if the sketch is NULL.
+uint64_t quantile_sketch_count(const quantile_sketch_t* sketch);
+
+// Get the number of values kept by a quantile sketch, which is what it costs in memory.
+//
+// Parameters:
+//  sketch : pointer to the quantile sketch.
+//
+// Returns:
+//  the number of values kept, 0 if the sketch is NULL.
+size_t quantile_sketch_retained(const quantile_sketch_t* sketch);
+
+// Estimate several quantiles of the values added to a quantile sketch.
+//
+// The estimate of quantile q is the smallest value kept whose estimated rank, counting values less than or equal to
+// it, is at least q times the number added.
+//
+// Parameters:
+//  sketch     : pointer to the quantile sketch, to which at least one value has been added.
+//  quantiles  : pointer to the quantiles to estimate, each between 0 and 1 e.g. 0.5 for the median, in any order.
+//  nquantiles : number of quantiles.
+//  values     : pointer into which the estimated value of each quantile will be written.
+//
+// Returns:
+//  true     : the quantiles were estimated.
+//  false    : the quantiles were not estimated i.e. the arguments are bad, the sketch is empty, or memory could not be
+//             allocated.
+bool quantile_sketch_query(const quantile_sketch_t* sketch, const double* quantiles, size_t nquantiles, int* values);
+
+#endif // QUANTILE_SKETCH_H
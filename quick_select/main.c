@@ -0,0 +1,295 @@
+// Find the median of an array of values using quickselect
+//
+// This works like quicksort, but only recurses into one side – the side with
+// the element it is searching for - and it can stop as soon as the partition
+// reaches the median position
+//
+// This has an average case performance of O(n)
+//
+// Finding percentiles with select_kth is benchmarked against sorting, and
+// against the textbook quickselect, with:
+//
+//  ./quick_select benchmark [number of values]
+//
+// Finding p50, p90, p99 and p999 together with multi_select is benchmarked
+// against select_kth for each, with:
+//
+//  ./quick_select quantiles [number of values]
+//
+// See https://en.wikipedia.org/wiki/Quickselect
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include <errno.h>          // For errno
+#include <stdbool.h>        // For bool, true, false
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For EXIT_SUCCESS, EXIT_FAILURE, NULL, malloc, free, qsort, rand, strtoul
+#include <string.h>         // For memcmp, memcpy, strcmp, strerror
+#include <time.h>           // For clock_gettime
+#include "quick_select.h"   // For quickselect, select_kth, nth_element, multi_select, partial_sort
+#include "quick_sort.h"     // For pdqsort
+
+#define NELEMENTS(a)    (sizeof(a)/sizeof(a[0]))
+
+// The textbook quickselect is O(n^2) on sorted values, so is not benchmarked on them beyond this many values
+#define QUICKSELECT_MAX 20000
+
+// Patterns of input
+typedef enum pattern_t {
+    RANDOM,         // uniformly random values
+    SORTED,         // already in ascending order
+    REVERSED,       // in descending order
+    ORGAN_PIPE,     // ascending then descending
+    DUPLICATES,     // random values from only a few distinct ones
+    NPATTERNS
+} pattern_t;
+
+// Print an array of values
+void print(const char* msg, const int *data, size_t nelements) {
+    if(data != NULL) {
+        printf("%s", msg);
+        for(size_t i = 0; i < nelements; i++) {
+            printf("%2d ", data[i]);
+        }
+        printf("\n");
+    }
+    else {
+        printf("Bad arguments!\n");
+    }
+}
+
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Comparison function for qsort
+int compare(const void* a, const void* b) {
+    const int x = *(const int*)a;
+    const int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Fill an array with a pattern of values
+void fill(int* data, size_t nelements, pattern_t pattern) {
+    for(size_t i = 0; i < nelements; i++) {
+        switch(pattern) {
+            case RANDOM:     data[i] = rand() - RAND_MAX / 2;                                   break;
+            case SORTED:     data[i] = (int)i;                                                  break;
+            case REVERSED:   data[i] = (int)(nelements - i);                                    break;
+            case ORGAN_PIPE: data[i] = (int)((i < nelements / 2) ? i : nelements - i);          break;
+            default:         data[i] = rand() % 16;                                             break;
+        }
+    }
+}
+
+// Get the name of a pattern
+const char* pattern_name(pattern_t pattern) {
+    static const char* names[NPATTERNS] = { "random", "sorted", "reversed", "organ pipe", "duplicates" };
+    return names[pattern];
+}
+
+// Benchmark finding the median and 99th percentile on each pattern, reporting millions of values per second
+int benchmark(size_t nelements) {
+    int* data     = malloc(nelements * sizeof(int));
+    int* original = malloc(nelements * sizeof(int));
+    if((data == NULL) || (original == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(data); free(original);
+        return EXIT_FAILURE;
+    }
+
+    const size_t p50 = nelements / 2;
+    const size_t p99 = nelements - nelements / 100 - 1;
+    printf("%zu values, p50 and p99, millions of values per second\n", nelements);
+    printf("%-12s %12s %12s %12s %12s\n", "pattern", "qsort", "pdqsort", "quickselect", "select_kth");
+    bool passed = true;
+    for(pattern_t pattern = 0; pattern < NPATTERNS; pattern++) {
+        fill(original, nelements, pattern);
+        printf("%-12s ", pattern_name(pattern));
+
+        // Sort and read off both percentiles
+        memcpy(data, original, nelements * sizeof(int));
+        double start = now();
+        qsort(data, nelements, sizeof(int), compare);
+        printf("%12.2f ", nelements / (now() - start) / 1e6);
+        const int expected50 = data[p50];
+        const int expected99 = data[p99];
+
+        memcpy(data, original, nelements * sizeof(int));
+        start = now();
+        pdqsort(data, nelements);
+        printf("%12.2f ", nelements / (now() - start) / 1e6);
+
+        // The textbook quickselect only finds the median
+        if((pattern == RANDOM) || (nelements <= QUICKSELECT_MAX)) {
+            memcpy(data, original, nelements * sizeof(int));
+            start = now();
+            quickselect(data, nelements, 0, nelements - 1);
+            printf("%12.2f ", nelements / (now() - start) / 1e6);
+        }
+        else {
+            printf("%12s ", "-");
+        }
+
+        // Select the 99th percentile, then the median from the values before it
+        memcpy(data, original, nelements * sizeof(int));
+        start = now();
+        const int value99 = select_kth(data, nelements, p99);
+        const int value50 = select_kth(data, p99, p50);
+        const bool ok     = (value50 == expected50) && (value99 == expected99);
+        printf("%12.2f%s\n", nelements / (now() - start) / 1e6, ok ? "" : " FAILED");
+        passed = passed && ok;
+        fflush(stdout);
+    }
+
+    free(data); free(original);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Get the time taken to copy an array, in seconds
+double copy_time(int* data, const int* original, size_t nelements) {
+    const double start = now();
+    memcpy(data, original, nelements * sizeof(int));
+    return now() - start;
+}
+
+// Benchmark finding p50, p90, p99 and p999 together on random values, reporting millions of values per second
+int benchmark_quantiles(size_t nelements) {
+    int* data     = malloc(nelements * sizeof(int));
+    int* original = malloc(nelements * sizeof(int));
+    if((data == NULL) || (original == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(data); free(original);
+        return EXIT_FAILURE;
+    }
+    fill(original, nelements, RANDOM);
+
+    const size_t ranks[] = { nelements / 2, nelements - nelements / 10 - 1, nelements - nelements / 100 - 1,
+                             nelements - nelements / 1000 - 1 };
+    int          values[NELEMENTS(ranks)];
+    printf("%zu values, p50, p90, p99 and p999, millions of values per second\n", nelements);
+    printf("%12s %12s %12s\n", "pdqsort", "select_kth", "multi_select");
+
+    memcpy(data, original, nelements * sizeof(int));
+    double start = now();
+    pdqsort(data, nelements);
+    printf("%12.2f ", nelements / (now() - start) / 1e6);
+    for(size_t i = 0; i < NELEMENTS(ranks); i++) {
+        values[i] = data[ranks[i]];
+    }
+
+    // Each quantile selected from the whole array, as though by separate calls on fresh copies
+    bool ok = true;
+    start = now();
+    for(size_t i = 0; i < NELEMENTS(ranks); i++) {
+        memcpy(data, original, nelements * sizeof(int));
+        ok = ok && (select_kth(data, nelements, ranks[i]) == values[i]);
+    }
+    printf("%12.2f%s ", nelements / (now() - start - NELEMENTS(ranks) * copy_time(data, original, nelements)) / 1e6,
+           ok ? "" : " FAILED");
+
+    memcpy(data, original, nelements * sizeof(int));
+    start = now();
+    multi_select(data, nelements, ranks, NELEMENTS(ranks));
+    printf("%12.2f", nelements / (now() - start) / 1e6);
+    for(size_t i = 0; i < NELEMENTS(ranks); i++) {
+        ok = ok && (data[ranks[i]] == values[i]);
+    }
+    printf("%s\n", ok ? "" : " FAILED");
+
+    free(data); free(original);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Verify nth_element, partial_sort and multi_select against qsort, for every pattern and a range of sizes and
+// positions including those around the cutoffs
+bool verify(void) {
+    static const size_t sizes[] = { 1, 2, 3, 5, 64, 65, 100, 601, 1000, 54321, 300000 };
+
+    for(size_t s = 0; s < NELEMENTS(sizes); s++) {
+        for(pattern_t pattern = 0; pattern < NPATTERNS; pattern++) {
+            const size_t n        = sizes[s];
+            const size_t ks[]     = { 0, 1, n / 100, n / 2, n - n / 100 - 1, n - 2, n - 1 };
+            int*         original = malloc(n * sizeof(int));
+            int*         data     = malloc(n * sizeof(int));
+            int*         expected = malloc(n * sizeof(int));
+            bool         ok       = false;
+            if((original != NULL) && (data != NULL) && (expected != NULL)) {
+                fill(original, n, pattern);
+                memcpy(expected, original, n * sizeof(int));
+                qsort(expected, n, sizeof(int), compare);
+                ok = true;
+                for(size_t i = 0; ok && (i < NELEMENTS(ks)); i++) {
+                    const size_t k = (ks[i] < n) ? ks[i] : n - 1;
+
+                    // The value at k is in place, with none greater before it and none smaller after it
+                    memcpy(data, original, n * sizeof(int));
+                    ok = (select_kth(data, n, k) == expected[k]);
+                    for(size_t j = 0; ok && (j < n); j++) {
+                        ok = (j < k) ? (data[j] <= data[k]) : (data[j] >= data[k]);
+                    }
+
+                    // The first k + 1 values are sorted
+                    memcpy(data, original, n * sizeof(int));
+                    partial_sort(data, n, k + 1);
+                    ok = ok && (memcmp(data, expected, (k + 1) * sizeof(int)) == 0);
+                }
+
+                // Every rank is in place together, and the values between consecutive ranks are between them
+                const size_t ranks[] = { 0, n / 100, n / 100, n / 2, n - n / 100 - 1, n - 1 };
+                memcpy(data, original, n * sizeof(int));
+                multi_select(data, n, ranks, NELEMENTS(ranks));
+                for(size_t i = 0; ok && (i < NELEMENTS(ranks)); i++) {
+                    ok = (data[ranks[i]] == expected[ranks[i]]);
+                    const size_t from = (i > 0) ? ranks[i - 1] : 0;
+                    for(size_t j = from; ok && (j < ranks[i]); j++) {
+                        ok = (data[j] >= data[from]) && (data[j] <= data[ranks[i]]);
+                    }
+                }
+            }
+            free(original); free(data); free(expected);
+
+            if(!ok) {
+                printf("Mismatch for %zu %s values\n", n, pattern_name(pattern));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    // Benchmark the selection rather than demonstrating it?
+    if((argc > 1) && (strcmp(argv[1], "benchmark") == 0)) {
+        size_t nelements = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10000000;
+        return (nelements > 0) ? benchmark(nelements) : EXIT_FAILURE;
+    }
+    if((argc > 1) && (strcmp(argv[1], "quantiles") == 0)) {
+        size_t nelements = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10000000;
+        return (nelements > 0) ? benchmark_quantiles(nelements) : EXIT_FAILURE;
+    }
+
+    // Create an array of unsorted data
+    int data[] = { 23, 21, 76, 16, 43, 52, 18 };
+    print("Unsorted:      ", data, NELEMENTS(data));
+
+    // Find the median using the quick select algorithm
+    int median = quickselect(data, NELEMENTS(data), 0, NELEMENTS(data) - 1);
+    print("Partly sorted: ", data, NELEMENTS(data));
+    printf("Median value:  %d\n", median);
+
+    // Find the second smallest, and sort the three smallest
+    int data2[] = { 23, 21, 76, 16, 43, 52, 18 };
+    printf("Second value:  %d\n", select_kth(data2, NELEMENTS(data2), 1));
+    partial_sort(data2, NELEMENTS(data2), 3);
+    print("Three sorted:  ", data2, NELEMENTS(data2));
+
+    // Verify against qsort
+    const bool ok = verify();
+    printf("\nVerify against qsort: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
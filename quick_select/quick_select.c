@@ -1,29 +1,169 @@
-// Find the median of an array of values using quickselect
+// Find the k-th smallest of an array of values using quickselect
 //
-// This works like quicksort, but only recurses into one side – the side with
-// the element it is searching for - and it can stop as soon as the partition
-// reaches the median position
-//
-// This has an average case performance of O(n)
+// This has an average case performance of O(n), and of O(n) in the worst case for select_kth and nth_element.
 //
 // See https://en.wikipedia.org/wiki/Quickselect
+// See https://en.wikipedia.org/wiki/Floyd%E2%80%93Rivest_algorithm
+// See https://en.wikipedia.org/wiki/Median_of_medians
+
+#include <assert.h>         // For assert
+#include <math.h>           // For exp, log, sqrt
+#include <stddef.h>         // For size_t
+#include "insertion_sort.h" // For small_sort, SMALL_SORT_MAX
+#include "quick_select.h"   // This module
+#include "quick_sort.h"     // For pdqsort
 
-#include <stdio.h>  // For printf
-#include <stdlib.h> // For EXIT_SUCCESS, NULL
+// Ranges of more than this many values pick the pivot with Floyd-Rivest sampling rather than the value at k
+#define SAMPLE_MIN  600
 
-#define NELEMENTS(a)    (sizeof(a)/sizeof(a[0]))
+// Number of values in each group whose median is taken by the median of medians
+#define GROUP       5
+
+// Swap two values
+static inline void swap(int* a, int* b) {
+    int temp = *a;
+    *a       = *b;
+    *b       = temp;
+}
 
-// Print an array of values
-void print(const char* msg, const int *data, size_t nelements) {
-    if(data != NULL) {
-        printf("%s", msg);
-        for(size_t i = 0; i < nelements; i++) {
-            printf("%2d ", data[i]);
+// Partition a range around a pivot into values less than it, equal to it and greater than it
+//
+// On return [lo, *lt) are less than the pivot, [*lt, *gt) are equal to it and [*gt, hi) are greater.
+static void partition3(int* data, size_t lo, size_t hi, int pivot, size_t* lt, size_t* gt) {
+    size_t less    = lo;
+    size_t i       = lo;
+    size_t greater = hi;
+    while(i < greater) {
+        const int value = data[i];
+        if(value < pivot) {
+            swap(&data[less++], &data[i++]);
+        }
+        else if(value > pivot) {
+            swap(&data[i], &data[--greater]);
+        }
+        else {
+            i++;
         }
-        printf("\n");
     }
-    else {
-        printf("Bad arguments!\n");
+    *lt = less;
+    *gt = greater;
+}
+
+// Select the k-th smallest value of a range [lo, hi) into place using the median of medians as the pivot
+static void median_of_medians(int* data, size_t lo, size_t hi, size_t k) {
+    while(hi - lo > SMALL_SORT_MAX) {
+        // Sort each group of 5 and move its median to the start of the range
+        const size_t ngroups = (hi - lo) / GROUP;
+        for(size_t g = 0; g < ngroups; g++) {
+            int* group = data + lo + g*GROUP;
+            small_sort(group, GROUP);
+            swap(&data[lo + g], &group[GROUP / 2]);
+        }
+
+        // Pivot on the median of the medians, which is greater than at least 3/10 of the values and less than 3/10
+        const size_t mid = lo + ngroups / 2;
+        median_of_medians(data, lo, lo + ngroups, mid);
+
+        size_t lt;
+        size_t gt;
+        partition3(data, lo, hi, data[mid], &lt, &gt);
+        if(k < lt) {
+            hi = lt;
+        }
+        else if(k >= gt) {
+            lo = gt;
+        }
+        else {
+            return;
+        }
+    }
+    small_sort(data + lo, hi - lo);
+}
+
+// Select the k-th smallest value of a range [lo, hi) into place using Floyd-Rivest selection
+static void floyd_rivest(int* data, size_t lo, size_t hi, size_t k) {
+    size_t size  = hi - lo;
+    int    steps = 0;
+    while(hi - lo > SMALL_SORT_MAX) {
+        // Select from a sample around k, of about n^(2/3) values, so that data[k] is very likely near the answer
+        const size_t n = hi - lo;
+        if(n > SAMPLE_MIN) {
+            const double i  = (double)(k - lo + 1);
+            const double z  = log((double)n);
+            const double s  = 0.5 * exp(2.0 * z / 3.0);
+            const double sd = 0.5 * sqrt(z * s * (n - s) / n) * ((i < n / 2.0) ? -1.0 : 1.0);
+            const double l  = k - i * s / n + sd;
+            const double r  = k + (n - i) * s / n + sd;
+            size_t sample_lo = (l > lo) ? (size_t)l : lo;
+            size_t sample_hi = (r + 1 < hi) ? (size_t)r + 1 : hi;
+            sample_lo = (sample_lo > k) ? k : sample_lo;
+            sample_hi = (sample_hi <= k) ? k + 1 : sample_hi;
+
+            // The values around k are only a fair sample if the data is in random order, so gather them from evenly
+            // spaced positions across the whole range
+            const size_t nsample = sample_hi - sample_lo;
+            for(size_t j = 0; j < nsample; j++) {
+                swap(&data[sample_lo + j], &data[lo + j * n / nsample]);
+            }
+            floyd_rivest(data, sample_lo, sample_hi, k);
+        }
+
+        // Keep the side with k, or stop if k is among the values equal to the pivot
+        size_t lt;
+        size_t gt;
+        partition3(data, lo, hi, data[k], &lt, &gt);
+        if(k < lt) {
+            hi = lt;
+        }
+        else if(k >= gt) {
+            lo = gt;
+        }
+        else {
+            return;
+        }
+
+        // The range should halve at least every two partitions, otherwise the data is adversarial
+        if(++steps == 2) {
+            if(hi - lo > size / 2) {
+                median_of_medians(data, lo, hi, k);
+                return;
+            }
+            size  = hi - lo;
+            steps = 0;
+        }
+    }
+    small_sort(data + lo, hi - lo);
+}
+
+// Select several sorted ranks within a range [lo, hi), by selecting the middle one and recursing on either side of it
+static void select_ranks(int* data, size_t lo, size_t hi, const size_t* ranks, size_t nranks) {
+    while(nranks > 0) {
+        const size_t mid = nranks / 2;
+        const size_t k   = ranks[mid];
+        floyd_rivest(data, lo, hi, k);
+
+        // Ranks equal to k are done, the lower ones lie before it and the higher ones after it
+        size_t below = mid;
+        while((below > 0) && (ranks[below - 1] == k)) {
+            below--;
+        }
+        size_t above = mid + 1;
+        while((above < nranks) && (ranks[above] == k)) {
+            above++;
+        }
+
+        // Recurse into the side with fewer ranks and loop on the other, so that the stack is at most log2 q deep
+        if(below < nranks - above) {
+            select_ranks(data, lo, k, ranks, below);
+            lo      = k + 1;
+            ranks  += above;
+            nranks -= above;
+        }
+        else {
+            select_ranks(data, k + 1, hi, ranks + above, nranks - above);
+            hi     = k;
+            nranks = below;
+        }
     }
 }
 
@@ -52,8 +192,6 @@ int quickselect(int* data, size_t nelements, size_t lo, size_t hi) {
         data[hi]        = data[partition];
         data[partition] = pivot;
 
-        print("During:        ", data, nelements);
-
         // Is the partition at the mid-point?
         if(partition == nelements/2) {
             return data[nelements/2];
@@ -75,15 +213,45 @@ int quickselect(int* data, size_t nelements, size_t lo, size_t hi) {
     }
 }
 
-int main(void) {
-    // Create an array of unsorted data
-    int data[] = { 23, 21, 76, 16, 43, 52, 18 };
-    print("Unsorted:      ", data, NELEMENTS(data));
+// Rearrange an array so that the value at index k is the one that would be there were the array sorted
+void nth_element(int* data, size_t nelements, size_t k) {
+    if((data == NULL) || (k >= nelements)) {
+        return;
+    }
+    floyd_rivest(data, 0, nelements, k);
+}
 
-    // Find the median using the quick select algorithm
-    int median = quickselect(data, NELEMENTS(data), 0, NELEMENTS(data) - 1);
-    print("Partly sorted: ", data, NELEMENTS(data));
-    printf("Median value:  %d\n", median);
+// Find the k-th smallest value in an array
+int select_kth(int* data, size_t nelements, size_t k) {
+    assert((data != NULL) && (k < nelements));
+    nth_element(data, nelements, k);
+    return data[k];
+}
+
+// Rearrange an array so that the value at each of several indices is the one that would be there were the array sorted
+void multi_select(int* data, size_t nelements, const size_t* ranks, size_t nranks) {
+    if((data == NULL) || (ranks == NULL)) {
+        return;
+    }
+    for(size_t i = 0; i < nranks; i++) {
+        if((ranks[i] >= nelements) || ((i > 0) && (ranks[i] < ranks[i - 1]))) {
+            return;
+        }
+    }
+    select_ranks(data, 0, nelements, ranks, nranks);
+}
+
+// Rearrange an array so that the k smallest values are at the start in ascending order
+void partial_sort(int* data, size_t nelements, size_t k) {
+    if((data == NULL) || (k == 0)) {
+        return;
+    }
+    if(k >= nelements) {
+        pdqsort(data, nelements);
+        return;
+    }
 
-    return EXIT_SUCCESS;
+    // The k-th smallest is then in place with the smaller ones before it, which are all that need sorting
+    nth_element(data, nelements, k - 1);
+    pdqsort(data, k - 1);
 }
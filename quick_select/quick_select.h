@@ -0,0 +1,86 @@
+// Find the k-th smallest of an array of values using quickselect
+//
+// This works like quicksort, but only recurses into one side – the side with
+// the element it is searching for - and it can stop as soon as the partition
+// reaches the position it is searching for
+//
+// quickselect is the textbook version, which finds the median pivoting on the rightmost element. Its worst case is
+// O(n^2), which it hits on sorted data.
+//
+// select_kth and nth_element use Floyd-Rivest selection. Before partitioning, it recursively selects from a sample of
+// about n^(2/3) values, gathered from across the range, the value whose rank should fall just short of k. Partitioning
+// around it leaves k on the small side, so the expected number of comparisons is n + min(k, n - k) + o(n). Values
+// equal to the pivot are kept together, so duplicates do not slow it down. If the range fails to halve within two
+// partitions it falls back to the median of medians, whose pivot always leaves at most 7/10 of the range, so the
+// worst case is O(n).
+//
+// multi_select selects several ranks at once e.g. the 50th, 90th, 99th and 99.9th percentiles. It selects the middle
+// rank, then recurses into the values before it for the lower ranks and the values after it for the higher ones, so
+// that q ranks cost O(n log q) rather than the O(n q) of selecting each from the whole array.
+//
+// partial_sort selects the k smallest values and then sorts only those, in O(n + k log k).
+//
+// None of these do any I/O.
+//
+// See https://en.wikipedia.org/wiki/Quickselect
+// See https://en.wikipedia.org/wiki/Floyd%E2%80%93Rivest_algorithm
+// See https://en.wikipedia.org/wiki/Median_of_medians
+// See Musser, "Introspective Sorting and Selection Algorithms"
+
+#ifndef QUICK_SELECT_H
+#define QUICK_SELECT_H
+
+#include <stddef.h> // For size_t
+
+// Find the median of an array of values using textbook quickselect with Lomuto partitioning.
+//
+// Parameters:
+//  data      : pointer to the array of values, which is partly sorted.
+//  nelements : number of values in the array.
+//  lo        : index of the first value to search, 0 to begin with.
+//  hi        : index of the last value to search (inclusive), nelements - 1 to begin with.
+//
+// Returns:
+//  the median i.e. the value at index nelements / 2 were the array sorted.
+int quickselect(int* data, size_t nelements, size_t lo, size_t hi);
+
+// Rearrange an array so that the value at index k is the one that would be there were the array sorted, with no
+// greater values before it and no smaller values after it.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+//  k         : index to select, less than nelements, otherwise the array is left unchanged.
+void nth_element(int* data, size_t nelements, size_t k);
+
+// Find the k-th smallest value (counting from 0) in an array, rearranging it as nth_element does.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+//  k         : index to select, which must be less than nelements.
+//
+// Returns:
+//  the value at index k were the array sorted.
+int select_kth(int* data, size_t nelements, size_t k);
+
+// Rearrange an array so that the value at each of several indices is the one that would be there were the array
+// sorted, as nth_element does for one.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+//  ranks     : pointer to the indices to select, in ascending order (repeats are allowed), each less than nelements.
+//              Otherwise the array is left unchanged.
+//  nranks    : number of indices.
+void multi_select(int* data, size_t nelements, const size_t* ranks, size_t nranks);
+
+// Rearrange an array so that the k smallest values are at the start in ascending order, the rest in no order.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+//  k         : number of values to sort, the whole array if it is nelements or more.
+void partial_sort(int* data, size_t nelements, size_t k);
+
+#endif // QUICK_SELECT_H
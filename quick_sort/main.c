@@ -0,0 +1,344 @@
+// Sort an array of values using quicksort
+//
+// This has an average case performance of O(n log n)
+//
+// The textbook quicksort, introsort and pdqsort are benchmarked against each other,
+// and against the C library's qsort, on several patterns of input with:
+//
+//  ./quick_sort benchmark [number of values]
+//
+// Sorts generated by SORT_DEFINE for 64-bit values and for records sorted by a key are benchmarked against qsort with:
+//
+//  ./quick_sort records [number of records]
+//
+// See https://en.wikipedia.org/wiki/Quicksort
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include <errno.h>          // For errno
+#include <stdbool.h>        // For bool, true, false
+#include <stdint.h>         // For uint32_t, uint64_t
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For EXIT_SUCCESS, EXIT_FAILURE, NULL, malloc, free, qsort, rand, strtoul
+#include <string.h>         // For memcmp, memcpy, strcmp, strerror
+#include <time.h>           // For clock_gettime
+#include "quick_sort.h"     // For quicksort, introsort, pdqsort
+#include "sort_define.h"    // For SORT_DEFINE
+
+#define NELEMENTS(a)    (sizeof(a)/sizeof(a[0]))
+
+// The textbook quicksort is O(n^2) time and O(n) stack on the patterns other
+// than random values, so is not benchmarked on them beyond this many values
+#define QUICKSORT_MAX   20000
+
+// A record sorted by its key, as a database row might be
+typedef struct record_t {
+    uint32_t key;
+    uint32_t id;
+    double   payload;
+} record_t;
+
+// Generate sorts for 64-bit values, doubles and records
+#define VALUE_LESS(a, b)    ((a) < (b))
+#define RECORD_LESS(a, b)   ((a).key < (b).key)
+SORT_DEFINE(u64, uint64_t, VALUE_LESS)
+SORT_DEFINE(double, double, VALUE_LESS)
+SORT_DEFINE(record, record_t, RECORD_LESS)
+
+// Patterns of input for the benchmark
+typedef enum pattern_t {
+    RANDOM,         // uniformly random values
+    SORTED,         // already in ascending order
+    REVERSED,       // in descending order
+    ORGAN_PIPE,     // ascending then descending
+    DUPLICATES,     // random values from only a few distinct ones
+    NPATTERNS
+} pattern_t;
+
+// Print an array of values
+void print(const char* msg, const int *data, size_t nelements) {
+    if(data != NULL) {
+        printf("%s", msg);
+        for(size_t i = 0; i < nelements; i++) {
+            printf("%2d ", data[i]);
+        }
+        printf("\n");
+    }
+    else {
+        printf("Bad arguments!\n");
+    }
+}
+
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Comparison function for qsort
+int compare(const void* a, const void* b) {
+    const int x = *(const int*)a;
+    const int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Comparison function for qsort of 64-bit values
+int compare_u64(const void* a, const void* b) {
+    const uint64_t x = *(const uint64_t*)a;
+    const uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Comparison function for qsort of records
+int compare_record(const void* a, const void* b) {
+    const uint32_t x = ((const record_t*)a)->key;
+    const uint32_t y = ((const record_t*)b)->key;
+    return (x > y) - (x < y);
+}
+
+// Get a random 64-bit value
+uint64_t rand_u64(void) {
+    return ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^ (uint64_t)rand();
+}
+
+// Fill an array with a pattern of values
+void fill(int* data, size_t nelements, pattern_t pattern) {
+    for(size_t i = 0; i < nelements; i++) {
+        switch(pattern) {
+            case RANDOM:     data[i] = rand() - RAND_MAX / 2;                                   break;
+            case SORTED:     data[i] = (int)i;                                                  break;
+            case REVERSED:   data[i] = (int)(nelements - i);                                    break;
+            case ORGAN_PIPE: data[i] = (int)((i < nelements / 2) ? i : nelements - i);          break;
+            default:         data[i] = rand() % 16;                                             break;
+        }
+    }
+}
+
+// Get the name of a pattern
+const char* pattern_name(pattern_t pattern) {
+    static const char* names[NPATTERNS] = { "random", "sorted", "reversed", "organ pipe", "duplicates" };
+    return names[pattern];
+}
+
+// Benchmark the sorts on each pattern, reporting millions of values sorted per second
+int benchmark(size_t nelements) {
+    int* data     = malloc(nelements * sizeof(int));
+    int* original = malloc(nelements * sizeof(int));
+    int* expected = malloc(nelements * sizeof(int));
+    if((data == NULL) || (original == NULL) || (expected == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(data); free(original); free(expected);
+        return EXIT_FAILURE;
+    }
+
+    printf("%zu values, millions sorted per second\n", nelements);
+    printf("%-12s %12s %12s %12s %12s\n", "pattern", "qsort", "quicksort", "introsort", "pdqsort");
+    bool passed = true;
+    for(pattern_t pattern = 0; pattern < NPATTERNS; pattern++) {
+        fill(original, nelements, pattern);
+        printf("%-12s ", pattern_name(pattern));
+
+        memcpy(expected, original, nelements * sizeof(int));
+        double start = now();
+        qsort(expected, nelements, sizeof(int), compare);
+        printf("%12.2f ", nelements / (now() - start) / 1e6);
+
+        if((pattern == RANDOM) || (nelements <= QUICKSORT_MAX)) {
+            memcpy(data, original, nelements * sizeof(int));
+            start = now();
+            quicksort(data, 0, nelements - 1);
+            printf("%12.2f ", nelements / (now() - start) / 1e6);
+        }
+        else {
+            printf("%12s ", "-");
+        }
+
+        memcpy(data, original, nelements * sizeof(int));
+        start = now();
+        introsort(data, nelements);
+        double rate = nelements / (now() - start) / 1e6;
+        bool   ok   = (memcmp(data, expected, nelements * sizeof(int)) == 0);
+        printf("%12.2f%s ", rate, ok ? "" : " FAILED");
+        passed = passed && ok;
+
+        memcpy(data, original, nelements * sizeof(int));
+        start = now();
+        pdqsort(data, nelements);
+        rate = nelements / (now() - start) / 1e6;
+        ok   = (memcmp(data, expected, nelements * sizeof(int)) == 0);
+        printf("%12.2f%s\n", rate, ok ? "" : " FAILED");
+        passed = passed && ok;
+        fflush(stdout);
+    }
+
+    free(data); free(original); free(expected);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Benchmark the generated sorts against qsort on random 64-bit values and records, reporting millions sorted per second
+int benchmark_records(size_t nelements) {
+    uint64_t* values   = malloc(nelements * sizeof(uint64_t));
+    uint64_t* values2  = malloc(nelements * sizeof(uint64_t));
+    record_t* records  = malloc(nelements * sizeof(record_t));
+    record_t* records2 = malloc(nelements * sizeof(record_t));
+    if((values == NULL) || (values2 == NULL) || (records == NULL) || (records2 == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(values); free(values2); free(records); free(records2);
+        return EXIT_FAILURE;
+    }
+
+    for(size_t i = 0; i < nelements; i++) {
+        values[i]  = rand_u64();
+        records[i] = (record_t){ (uint32_t)rand_u64(), (uint32_t)i, (double)i };
+    }
+    memcpy(values2, values, nelements * sizeof(uint64_t));
+    memcpy(records2, records, nelements * sizeof(record_t));
+
+    printf("%zu values, millions sorted per second\n", nelements);
+    printf("%-12s %12s %12s\n", "type", "qsort", "SORT_DEFINE");
+
+    double start = now();
+    qsort(values, nelements, sizeof(uint64_t), compare_u64);
+    printf("%-12s %12.2f ", "uint64_t", nelements / (now() - start) / 1e6);
+    start = now();
+    sort_u64(values2, nelements);
+    double     rate   = nelements / (now() - start) / 1e6;
+    const bool passed = (memcmp(values, values2, nelements * sizeof(uint64_t)) == 0);
+    printf("%12.2f%s\n", rate, passed ? "" : " FAILED");
+
+    start = now();
+    qsort(records, nelements, sizeof(record_t), compare_record);
+    printf("%-12s %12.2f ", "record_t", nelements / (now() - start) / 1e6);
+    start = now();
+    sort_record(records2, nelements);
+    rate = nelements / (now() - start) / 1e6;
+
+    bool ok = true;
+    for(size_t i = 0; i < nelements; i++) {
+        ok = ok && (records[i].key == records2[i].key);
+    }
+    printf("%12.2f%s\n", rate, ok ? "" : " FAILED");
+
+    free(values); free(values2); free(records); free(records2);
+    return (passed && ok) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Verify the generated sorts of 64-bit values and records against qsort, for a range of sizes including those around
+// the insertion sort and ninther cutoffs. Records have few distinct keys, so each id must still appear exactly once.
+bool verify_generated(void) {
+    static const size_t sizes[] = { 0, 1, 2, 3, 15, 16, 17, 100, 128, 129, 1000, 54321 };
+
+    for(size_t s = 0; s < NELEMENTS(sizes); s++) {
+        const size_t n        = sizes[s];
+        uint64_t*    values   = malloc((n + 1) * sizeof(uint64_t));
+        uint64_t*    values2  = malloc((n + 1) * sizeof(uint64_t));
+        record_t*    records  = malloc((n + 1) * sizeof(record_t));
+        record_t*    records2 = malloc((n + 1) * sizeof(record_t));
+        bool*        seen     = calloc(n + 1, sizeof(bool));
+        bool         ok       = false;
+        if((values != NULL) && (values2 != NULL) && (records != NULL) && (records2 != NULL) && (seen != NULL)) {
+            for(size_t i = 0; i < n; i++) {
+                values[i]  = rand_u64();
+                records[i] = (record_t){ (uint32_t)(rand() % 16), (uint32_t)i, (double)i };
+            }
+            memcpy(values2, values, n * sizeof(uint64_t));
+            memcpy(records2, records, n * sizeof(record_t));
+            qsort(values, n, sizeof(uint64_t), compare_u64);
+            qsort(records, n, sizeof(record_t), compare_record);
+            sort_u64(values2, n);
+            sort_record(records2, n);
+
+            ok = (memcmp(values, values2, n * sizeof(uint64_t)) == 0);
+            for(size_t i = 0; ok && (i < n); i++) {
+                ok = (records[i].key == records2[i].key) && (records2[i].id < n) && !seen[records2[i].id];
+                seen[records2[i].id] = true;
+            }
+        }
+        free(values); free(values2); free(records); free(records2); free(seen);
+
+        if(!ok) {
+            printf("Mismatch for %zu generated values\n", n);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Verify introsort and pdqsort against qsort, for every pattern and a range of
+// sizes including those around the insertion sort and ninther cutoffs
+bool verify(void) {
+    static const size_t sizes[] = { 1, 2, 3, 15, 16, 17, 100, 128, 129, 1000, 54321 };
+
+    for(size_t s = 0; s < NELEMENTS(sizes); s++) {
+        for(pattern_t pattern = 0; pattern < NPATTERNS; pattern++) {
+            const size_t n        = sizes[s];
+            int*         data     = malloc(n * sizeof(int));
+            int*         data2    = malloc(n * sizeof(int));
+            int*         expected = malloc(n * sizeof(int));
+            bool         ok       = false;
+            if((data != NULL) && (data2 != NULL) && (expected != NULL)) {
+                fill(data, n, pattern);
+                memcpy(data2, data, n * sizeof(int));
+                memcpy(expected, data, n * sizeof(int));
+                qsort(expected, n, sizeof(int), compare);
+                introsort(data, n);
+                pdqsort(data2, n);
+                ok = (memcmp(data, expected, n * sizeof(int)) == 0) &&
+                     (memcmp(data2, expected, n * sizeof(int)) == 0);
+            }
+            free(data); free(data2); free(expected);
+
+            if(!ok) {
+                printf("Mismatch for %zu %s values\n", n, pattern_name(pattern));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    // Benchmark the sorts rather than demonstrating them?
+    if((argc > 1) && (strcmp(argv[1], "benchmark") == 0)) {
+        size_t nelements = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10000000;
+        return (nelements > 0) ? benchmark(nelements) : EXIT_FAILURE;
+    }
+    if((argc > 1) && (strcmp(argv[1], "records") == 0)) {
+        size_t nelements = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10000000;
+        return (nelements > 0) ? benchmark_records(nelements) : EXIT_FAILURE;
+    }
+
+    // Create an array of unsorted data
+    int data[] = { 23, 21, 76, 16, 52, 43 };
+    print("Unsorted: ", data, NELEMENTS(data));
+
+    // Sort the data
+    quicksort(data, 0, NELEMENTS(data) - 1);
+    print("Sorted:   ", data, NELEMENTS(data));
+
+    // Sort the same data with introsort
+    int data2[] = { 23, 21, 76, 16, 52, 43 };
+    introsort(data2, NELEMENTS(data2));
+    print("Introsort:", data2, NELEMENTS(data2));
+
+    // Sort the same data with pdqsort
+    int data3[] = { 23, 21, 76, 16, 52, 43 };
+    pdqsort(data3, NELEMENTS(data3));
+    print("pdqsort:  ", data3, NELEMENTS(data3));
+
+    // Sort doubles with a sort generated by SORT_DEFINE
+    double data4[] = { 2.5, -1.0, 76.25, 16.0, 0.5, 43.0 };
+    sort_double(data4, NELEMENTS(data4));
+    printf("Doubles:   ");
+    for(size_t i = 0; i < NELEMENTS(data4); i++) {
+        printf("%g ", data4[i]);
+    }
+    printf("\n");
+
+    // Verify introsort, pdqsort and the generated sorts against qsort
+    const bool ok = verify() && verify_generated();
+    printf("\nVerify against qsort: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -3,11 +3,37 @@
 // This has an average case performance of O(n log n)
 //
 // See https://en.wikipedia.org/wiki/Quicksort
+// See Musser, "Introspective Sorting and Selection Algorithms"
+// See Peters, "Pattern-defeating Quicksort"
+// See Edelkamp and Weiß, "BlockQuicksort: Avoiding Branch Mispredictions in Quicksort"
 
-#include <stdio.h>  // For printf
-#include <stdlib.h> // For EXIT_SUCCESS, NULL
+#include <stdbool.h>        // For bool, true, false
+#include <stddef.h>         // For size_t
+#include "insertion_sort.h" // For small_sort, SMALL_SORT_MAX
+#include "quick_sort.h"     // This module
+#include "sort_define.h"    // For SORT_DEFINE_SMALL
 
-#define NELEMENTS(a)    (sizeof(a)/sizeof(a[0]))
+// Ranges of more than this many values pick the pivot with a ninther rather than a median of 3
+#define NINTHER_CUTOFF      SORT_NINTHER_CUTOFF
+
+
+// Number of values whose comparisons are buffered at a time by pdqsort's block partitioning
+#define PDQ_BLOCK               64
+
+// Maximum number of values that pdqsort's partial insertion sort moves before giving up
+#define PDQ_PARTIAL_LIMIT       8
+
+// Generate introsort, insertion sort and heapsort for int values, with the comparison inlined and small ranges finished
+// with a sorting network
+#define INT_LESS(a, b)  ((a) < (b))
+SORT_DEFINE_SMALL(int, int, INT_LESS, small_sort, SMALL_SORT_MAX)
+
+// Swap two values
+static inline void swap(int* a, int* b) {
+    int temp = *a;
+    *a       = *b;
+    *b       = temp;
+}
 
 // Sort an array of values using quicksort
 void quicksort(int* data, size_t lo, size_t hi) {
@@ -42,28 +68,310 @@ void quicksort(int* data, size_t lo, size_t hi) {
     }
 }
 
-// Print an array of values
-void print(const char* msg, const int *data, size_t nelements) {
-    if(data != NULL) {
-        printf("%s", msg);
-        for(size_t i = 0; i < nelements; i++) {
-            printf("%2d ", data[i]);
+// Sort an array of values using introsort
+void introsort(int* data, size_t nelements) {
+    if((data == NULL) || (nelements < 2)) {
+        return;
+    }
+    sort_int(data, nelements);
+}
+
+// Sort two values in place
+static inline void sort2(int* a, int* b) {
+    if(*b < *a) {
+        swap(a, b);
+    }
+}
+
+// Sort three values in place
+static inline void sort3(int* a, int* b, int* c) {
+    sort2(a, b);
+    sort2(b, c);
+    sort2(a, b);
+}
+
+// Insertion sort a range, giving up if more than a few values have to be moved
+//
+// Returns true if the range is sorted.
+static bool partial_insertion_sort(int* begin, int* end) {
+    size_t moved = 0;
+    for(int* cur = begin + 1; cur < end; cur++) {
+        if(*cur < cur[-1]) {
+            int  value = *cur;
+            int* sift  = cur;
+            do {
+                *sift = sift[-1];
+                sift--;
+            } while((sift > begin) && (value < sift[-1]));
+            *sift  = value;
+            moved += (size_t)(cur - sift);
+        }
+        if(moved > PDQ_PARTIAL_LIMIT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Swap the values at pairs of offsets from the left and right bases
+//
+// If there are as many on each side, they are swapped pairwise. Otherwise a cyclic permutation does the same with one
+// move per value rather than three.
+static inline void swap_offsets(int* left, int* right, const unsigned char* offsets_l, const unsigned char* offsets_r,
+                                size_t num, bool use_swaps) {
+    if(use_swaps) {
+        for(size_t i = 0; i < num; i++) {
+            swap(left + offsets_l[i], right - offsets_r[i]);
+        }
+    }
+    else if(num > 0) {
+        int* l    = left + offsets_l[0];
+        int* r    = right - offsets_r[0];
+        int  temp = *l;
+        *l = *r;
+        for(size_t i = 1; i < num; i++) {
+            l  = left + offsets_l[i];
+            *r = *l;
+            r  = right - offsets_r[i];
+            *l = *r;
+        }
+        *r = temp;
+    }
+}
+
+// Partition around the first value, with values equal to the pivot going to the right, returning its final position
+//
+// Rather than branching on each comparison, which mispredicts half the time on random data, blocks of values are
+// compared and the offsets of those on the wrong side are recorded without branches. The recorded values are then
+// swapped in a batch.
+//
+// already_partitioned is set if no values had to be swapped.
+static int* partition_right(int* begin, int* end, bool* already_partitioned) {
+    const int pivot = *begin;
+    int*      first = begin;
+    int*      last  = end;
+
+    // Find the first value no less than the pivot, which the median of 3 guarantees before the end
+    while(*++first < pivot) {
+    }
+
+    // Find the last value less than the pivot, bounded if there was nothing less than the pivot to stop the scan
+    if(first - 1 == begin) {
+        while((first < last) && !(*--last < pivot)) {
+        }
+    }
+    else {
+        while(!(*--last < pivot)) {
+        }
+    }
+
+    *already_partitioned = (first >= last);
+    if(!*already_partitioned) {
+        swap(first, last);
+        first++;
+
+        unsigned char offsets_l[PDQ_BLOCK];
+        unsigned char offsets_r[PDQ_BLOCK];
+        int*          base_l  = first;
+        int*          base_r  = last;
+        size_t        num_l   = 0;
+        size_t        num_r   = 0;
+        size_t        start_l = 0;
+        size_t        start_r = 0;
+        while(first < last) {
+            // Refill whichever buffers are empty, splitting what is left between them
+            const size_t unknown = (size_t)(last - first);
+            const size_t split_l = (num_l == 0) ? ((num_r == 0) ? unknown / 2 : unknown) : 0;
+            const size_t split_r = (num_r == 0) ? unknown - split_l : 0;
+
+            const size_t block_l = (split_l < PDQ_BLOCK) ? split_l : PDQ_BLOCK;
+            for(size_t i = 0; i < block_l; i++) {
+                offsets_l[num_l] = (unsigned char)i;
+                num_l += !(*first < pivot);
+                first++;
+            }
+            const size_t block_r = (split_r < PDQ_BLOCK) ? split_r : PDQ_BLOCK;
+            for(size_t i = 1; i <= block_r; i++) {
+                offsets_r[num_r] = (unsigned char)i;
+                num_r += (*--last < pivot);
+            }
+
+            // Swap as many pairs as both sides have
+            const size_t num = (num_l < num_r) ? num_l : num_r;
+            swap_offsets(base_l, base_r, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+            num_l   -= num;
+            num_r   -= num;
+            start_l += num;
+            start_r += num;
+            if(num_l == 0) {
+                start_l = 0;
+                base_l  = first;
+            }
+            if(num_r == 0) {
+                start_r = 0;
+                base_r  = last;
+            }
+        }
+
+        // Move the values left over on one side to the boundary
+        if(num_l > 0) {
+            while(num_l > 0) {
+                num_l--;
+                swap(base_l + offsets_l[start_l + num_l], --last);
+            }
+            first = last;
+        }
+        if(num_r > 0) {
+            while(num_r > 0) {
+                num_r--;
+                swap(base_r - offsets_r[start_r + num_r], first);
+                first++;
+            }
+        }
+    }
+
+    // Put the pivot between the partitions
+    int* pivot_pos = first - 1;
+    *begin     = *pivot_pos;
+    *pivot_pos = pivot;
+    return pivot_pos;
+}
+
+// Partition around the first value, with values equal to the pivot going to the left, returning its final position
+//
+// This is used when the pivot equals the value preceding the range, which is no greater than any in it. So the left
+// partition holds only values equal to the pivot, and needs no further sorting.
+static int* partition_left(int* begin, int* end) {
+    const int pivot = *begin;
+    int*      first = begin;
+    int*      last  = end;
+
+    while(pivot < *--last) {
+    }
+    if(last + 1 == end) {
+        while((first < last) && !(pivot < *++first)) {
         }
-        printf("\n");
     }
     else {
-        printf("Bad arguments!\n");
+        while(!(pivot < *++first)) {
+        }
+    }
+
+    while(first < last) {
+        swap(first, last);
+        while(pivot < *--last) {
+        }
+        while(!(pivot < *++first)) {
+        }
     }
+
+    int* pivot_pos = last;
+    *begin     = *pivot_pos;
+    *pivot_pos = pivot;
+    return pivot_pos;
 }
 
-int main(void) {
-    // Create an array of unsorted data
-    int data[] = { 23, 21, 76, 16, 52, 43 };
-    print("Unsorted: ", data, NELEMENTS(data));
+// Shuffle a few values around after an unbalanced partition, to break up patterns that could keep it unbalanced
+//
+// Sides small enough for small_sort will not be partitioned again, so are left alone.
+static void break_patterns(int* begin, int* pivot_pos, int* end) {
+    const size_t size_l = (size_t)(pivot_pos - begin);
+    const size_t size_r = (size_t)(end - (pivot_pos + 1));
+    if(size_l > SMALL_SORT_MAX) {
+        swap(begin,         begin + size_l/4);
+        swap(pivot_pos - 1, pivot_pos - size_l/4);
+        if(size_l > NINTHER_CUTOFF) {
+            swap(begin + 1,     begin + (size_l/4 + 1));
+            swap(begin + 2,     begin + (size_l/4 + 2));
+            swap(pivot_pos - 2, pivot_pos - (size_l/4 + 1));
+            swap(pivot_pos - 3, pivot_pos - (size_l/4 + 2));
+        }
+    }
+    if(size_r > SMALL_SORT_MAX) {
+        swap(pivot_pos + 1, pivot_pos + (1 + size_r/4));
+        swap(end - 1,       end - size_r/4);
+        if(size_r > NINTHER_CUTOFF) {
+            swap(pivot_pos + 2, pivot_pos + (2 + size_r/4));
+            swap(pivot_pos + 3, pivot_pos + (3 + size_r/4));
+            swap(end - 2,       end - (1 + size_r/4));
+            swap(end - 3,       end - (2 + size_r/4));
+        }
+    }
+}
+
+// Sort a range with pdqsort, with a budget of unbalanced partitions before falling back to heapsort
+//
+// leftmost is set if the range is not preceded by a value from an earlier partition.
+static void pdqsort_loop(int* begin, int* end, size_t bad_allowed, bool leftmost) {
+    for(;;) {
+        const size_t size = (size_t)(end - begin);
+        if(size <= SMALL_SORT_MAX) {
+            small_sort(begin, size);
+            return;
+        }
+
+        // Move the median of 3, or the ninther, to the start
+        const size_t half = size / 2;
+        if(size > NINTHER_CUTOFF) {
+            sort3(begin,            begin + half,     end - 1);
+            sort3(begin + 1,        begin + half - 1, end - 2);
+            sort3(begin + 2,        begin + half + 1, end - 3);
+            sort3(begin + half - 1, begin + half,     begin + half + 1);
+            swap(begin, begin + half);
+        }
+        else {
+            sort3(begin + half, begin, end - 1);
+        }
+
+        // If the pivot equals the value preceding the range, there are many equal values. Put them all on the left,
+        // where they are done, and carry on with the right.
+        if(!leftmost && !(begin[-1] < *begin)) {
+            begin = partition_left(begin, end) + 1;
+            continue;
+        }
+
+        bool         already_partitioned;
+        int*         pivot_pos = partition_right(begin, end, &already_partitioned);
+        const size_t size_l    = (size_t)(pivot_pos - begin);
+        const size_t size_r    = (size_t)(end - (pivot_pos + 1));
 
-    // Sort the data
-    quicksort(data, 0, NELEMENTS(data) - 1);
-    print("Sorted:   ", data, NELEMENTS(data));
+        if((size_l < size / 8) || (size_r < size / 8)) {
+            // Too many unbalanced partitions, and the data is adversarial
+            if(--bad_allowed == 0) {
+                sort_heap_int(begin, size);
+                return;
+            }
+            break_patterns(begin, pivot_pos, end);
+        }
+        else if(already_partitioned && partial_insertion_sort(begin, pivot_pos) &&
+                partial_insertion_sort(pivot_pos + 1, end)) {
+            // Nothing was swapped and both sides were (nearly) sorted, so the range probably was
+            return;
+        }
 
-    return EXIT_SUCCESS;
+        // Recurse into the smaller side and loop on the larger, so that the stack is at most log2 n deep
+        if(size_l < size_r) {
+            pdqsort_loop(begin, pivot_pos, bad_allowed, leftmost);
+            begin    = pivot_pos + 1;
+            leftmost = false;
+        }
+        else {
+            pdqsort_loop(pivot_pos + 1, end, bad_allowed, false);
+            end = pivot_pos;
+        }
+    }
+}
+
+// Sort an array of values using pattern-defeating quicksort
+void pdqsort(int* data, size_t nelements) {
+    if((data == NULL) || (nelements < 2)) {
+        return;
+    }
+
+    // Allow log2 n unbalanced partitions
+    size_t bad_allowed = 0;
+    for(size_t n = nelements; n > 0; n >>= 1) {
+        bad_allowed++;
+    }
+    pdqsort_loop(data, data + nelements, bad_allowed, true);
 }
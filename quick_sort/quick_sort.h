@@ -0,0 +1,52 @@
+// Sort an array of values using quicksort
+//
+// This has an average case performance of O(n log n)
+//
+// quicksort is the textbook version, which pivots on the rightmost element. Its worst case is O(n^2) time and O(n)
+// stack, which it hits on sorted, reversed or repetitive data.
+//
+// introsort is the production version. It picks the pivot as the median of 3 (or, for larger ranges, the median of
+// the medians of 3 samples of 3, Tukey's ninther), partitions with Hoare's scheme, and only recurses into the smaller
+// side so that the stack is O(log n). Small ranges are finished with small_sort (a sorting network where the CPU has
+// AVX2), and if the recursion gets too deep (2 log2 n levels) the range is heapsorted instead, so the worst case is
+// O(n log n).
+//
+// pdqsort is pattern-defeating quicksort, which builds on introsort. It partitions blocks of values without branching
+// on the comparisons, so that random data does not cost a branch misprediction per value. It also spots ranges that
+// were already partitioned (and so probably sorted) and finishes them with a bounded insertion sort, puts runs of
+// values equal to the pivot to one side in a single pass, and shuffles a few values after an unbalanced partition to
+// defeat adversarial patterns. The worst case is O(n log n), falling back to heapsort like introsort.
+//
+// See https://en.wikipedia.org/wiki/Quicksort
+// See Musser, "Introspective Sorting and Selection Algorithms"
+// See Peters, "Pattern-defeating Quicksort"
+// See Edelkamp and Weiß, "BlockQuicksort: Avoiding Branch Mispredictions in Quicksort"
+
+#ifndef QUICK_SORT_H
+#define QUICK_SORT_H
+
+#include <stddef.h> // For size_t
+
+// Sort an array of values using textbook quicksort with Lomuto partitioning.
+//
+// Parameters:
+//  data : pointer to the array of values.
+//  lo   : index of the first value to sort.
+//  hi   : index of the last value to sort (inclusive).
+void quicksort(int* data, size_t lo, size_t hi);
+
+// Sort an array of values using introsort.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+void introsort(int* data, size_t nelements);
+
+// Sort an array of values using pattern-defeating quicksort (pdqsort), with branchless block partitioning.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+void pdqsort(int* data, size_t nelements);
+
+#endif // QUICK_SORT_H
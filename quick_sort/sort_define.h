@@ -0,0 +1,186 @@
+// Generate sort functions specialised on an element type and a comparison
+//
+// qsort and insertion_sort take a comparison function pointer, so every comparison is an indirect call that cannot be
+// inlined, and qsort also moves elements of unknown size byte by byte. Instead, SORT_DEFINE generates the functions
+// for one element type and one comparison, which the compiler inlines, for example:
+//
+//  #define u64_less(a, b)  ((a) < (b))
+//  SORT_DEFINE(u64, uint64_t, u64_less)
+//
+//  #define by_key(a, b)    ((a).key < (b).key)
+//  SORT_DEFINE(record, record_t, by_key)
+//
+// generate sort_u64(uint64_t* data, size_t nelements) and sort_record(record_t* data, size_t nelements), along with
+// sort_insertion_<name> and sort_heap_<name>. The comparison is given two elements by value and returns whether the
+// first should sort before the second. It may be a macro or a (static inline) function. Note that there is no
+// semicolon after SORT_DEFINE.
+//
+// SORT_DEFINE_SMALL also takes the function that finishes small ranges and the size of range at or below which it is
+// used, for example a sorting network. SORT_DEFINE uses the generated insertion sort on ranges of up to 16 elements.
+//
+// sort_<name> is the introsort of quick_sort.h: the pivot is the median of 3 (or the ninther for larger ranges), Hoare
+// partitioning splits equal elements evenly, only the smaller side is recursed into, small ranges are finished with
+// insertion sort and ranges that recurse too deeply are heapsorted. It is not stable.
+//
+// See Musser, "Introspective Sorting and Selection Algorithms"
+
+#ifndef SORT_DEFINE_H
+#define SORT_DEFINE_H
+
+#include <stddef.h> // For size_t
+
+// Ranges of up to this many elements are finished with insertion sort by SORT_DEFINE
+#define SORT_INSERTION_CUTOFF   16
+
+// Ranges of more than this many elements pick the pivot with a ninther rather than a median of 3
+#define SORT_NINTHER_CUTOFF     128
+
+// Generate the sort functions for an element type and comparison.
+//
+// Parameters:
+//  name : suffix of the function names e.g. u64.
+//  type : element type e.g. uint64_t.
+//  less : comparison, less(a, b) being true if a sorts before b.
+#define SORT_DEFINE(name, type, less)                                                                                  \
+    SORT_DEFINE_SMALL(name, type, less, sort_insertion_##name, SORT_INSERTION_CUTOFF)
+
+// Generate the sort functions for an element type and comparison, finishing small ranges with the given function.
+//
+// Parameters:
+//  name   : suffix of the function names e.g. u64.
+//  type   : element type e.g. uint64_t.
+//  less   : comparison, less(a, b) being true if a sorts before b.
+//  small  : function or macro small(type* data, size_t nelements) that sorts a range of up to cutoff elements.
+//  cutoff : number of elements in a range at or below which small is used.
+#define SORT_DEFINE_SMALL(name, type, less, small, cutoff)                                                             \
+                                                                                                                       \
+/* Swap two elements */                                                                                                \
+static inline void sort_swap_##name(type* a, type* b) {                                                                \
+    type temp = *a;                                                                                                    \
+    *a        = *b;                                                                                                    \
+    *b        = temp;                                                                                                  \
+}                                                                                                                      \
+                                                                                                                       \
+/* Insertion sort, moving one element at a time */                                                                     \
+static inline void sort_insertion_##name(type* data, size_t nelements) {                                              \
+    for(size_t j = 1; j < nelements; j++) {                                                                            \
+        type   value = data[j];                                                                                        \
+        size_t i     = j;                                                                                              \
+        while((i > 0) && less(value, data[i - 1])) {                                                                   \
+            data[i] = data[i - 1];                                                                                     \
+            i--;                                                                                                       \
+        }                                                                                                              \
+        data[i] = value;                                                                                               \
+    }                                                                                                                  \
+}                                                                                                                      \
+                                                                                                                       \
+/* Sift an element down a heap whose root sorts last */                                                                \
+static inline void sort_sift_##name(type* data, size_t root, size_t nelements) {                                      \
+    type value = data[root];                                                                                           \
+    for(;;) {                                                                                                          \
+        size_t child = 2*root + 1;                                                                                     \
+        if(child >= nelements) {                                                                                       \
+            break;                                                                                                     \
+        }                                                                                                              \
+        if((child + 1 < nelements) && less(data[child], data[child + 1])) {                                            \
+            child++;                                                                                                   \
+        }                                                                                                              \
+        if(!less(value, data[child])) {                                                                                \
+            break;                                                                                                     \
+        }                                                                                                              \
+        data[root] = data[child];                                                                                      \
+        root       = child;                                                                                            \
+    }                                                                                                                  \
+    data[root] = value;                                                                                                \
+}                                                                                                                      \
+                                                                                                                       \
+/* Heapsort, which is O(n log n) whatever the data */                                                                  \
+static inline void sort_heap_##name(type* data, size_t nelements) {                                                   \
+    for(size_t i = nelements / 2; i > 0; i--) {                                                                        \
+        sort_sift_##name(data, i - 1, nelements);                                                                      \
+    }                                                                                                                  \
+    for(size_t end = nelements; end > 1; end--) {                                                                      \
+        sort_swap_##name(&data[0], &data[end - 1]);                                                                    \
+        sort_sift_##name(data, 0, end - 1);                                                                            \
+    }                                                                                                                  \
+}                                                                                                                      \
+                                                                                                                       \
+/* Get the index of the median of three elements */                                                                    \
+static inline size_t sort_median3_##name(const type* data, size_t a, size_t b, size_t c) {                            \
+    if(less(data[a], data[b])) {                                                                                       \
+        return less(data[b], data[c]) ? b : (less(data[a], data[c]) ? c : a);                                          \
+    }                                                                                                                  \
+    else {                                                                                                             \
+        return less(data[a], data[c]) ? a : (less(data[b], data[c]) ? c : b);                                         \
+    }                                                                                                                  \
+}                                                                                                                      \
+                                                                                                                       \
+/* Partition around the median of 3 or the ninther using Hoare partitioning, returning the pivot's final index */      \
+static inline size_t sort_partition_##name(type* data, size_t nelements) {                                            \
+    const size_t mid  = nelements / 2;                                                                                 \
+    const size_t last = nelements - 1;                                                                                 \
+    size_t       chosen;                                                                                               \
+    if(nelements > SORT_NINTHER_CUTOFF) {                                                                              \
+        const size_t step = nelements / 8;                                                                             \
+        chosen = sort_median3_##name(data, sort_median3_##name(data, 0, step, 2*step),                                 \
+                                           sort_median3_##name(data, mid - step, mid, mid + step),                     \
+                                           sort_median3_##name(data, last - 2*step, last - step, last));               \
+    }                                                                                                                  \
+    else {                                                                                                             \
+        chosen = sort_median3_##name(data, 0, mid, last);                                                              \
+    }                                                                                                                  \
+    sort_swap_##name(&data[0], &data[chosen]);                                                                         \
+                                                                                                                       \
+    const type pivot = data[0];                                                                                        \
+    size_t     i     = 0;                                                                                              \
+    size_t     j     = nelements;                                                                                      \
+    for(;;) {                                                                                                          \
+        do {                                                                                                           \
+            i++;                                                                                                       \
+        } while((i < nelements) && less(data[i], pivot));                                                              \
+        do {                                                                                                           \
+            j--;                                                                                                       \
+        } while(less(pivot, data[j]));                                                                                 \
+        if(i >= j) {                                                                                                   \
+            break;                                                                                                     \
+        }                                                                                                              \
+        sort_swap_##name(&data[i], &data[j]);                                                                          \
+    }                                                                                                                  \
+    sort_swap_##name(&data[0], &data[j]);                                                                              \
+    return j;                                                                                                          \
+}                                                                                                                      \
+                                                                                                                       \
+/* Introsort a range, with a budget of partitioning levels before falling back to heapsort */                          \
+static void sort_loop_##name(type* data, size_t nelements, size_t depth) {                                             \
+    while(nelements > (cutoff)) {                                                                                      \
+        if(depth == 0) {                                                                                               \
+            sort_heap_##name(data, nelements);                                                                         \
+            return;                                                                                                    \
+        }                                                                                                              \
+        depth--;                                                                                                       \
+                                                                                                                       \
+        const size_t p     = sort_partition_##name(data, nelements);                                                   \
+        const size_t right = nelements - p - 1;                                                                        \
+        if(p < right) {                                                                                                \
+            sort_loop_##name(data, p, depth);                                                                          \
+            data      += p + 1;                                                                                        \
+            nelements  = right;                                                                                        \
+        }                                                                                                              \
+        else {                                                                                                         \
+            sort_loop_##name(data + p + 1, right, depth);                                                              \
+            nelements  = p;                                                                                            \
+        }                                                                                                              \
+    }                                                                                                                  \
+    small(data, nelements);                                                                                            \
+}                                                                                                                      \
+                                                                                                                       \
+/* Sort an array of elements using introsort */                                                                        \
+static inline void sort_##name(type* data, size_t nelements) {                                                         \
+    size_t depth = 0;                                                                                                  \
+    for(size_t n = nelements; n > 1; n >>= 1) {                                                                        \
+        depth += 2;                                                                                                    \
+    }                                                                                                                  \
+    sort_loop_##name(data, nelements, depth);                                                                          \
+}
+
+#endif // SORT_DEFINE_H
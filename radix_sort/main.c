@@ -0,0 +1,152 @@
+// Sort an array of int values using radix sort
+//
+// The radix sorts are benchmarked against the comparison sorts in quick_sort,
+// over a range of sizes, with:
+//
+//  ./radix_sort benchmark [max number of values]
+//
+// See https://en.wikipedia.org/wiki/Radix_sort
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include <errno.h>          // For errno
+#include <stdbool.h>        // For bool, true, false
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For EXIT_SUCCESS, EXIT_FAILURE, NULL, malloc, free, qsort, rand, strtoul
+#include <string.h>         // For memcmp, memcpy, strcmp, strerror
+#include <time.h>           // For clock_gettime
+#include "quick_sort.h"     // For introsort, pdqsort
+#include "radix_sort.h"     // For radix_sort, radix_sort_lsd, radix_sort_msd
+
+#define NELEMENTS(a)    (sizeof(a)/sizeof(a[0]))
+
+// Print an array of values
+void print(const char* msg, const int *data, size_t nelements) {
+    printf("%s", msg);
+    for(size_t i = 0; i < nelements; i++) {
+        printf("%3d ", data[i]);
+    }
+    printf("\n");
+}
+
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Comparison function for qsort
+int compare(const void* a, const void* b) {
+    const int x = *(const int*)a;
+    const int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Utility function to get a random value over the whole range of int
+int random_int(void) {
+    return (int)(((unsigned)rand() << 16) ^ (unsigned)rand());
+}
+
+// Verify the radix sorts against qsort, on sizes around the cutoffs and on
+// values over the whole range, over a small range and all equal
+bool verify(void) {
+    static const size_t sizes[] = { 1, 2, 63, 64, 65, 255, 256, 1000, 65537, 300000 };
+
+    for(size_t s = 0; s < NELEMENTS(sizes); s++) {
+        for(int range = 0; range < 3; range++) {
+            const size_t n        = sizes[s];
+            int*         lsd      = malloc(n * sizeof(int));
+            int*         msd      = malloc(n * sizeof(int));
+            int*         automatic = malloc(n * sizeof(int));
+            int*         expected = malloc(n * sizeof(int));
+            bool         ok       = false;
+            if(lsd && msd && automatic && expected) {
+                for(size_t i = 0; i < n; i++) {
+                    expected[i] = (range == 0) ? random_int() : (range == 1) ? rand() % 100 - 50 : -7;
+                }
+                memcpy(lsd, expected, n * sizeof(int));
+                memcpy(msd, expected, n * sizeof(int));
+                memcpy(automatic, expected, n * sizeof(int));
+                qsort(expected, n, sizeof(int), compare);
+                radix_sort_msd(msd, n);
+                radix_sort(automatic, n);
+                ok = radix_sort_lsd(lsd, n) &&
+                     (memcmp(lsd, expected, n * sizeof(int)) == 0) &&
+                     (memcmp(msd, expected, n * sizeof(int)) == 0) &&
+                     (memcmp(automatic, expected, n * sizeof(int)) == 0);
+            }
+            free(lsd); free(msd); free(automatic); free(expected);
+
+            if(!ok) {
+                printf("Mismatch for %zu values\n", n);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Benchmark the sorts on random values, reporting millions sorted per second
+int benchmark(size_t max) {
+    printf("%10s %12s %12s %12s %12s %12s\n", "n", "introsort", "pdqsort", "lsd", "msd", "radix_sort");
+    for(size_t n = 16; n <= max; n *= 4) {
+        // Repeat small sorts so that each is timed over a similar number of
+        // values, with new values each time so that the branches are not learnt
+        const size_t repeats = (max / n < 1000) ? max / n : 1000;
+        int*         data    = malloc(n * sizeof(int));
+        if(data == NULL) {
+            printf("malloc failed: %s", strerror(errno));
+            return EXIT_FAILURE;
+        }
+
+        printf("%10zu ", n);
+        for(int sort = 0; sort < 5; sort++) {
+            double seconds = 0.0;
+            srand(1);
+            for(size_t r = 0; r < repeats; r++) {
+                for(size_t i = 0; i < n; i++) {
+                    data[i] = random_int();
+                }
+                double start = now();
+                switch(sort) {
+                    case 0:  introsort(data, n);      break;
+                    case 1:  pdqsort(data, n);        break;
+                    case 2:  radix_sort_lsd(data, n); break;
+                    case 3:  radix_sort_msd(data, n); break;
+                    default: radix_sort(data, n);     break;
+                }
+                seconds += now() - start;
+            }
+            printf("%12.2f ", repeats * n / seconds / 1e6);
+        }
+        printf("\n");
+        fflush(stdout);
+
+        free(data);
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[]) {
+    // Benchmark the sorts rather than demonstrating them?
+    if((argc > 1) && (strcmp(argv[1], "benchmark") == 0)) {
+        size_t max = (argc > 2) ? strtoul(argv[2], NULL, 10) : 16777216;
+        return benchmark(max);
+    }
+
+    // Sort data including negative values with each sort
+    int data[]  = { 23, -21, 76, 16, -52, 43, 0, -1 };
+    int data2[] = { 23, -21, 76, 16, -52, 43, 0, -1 };
+    print("Unsorted: ", data, NELEMENTS(data));
+    radix_sort_lsd(data, NELEMENTS(data));
+    print("LSD:      ", data, NELEMENTS(data));
+    radix_sort_msd(data2, NELEMENTS(data2));
+    print("MSD:      ", data2, NELEMENTS(data2));
+
+    // Verify against qsort
+    const bool ok = verify();
+    printf("\nVerify against qsort: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
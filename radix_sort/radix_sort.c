@@ -0,0 +1,161 @@
+// Sort an array of int values using radix sort
+//
+// This has a performance of O(n) for fixed-size keys, rather than the O(n log n) of a comparison sort.
+//
+// See https://en.wikipedia.org/wiki/Radix_sort
+// See McIlroy, Bostic and McIlroy, "Engineering Radix Sort"
+
+#include <errno.h>          // For errno
+#include <stdint.h>         // For uint32_t
+#include <stdio.h>          // For printf
+#include <stdlib.h>         // For calloc, malloc, free
+#include <string.h>         // For memcpy, strerror
+#include "insertion_sort.h" // For small_sort, SMALL_SORT_MAX
+#include "quick_sort.h"     // For introsort
+#include "radix_sort.h"     // This module
+
+// Bits per digit of the LSD sort, so that 32-bit keys take 3 passes
+#define LSD_BITS        11
+#define LSD_BUCKETS     (1u << LSD_BITS)
+#define LSD_PASSES      ((32 + LSD_BITS - 1) / LSD_BITS)
+
+// Bits per digit of the MSD sort, so that 32-bit keys take at most 4 levels of recursion
+#define MSD_BITS        8
+#define MSD_BUCKETS     (1u << MSD_BITS)
+
+// Buckets of up to this many values are finished by the MSD sort with small_sort
+#define MSD_CUTOFF      SMALL_SORT_MAX
+
+// Arrays of fewer than this many values are sorted by radix_sort with introsort
+#define RADIX_MIN       256
+
+// Get the key of a value, with the sign bit flipped so that the keys sort as unsigned in the order of the values
+static inline uint32_t key(int value) {
+    return (uint32_t)value ^ 0x80000000u;
+}
+
+// Sort an array of values using LSD radix sort
+bool radix_sort_lsd(int* data, size_t nelements) {
+    if((data == NULL) || (nelements < 2)) {
+        return true;
+    }
+
+    int*   buffer = malloc(nelements * sizeof(int));
+    size_t (*counts)[LSD_BUCKETS] = calloc(LSD_PASSES, sizeof(*counts));
+    if((buffer == NULL) || (counts == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        free(buffer);
+        free(counts);
+        return false;
+    }
+
+    // Count the values with each digit, for all of the digits at once
+    for(size_t i = 0; i < nelements; i++) {
+        const uint32_t k = key(data[i]);
+        for(size_t pass = 0; pass < LSD_PASSES; pass++) {
+            counts[pass][(k >> (pass * LSD_BITS)) & (LSD_BUCKETS - 1)]++;
+        }
+    }
+
+    // Counting sort on each digit in turn, from the least significant
+    int* src = data;
+    int* dst = buffer;
+    for(size_t pass = 0; pass < LSD_PASSES; pass++) {
+        const unsigned shift = pass * LSD_BITS;
+
+        // Skip the pass if every value has the same digit
+        if(counts[pass][(key(src[0]) >> shift) & (LSD_BUCKETS - 1)] == nelements) {
+            continue;
+        }
+
+        // Turn the counts into the offset of each bucket
+        size_t offset = 0;
+        for(size_t bucket = 0; bucket < LSD_BUCKETS; bucket++) {
+            const size_t count = counts[pass][bucket];
+            counts[pass][bucket] = offset;
+            offset += count;
+        }
+
+        // Scatter the values into their buckets, keeping their order within each
+        for(size_t i = 0; i < nelements; i++) {
+            dst[counts[pass][(key(src[i]) >> shift) & (LSD_BUCKETS - 1)]++] = src[i];
+        }
+
+        int* temp = src;
+        src = dst;
+        dst = temp;
+    }
+
+    // After an odd number of passes the values are in the buffer
+    if(src != data) {
+        memcpy(data, src, nelements * sizeof(int));
+    }
+
+    free(buffer);
+    free(counts);
+    return true;
+}
+
+// Sort values in place by the digit at a shift and then recursively by the less significant digits
+static void american_flag(int* data, size_t nelements, unsigned shift) {
+    if(nelements <= MSD_CUTOFF) {
+        small_sort(data, nelements);
+        return;
+    }
+
+    // Count the values with each digit, and find where each bucket starts and ends
+    size_t heads[MSD_BUCKETS] = { 0 };
+    size_t tails[MSD_BUCKETS];
+    for(size_t i = 0; i < nelements; i++) {
+        heads[(key(data[i]) >> shift) & (MSD_BUCKETS - 1)]++;
+    }
+    size_t offset = 0;
+    for(size_t bucket = 0; bucket < MSD_BUCKETS; bucket++) {
+        const size_t count = heads[bucket];
+        heads[bucket] = offset;
+        offset += count;
+        tails[bucket] = offset;
+    }
+
+    // Permute the values into their buckets, following each cycle of displaced values until it comes back round
+    for(size_t bucket = 0; bucket < MSD_BUCKETS; bucket++) {
+        while(heads[bucket] < tails[bucket]) {
+            int      value = data[heads[bucket]];
+            uint32_t digit = (key(value) >> shift) & (MSD_BUCKETS - 1);
+            while(digit != bucket) {
+                const int displaced = data[heads[digit]];
+                data[heads[digit]++] = value;
+                value = displaced;
+                digit = (key(value) >> shift) & (MSD_BUCKETS - 1);
+            }
+            data[heads[bucket]++] = value;
+        }
+    }
+
+    // Sort each bucket on the next digit, the heads now being at the end of each bucket
+    if(shift > 0) {
+        size_t start = 0;
+        for(size_t bucket = 0; bucket < MSD_BUCKETS; bucket++) {
+            american_flag(data + start, tails[bucket] - start, shift - MSD_BITS);
+            start = tails[bucket];
+        }
+    }
+}
+
+// Sort an array of values in place using MSD radix sort (American flag sort)
+void radix_sort_msd(int* data, size_t nelements) {
+    if((data == NULL) || (nelements < 2)) {
+        return;
+    }
+    american_flag(data, nelements, 32 - MSD_BITS);
+}
+
+// Sort an array of values, choosing the fastest sort for the number of values
+void radix_sort(int* data, size_t nelements) {
+    if(nelements < RADIX_MIN) {
+        introsort(data, nelements);
+    }
+    else if(!radix_sort_lsd(data, nelements)) {
+        radix_sort_msd(data, nelements);
+    }
+}
@@ -0,0 +1,52 @@
+// Sort an array of int values using radix sort
+//
+// This has a performance of O(n) for fixed-size keys, rather than the O(n log n) of a comparison sort.
+//
+// The LSD (least significant digit first) sort makes a stable counting sort pass over each 11-bit digit of the keys,
+// moving the values back and forth between the array and a buffer of the same size. The histograms for all the digits
+// are counted in a single pass beforehand, and a digit whose values all fall into one bucket is skipped.
+//
+// The MSD (most significant digit first) sort is American flag sort, which needs no buffer. It permutes the values into
+// buckets by their top 8 bits in place, following cycles, then recurses into each bucket on the next 8 bits, finishing
+// small buckets with small_sort (a sorting network where the CPU has AVX2).
+//
+// Either way, the sign bit is flipped so that negative values sort before positive ones.
+//
+// See https://en.wikipedia.org/wiki/Radix_sort
+// See McIlroy, Bostic and McIlroy, "Engineering Radix Sort"
+
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <stdbool.h>    // For bool
+#include <stddef.h>     // For size_t
+
+// Sort an array of values using LSD radix sort, which is stable.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+//
+// Returns:
+//  true      : the values were sorted.
+//  false     : the values were not changed i.e. memory for the buffer could not be allocated.
+bool radix_sort_lsd(int* data, size_t nelements);
+
+// Sort an array of values in place using MSD radix sort (American flag sort), which is not stable.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+void radix_sort_msd(int* data, size_t nelements);
+
+// Sort an array of values, choosing the fastest sort for the number of values.
+//
+// Small arrays are sorted with introsort, where the fixed cost of the radix passes would dominate, and larger ones with
+// LSD radix sort. If there is not enough memory for LSD radix sort, MSD radix sort is used.
+//
+// Parameters:
+//  data      : pointer to the array of values.
+//  nelements : number of values in the array.
+void radix_sort(int* data, size_t nelements);
+
+#endif // RADIX_SORT_H
@@ -0,0 +1,287 @@
+// Sparse matrices in compressed sparse row (CSR) and column (CSC) formats
+//
+// The matrices from matrix_multiply are converted from dense to sparse and
+// multiplied by a vector (SpMV) and by each other (SpGEMM). The sparse
+// multiplications are verified against dense ones on random matrices, and
+// benchmarked against them with:
+//
+//  ./sparse_matrix benchmark [max size] [percentage of nonzeros]
+
+#define _POSIX_C_SOURCE 200809L // For clock_gettime
+
+#include <errno.h>              // For errno
+#include <stdbool.h>            // For bool, true, false
+#include <stdio.h>              // For printf
+#include <stdlib.h>             // For calloc, free, malloc, rand, strtod, strtoul, EXIT_SUCCESS
+#include <string.h>             // For memcmp, strcmp, strerror
+#include <time.h>               // For clock_gettime
+#include "sparse_matrix.h"      // For sparse_from_dense, sparse_multiply et al
+
+// Multiply dense matrices using a naive m-p-n triple loop, as in matrix_multiply
+int* multiply_dense(const int* a, unsigned int arows, unsigned int acols,
+                    const int* b, unsigned int bcols) {
+    int *c = calloc(arows * bcols, sizeof(int));
+    if(c == NULL) {
+        printf("malloc failed: %s", strerror(errno));
+        return NULL;
+    }
+    for(unsigned int m = 0; m < arows; m++) {
+        for(unsigned int p = 0; p < bcols; p++) {
+            for(unsigned int n = 0; n < acols; n++) {
+                c[m*bcols + p] += a[m*acols + n] * b[n*bcols + p];
+            }
+        }
+    }
+    return c;
+}
+
+// Utility function to print a matrix
+void print(char *label, int *matrix, unsigned int rows, unsigned int cols) {
+    printf("\n%s\n", label);
+    for(unsigned int m = 0; m < rows; m++) {
+        for(unsigned int n = 0; n < cols; n++) {
+            printf("%3d ", matrix[m*cols + n]);
+        }
+        printf("\n");
+    }
+}
+
+// Utility function to print the arrays of a sparse matrix
+void print_sparse(char *label, sparse_t *sparse) {
+    printf("\n%s (%s, %zu x %zu, %zu nonzeros)\n", label, sparse->format == SPARSE_CSR ? "CSR" : "CSC",
+           sparse->rows, sparse->cols, sparse->nnz);
+    const size_t n = (sparse->format == SPARSE_CSR) ? sparse->rows : sparse->cols;
+    printf("offsets: ");
+    for(size_t i = 0; i <= n; i++) {
+        printf("%3zu ", sparse->offsets[i]);
+    }
+    printf("\nindices: ");
+    for(size_t k = 0; k < sparse->nnz; k++) {
+        printf("%3zu ", sparse->indices[k]);
+    }
+    printf("\nvalues:  ");
+    for(size_t k = 0; k < sparse->nnz; k++) {
+        printf("%3d ", sparse->values[k]);
+    }
+    printf("\n");
+}
+
+// Utility function to get the time in seconds
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Utility function to fill a matrix with small random values, a percentage of
+// which are nonzero
+void fill(int *matrix, unsigned int rows, unsigned int cols, double percent) {
+    for(unsigned int i = 0; i < rows * cols; i++) {
+        matrix[i] = (rand() < percent / 100.0 * RAND_MAX) ? rand() % 19 - 9 : 0;
+    }
+}
+
+// Verify conversion, transpose, SpMV and SpGEMM against dense matrices, for
+// both formats and a range of shapes and densities
+bool verify(void) {
+    static const unsigned int shapes[][3] = {
+        { 1, 1, 1 }, { 3, 5, 2 }, { 17, 1, 9 }, { 40, 60, 50 }, { 200, 100, 300 }
+    };
+    static const double percents[] = { 0.0, 1.0, 10.0, 100.0 };
+
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        for(size_t d = 0; d < sizeof(percents) / sizeof(percents[0]); d++) {
+            const unsigned int m = shapes[s][0];
+            const unsigned int n = shapes[s][1];
+            const unsigned int p = shapes[s][2];
+            int *a = malloc(m * n * sizeof(int));
+            int *b = malloc(n * p * sizeof(int));
+            int *x = malloc(n * sizeof(int));
+            int *y = malloc(m * sizeof(int));
+            int *r = NULL;
+            bool ok = false;
+            if(a && b && x && y) {
+                fill(a, m, n, percents[d]);
+                fill(b, n, p, percents[d]);
+                fill(x, n, 1, 100.0);
+                r  = multiply_dense(a, m, n, b, p);
+                ok = (r != NULL);
+
+                for(int f = 0; ok && (f < 2); f++) {
+                    sparse_t *sa = sparse_from_dense(a, m, n, f == 0 ? SPARSE_CSR : SPARSE_CSC);
+                    sparse_t *sb = sparse_from_dense(b, n, p, f == 0 ? SPARSE_CSC : SPARSE_CSR);
+                    sparse_t *st = sa ? sparse_transpose(sa) : NULL;
+                    sparse_t *sc = (sa && sb) ? sparse_multiply(sa, sb) : NULL;
+                    int      *da = sa ? sparse_to_dense(sa) : NULL;
+                    int      *dt = st ? sparse_to_dense(st) : NULL;
+                    int      *dc = sc ? sparse_to_dense(sc) : NULL;
+                    ok = da && dt && dc && (memcmp(da, a, m * n * sizeof(int)) == 0) &&
+                         (memcmp(dc, r, m * p * sizeof(int)) == 0);
+                    for(unsigned int i = 0; ok && (i < m); i++) {
+                        for(unsigned int j = 0; ok && (j < n); j++) {
+                            ok = (dt[j*m + i] == a[i*n + j]);
+                        }
+                    }
+                    if(ok) {
+                        sparse_multiply_vector(sa, x, y);
+                        for(unsigned int i = 0; ok && (i < m); i++) {
+                            int sum = 0;
+                            for(unsigned int j = 0; j < n; j++) {
+                                sum += a[i*n + j] * x[j];
+                            }
+                            ok = (y[i] == sum);
+                        }
+                    }
+                    sparse_destroy(&sa); sparse_destroy(&sb); sparse_destroy(&st); sparse_destroy(&sc);
+                    free(da); free(dt); free(dc);
+                }
+            }
+            free(a); free(b); free(x); free(y); free(r);
+
+            if(!ok) {
+                printf("Mismatch for %u x %u * %u x %u with %.0f%% nonzeros\n", m, n, n, p, percents[d]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Benchmark SpMV and SpGEMM against dense multiplications of n x n matrices,
+// reporting times in milliseconds and the memory used by each matrix
+int benchmark(unsigned int max, double percent) {
+    printf("%6s %10s %10s %10s %10s %12s %12s %12s\n", "n", "nonzeros", "dense KiB", "sparse KiB", "dense mv",
+           "sparse mv", "dense mm", "sparse mm");
+    for(unsigned int n = 256; n <= max; n *= 2) {
+        int *a = malloc(n * n * sizeof(int));
+        int *x = malloc(n * sizeof(int));
+        int *y = malloc(n * sizeof(int));
+        if(!a || !x || !y) {
+            printf("malloc failed: %s", strerror(errno));
+            free(a); free(x); free(y);
+            return EXIT_FAILURE;
+        }
+        fill(a, n, n, percent);
+        fill(x, n, 1, 100.0);
+        sparse_t *sa = sparse_from_dense(a, n, n, SPARSE_CSR);
+        if(sa == NULL) {
+            free(a); free(x); free(y);
+            return EXIT_FAILURE;
+        }
+        printf("%6u %10zu %10zu %10zu ", n, sa->nnz, n * n * sizeof(int) / 1024,
+               ((n + 1 + sa->nnz) * sizeof(size_t) + sa->nnz * sizeof(int)) / 1024);
+
+        double start = now();
+        for(unsigned int i = 0; i < n; i++) {
+            int sum = 0;
+            for(unsigned int j = 0; j < n; j++) {
+                sum += a[i*n + j] * x[j];
+            }
+            y[i] = sum;
+        }
+        printf("%10.3f ", (now() - start) * 1e3);
+
+        start = now();
+        sparse_multiply_vector(sa, x, y);
+        printf("%12.3f ", (now() - start) * 1e3);
+
+        // The naive dense multiplication is too slow for large matrices
+        if(n <= 1024) {
+            start = now();
+            int *c = multiply_dense(a, n, n, a, n);
+            printf("%12.3f ", (now() - start) * 1e3);
+            free(c);
+        }
+        else {
+            printf("%12s ", "-");
+        }
+
+        start = now();
+        sparse_t *sc = sparse_multiply(sa, sa);
+        printf("%12.3f\n", (now() - start) * 1e3);
+        fflush(stdout);
+
+        sparse_destroy(&sa); sparse_destroy(&sc);
+        free(a); free(x); free(y);
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+    // Benchmark the multiplications rather than demonstrating them?
+    if((argc > 1) && (strcmp(argv[1], "benchmark") == 0)) {
+        unsigned int max     = (argc > 2) ? strtoul(argv[2], NULL, 10) : 8192;
+        double       percent = (argc > 3) ? strtod(argv[3], NULL) : 1.0;
+        return benchmark(max, percent);
+    }
+
+    int a[2][4] = {
+        { -1,  0,  0, 8 },
+        {  0, -5,  7, 0 }
+    };
+
+    int b[4][2] = {
+        {  0,  1 },
+        { -2,  0 },
+        {  0,  0 },
+        { -6, -7 }
+    };
+
+    int x[4] = { 1, 2, 3, 4 };
+    int y[2] = { 0 };
+
+    // Convert a to CSR and b to CSC
+    print("Matrix a:", (int*)a, 2, 4);
+    sparse_t *sa = sparse_from_dense((int*)a, 2, 4, SPARSE_CSR);
+    if(sa != NULL) {
+        print_sparse("Sparse a:", sa);
+    }
+    print("Matrix b:", (int*)b, 4, 2);
+    sparse_t *sb = sparse_from_dense((int*)b, 4, 2, SPARSE_CSC);
+    if(sb != NULL) {
+        print_sparse("Sparse b:", sb);
+    }
+
+    if((sa != NULL) && (sb != NULL)) {
+        // Convert b to CSR, and transpose a
+        sparse_t *m = sparse_convert(sb, SPARSE_CSR);
+        if(m != NULL) {
+            print_sparse("Sparse b in CSR:", m);
+            sparse_destroy(&m);
+        }
+        m = sparse_transpose(sa);
+        if(m != NULL) {
+            print_sparse("Sparse a':", m);
+            sparse_destroy(&m);
+        }
+
+        // a * x
+        sparse_multiply_vector(sa, x, y);
+        printf("\na * { 1, 2, 3, 4 } = { %d, %d }\n", y[0], y[1]);
+
+        // a * b
+        m = sparse_multiply(sa, sb);
+        if(m != NULL) {
+            print_sparse("a * b:", m);
+            int *dense = sparse_to_dense(m);
+            if(dense != NULL) {
+                print("a * b dense:", dense, 2, 2);
+                free(dense);
+            }
+            sparse_destroy(&m);
+        }
+
+        // a * a is expected to fail
+        printf("\na * a:\n");
+        m = sparse_multiply(sa, sa);
+        sparse_destroy(&m);
+    }
+    sparse_destroy(&sa);
+    sparse_destroy(&sb);
+
+    // Verify against dense matrices
+    const bool ok = verify();
+    printf("\nVerify against dense matrices: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,280 @@
+// Sparse matrices of int elements, in compressed sparse row (CSR) or compressed sparse column (CSC) format.
+//
+// Only the nonzero elements are stored, so memory and time scale with the number of nonzeros rather than rows x cols.
+// In CSR format the nonzeros are stored row by row: the nonzeros of row i are values[offsets[i]] up to (but not
+// including) values[offsets[i + 1]], and indices holds the column of each. CSC is the same with rows and columns
+// swapped, so the CSR arrays of a matrix are the CSC arrays of its transpose.
+//
+// Converting between the formats, or transposing, is a counting sort of the nonzeros by their index, in time
+// proportional to rows + cols + nonzeros. Walking the nonzeros in order as they are scattered leaves the indices in
+// ascending order within each row (or column).
+//
+// See Gustavson, "Two Fast Algorithms for Sparse Matrices: Multiplication and Permuted Transposition"
+
+#include <errno.h>              // For errno
+#include <stdint.h>             // For SIZE_MAX
+#include <stdio.h>              // For printf
+#include <stdlib.h>             // For calloc, malloc, free
+#include <string.h>             // For memcpy, strerror
+#include "sparse_matrix.h"      // This module
+
+// Get the number of rows (CSR) or columns (CSC) i.e. the dimension indexed by the offsets
+static size_t outer(sparse_format_t format, size_t rows, size_t cols) {
+    return (format == SPARSE_CSR) ? rows : cols;
+}
+
+// Create a sparse matrix with room for a number of nonzeros, with the offsets zeroed
+static sparse_t* create(sparse_format_t format, size_t rows, size_t cols, size_t nnz) {
+    sparse_t* sparse = malloc(sizeof(sparse_t));
+    if(sparse == NULL) {
+        printf("malloc failed: %s", strerror(errno));
+        return NULL;
+    }
+
+    sparse->format  = format;
+    sparse->rows    = rows;
+    sparse->cols    = cols;
+    sparse->nnz     = nnz;
+    sparse->offsets = calloc(outer(format, rows, cols) + 1, sizeof(size_t));
+    sparse->indices = malloc((nnz > 0 ? nnz : 1) * sizeof(size_t));
+    sparse->values  = malloc((nnz > 0 ? nnz : 1) * sizeof(int));
+    if((sparse->offsets == NULL) || (sparse->indices == NULL) || (sparse->values == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+        sparse_destroy(&sparse);
+        return NULL;
+    }
+    return sparse;
+}
+
+// Create a sparse matrix with the nonzeros of another sorted by their index i.e. the outer and inner dimensions swap
+//
+// With the same rows and columns this converts to the other format, and with them swapped it transposes.
+static sparse_t* flip(const sparse_t* sparse, sparse_format_t format, size_t rows, size_t cols) {
+    sparse_t* flipped = create(format, rows, cols, sparse->nnz);
+    if(flipped == NULL) {
+        return NULL;
+    }
+
+    // Count the nonzeros for each index, then sum the counts into the offset of each
+    const size_t n = outer(format, rows, cols);
+    for(size_t k = 0; k < sparse->nnz; k++) {
+        flipped->offsets[sparse->indices[k] + 1]++;
+    }
+    for(size_t i = 0; i < n; i++) {
+        flipped->offsets[i + 1] += flipped->offsets[i];
+    }
+
+    // Scatter the nonzeros, using the offsets as the next free position and then shifting them back
+    const size_t m = outer(sparse->format, sparse->rows, sparse->cols);
+    for(size_t i = 0; i < m; i++) {
+        for(size_t k = sparse->offsets[i]; k < sparse->offsets[i + 1]; k++) {
+            const size_t position = flipped->offsets[sparse->indices[k]]++;
+            flipped->indices[position] = i;
+            flipped->values[position]  = sparse->values[k];
+        }
+    }
+    for(size_t i = n; i > 0; i--) {
+        flipped->offsets[i] = flipped->offsets[i - 1];
+    }
+    flipped->offsets[0] = 0;
+
+    return flipped;
+}
+
+// Convert a dense matrix, stored in row-major order, to a sparse matrix
+sparse_t* sparse_from_dense(const int* dense, size_t rows, size_t cols, sparse_format_t format) {
+    // Count the nonzeros, then fill them in row by row
+    size_t nnz = 0;
+    for(size_t i = 0; i < rows * cols; i++) {
+        nnz += (dense[i] != 0);
+    }
+    sparse_t* sparse = create(SPARSE_CSR, rows, cols, nnz);
+    if(sparse == NULL) {
+        return NULL;
+    }
+    size_t k = 0;
+    for(size_t i = 0; i < rows; i++) {
+        for(size_t j = 0; j < cols; j++) {
+            if(dense[i*cols + j] != 0) {
+                sparse->indices[k] = j;
+                sparse->values[k]  = dense[i*cols + j];
+                k++;
+            }
+        }
+        sparse->offsets[i + 1] = k;
+    }
+
+    // Columns are strided in the dense matrix, so sort the nonzeros by column rather than scanning down each column
+    if(format == SPARSE_CSC) {
+        sparse_t* csc = flip(sparse, SPARSE_CSC, rows, cols);
+        sparse_destroy(&sparse);
+        return csc;
+    }
+    return sparse;
+}
+
+// Convert a sparse matrix to a dense matrix, stored in row-major order
+int* sparse_to_dense(const sparse_t* sparse) {
+    int* dense = calloc(sparse->rows * sparse->cols, sizeof(int));
+    if(dense == NULL) {
+        printf("malloc failed: %s", strerror(errno));
+        return NULL;
+    }
+
+    const size_t n = outer(sparse->format, sparse->rows, sparse->cols);
+    for(size_t i = 0; i < n; i++) {
+        for(size_t k = sparse->offsets[i]; k < sparse->offsets[i + 1]; k++) {
+            if(sparse->format == SPARSE_CSR) {
+                dense[i*sparse->cols + sparse->indices[k]] = sparse->values[k];
+            }
+            else {
+                dense[sparse->indices[k]*sparse->cols + i] = sparse->values[k];
+            }
+        }
+    }
+    return dense;
+}
+
+// Destroy a sparse matrix
+void sparse_destroy(sparse_t** sparse) {
+    if((sparse == NULL) || (*sparse == NULL)) {
+        return;
+    }
+    free((*sparse)->offsets);
+    free((*sparse)->indices);
+    free((*sparse)->values);
+    free(*sparse);
+    *sparse = NULL;
+}
+
+// Convert a sparse matrix to another storage format
+sparse_t* sparse_convert(const sparse_t* sparse, sparse_format_t format) {
+    if(format != sparse->format) {
+        return flip(sparse, format, sparse->rows, sparse->cols);
+    }
+
+    // Copy
+    sparse_t* copy = create(format, sparse->rows, sparse->cols, sparse->nnz);
+    if(copy != NULL) {
+        memcpy(copy->offsets, sparse->offsets, (outer(format, sparse->rows, sparse->cols) + 1) * sizeof(size_t));
+        memcpy(copy->indices, sparse->indices, sparse->nnz * sizeof(size_t));
+        memcpy(copy->values,  sparse->values,  sparse->nnz * sizeof(int));
+    }
+    return copy;
+}
+
+// Transpose a sparse matrix, keeping its storage format
+sparse_t* sparse_transpose(const sparse_t* sparse) {
+    return flip(sparse, sparse->format, sparse->cols, sparse->rows);
+}
+
+// Multiply a sparse matrix by a dense vector i.e. y = A * x
+void sparse_multiply_vector(const sparse_t* a, const int* x, int* y) {
+    if(a->format == SPARSE_CSR) {
+        // Each element of y is the dot product of a row with x
+        for(size_t i = 0; i < a->rows; i++) {
+            int sum = 0;
+            for(size_t k = a->offsets[i]; k < a->offsets[i + 1]; k++) {
+                sum += a->values[k] * x[a->indices[k]];
+            }
+            y[i] = sum;
+        }
+    }
+    else {
+        // Each column is scaled by an element of x and added into y
+        memset(y, 0, a->rows * sizeof(int));
+        for(size_t j = 0; j < a->cols; j++) {
+            for(size_t k = a->offsets[j]; k < a->offsets[j + 1]; k++) {
+                y[a->indices[k]] += a->values[k] * x[j];
+            }
+        }
+    }
+}
+
+// Multiply two CSR matrices i.e. C = A * B, given workspaces of B->cols elements, leaving the columns of each row of C
+// unsorted
+//
+// Row i of C is the sum of the rows of B scaled by the nonzeros of row i of A. A first pass counts the nonzeros of each
+// row of C, marking the columns already seen, and a second accumulates their values in a dense row.
+static sparse_t* gustavson(const sparse_t* a, const sparse_t* b, size_t* marker, int* row) {
+    // Count the nonzeros of each row of C
+    size_t nnz = 0;
+    for(size_t j = 0; j < b->cols; j++) {
+        marker[j] = SIZE_MAX;
+    }
+    for(size_t i = 0; i < a->rows; i++) {
+        for(size_t ka = a->offsets[i]; ka < a->offsets[i + 1]; ka++) {
+            const size_t n = a->indices[ka];
+            for(size_t kb = b->offsets[n]; kb < b->offsets[n + 1]; kb++) {
+                if(marker[b->indices[kb]] != i) {
+                    marker[b->indices[kb]] = i;
+                    nnz++;
+                }
+            }
+        }
+    }
+
+    // Accumulate the nonzeros of each row of C, in the order in which their columns are first seen
+    sparse_t* c = create(SPARSE_CSR, a->rows, b->cols, nnz);
+    if(c == NULL) {
+        return NULL;
+    }
+    for(size_t j = 0; j < b->cols; j++) {
+        marker[j] = SIZE_MAX;
+    }
+    size_t k = 0;
+    for(size_t i = 0; i < a->rows; i++) {
+        const size_t start = k;
+        for(size_t ka = a->offsets[i]; ka < a->offsets[i + 1]; ka++) {
+            const size_t n = a->indices[ka];
+            for(size_t kb = b->offsets[n]; kb < b->offsets[n + 1]; kb++) {
+                const size_t j = b->indices[kb];
+                if(marker[j] != i) {
+                    marker[j] = i;
+                    row[j]    = 0;
+                    c->indices[k++] = j;
+                }
+                row[j] += a->values[ka] * b->values[kb];
+            }
+        }
+        for(size_t kc = start; kc < k; kc++) {
+            c->values[kc] = row[c->indices[kc]];
+        }
+        c->offsets[i + 1] = k;
+    }
+    return c;
+}
+
+// Multiply two sparse matrices i.e. C = A * B
+sparse_t* sparse_multiply(const sparse_t* a, const sparse_t* b) {
+    // To multiply matrices the dimensions need to be m x n and n x p
+    if(a->cols != b->rows) {
+        printf("Cannot multiply matrices with dimensions %zu x %zu and %zu x %zu\n", a->rows, a->cols, b->rows,
+               b->cols);
+        return NULL;
+    }
+
+    // Both are walked row by row
+    sparse_t* a_csr  = sparse_convert(a, SPARSE_CSR);
+    sparse_t* b_csr  = sparse_convert(b, SPARSE_CSR);
+    size_t*   marker = malloc((b->cols > 0 ? b->cols : 1) * sizeof(size_t));
+    int*      row    = malloc((b->cols > 0 ? b->cols : 1) * sizeof(int));
+    sparse_t* c      = NULL;
+    if((a_csr != NULL) && (b_csr != NULL) && (marker != NULL) && (row != NULL)) {
+        // Sort the columns within each row by converting to CSC and back
+        sparse_t* unsorted = gustavson(a_csr, b_csr, marker, row);
+        sparse_t* csc      = (unsorted != NULL) ? sparse_convert(unsorted, SPARSE_CSC) : NULL;
+        c = (csc != NULL) ? sparse_convert(csc, SPARSE_CSR) : NULL;
+        sparse_destroy(&unsorted);
+        sparse_destroy(&csc);
+    }
+    else if((marker == NULL) || (row == NULL)) {
+        printf("malloc failed: %s", strerror(errno));
+    }
+
+    sparse_destroy(&a_csr);
+    sparse_destroy(&b_csr);
+    free(marker);
+    free(row);
+    return c;
+}
@@ -0,0 +1,116 @@
+// Sparse matrices of int elements, in compressed sparse row (CSR) or compressed sparse column (CSC) format.
+//
+// Only the nonzero elements are stored, so memory and time scale with the number of nonzeros rather than rows x cols.
+// In CSR format the nonzeros are stored row by row: the nonzeros of row i are values[offsets[i]] up to (but not
+// including) values[offsets[i + 1]], and indices holds the column of each. CSC is the same with rows and columns
+// swapped, so the CSR arrays of a matrix are the CSC arrays of its transpose.
+//
+// For example, in CSR format:
+//
+//  | 0 5 0 0 |     offsets = { 0, 1, 3, 3 }
+//  | 7 0 0 2 |     indices = { 1, 0, 3 }
+//  | 0 0 0 0 |     values  = { 5, 7, 2 }
+//
+// Indices are in ascending order within each row (or column).
+//
+// See https://en.wikipedia.org/wiki/Sparse_matrix#Compressed_sparse_row_(CSR,_CRS_or_Yale_format)
+
+#ifndef SPARSE_MATRIX_H
+#define SPARSE_MATRIX_H
+
+#include <stddef.h>     // For size_t
+
+// Storage formats.
+typedef enum sparse_format_tag {
+    SPARSE_CSR,     // compressed sparse row
+    SPARSE_CSC      // compressed sparse column
+} sparse_format_t;
+
+// A sparse matrix.
+//
+// Fields:
+//  format  : storage format.
+//  rows    : number of rows.
+//  cols    : number of columns.
+//  nnz     : number of nonzeros stored.
+//  offsets : index into indices and values of the start of each row (CSR) or column (CSC), plus one past the end.
+//  indices : column (CSR) or row (CSC) of each nonzero.
+//  values  : value of each nonzero.
+typedef struct sparse_t {
+    sparse_format_t format;
+    size_t          rows;
+    size_t          cols;
+    size_t          nnz;
+    size_t*         offsets;
+    size_t*         indices;
+    int*            values;
+} sparse_t;
+
+// Convert a dense matrix, stored in row-major order, to a sparse matrix.
+//
+// Parameters:
+//  dense  : pointer to the first element of the dense matrix.
+//  rows   : number of rows.
+//  cols   : number of columns.
+//  format : storage format of the sparse matrix.
+//
+// Returns:
+//  pointer to the sparse matrix or NULL if memory could not be allocated.
+sparse_t* sparse_from_dense(const int* dense, size_t rows, size_t cols, sparse_format_t format);
+
+// Convert a sparse matrix to a dense matrix, stored in row-major order.
+//
+// Parameters:
+//  sparse : pointer to the sparse matrix.
+//
+// Returns:
+//  pointer to the dense matrix, to be freed by the caller, or NULL if memory could not be allocated.
+int* sparse_to_dense(const sparse_t* sparse);
+
+// Destroy a sparse matrix.
+//
+// Parameters:
+//  sparse : pointer to pointer to the sparse matrix.
+void sparse_destroy(sparse_t** sparse);
+
+// Convert a sparse matrix to another storage format, in time proportional to rows + cols + nonzeros.
+//
+// Parameters:
+//  sparse : pointer to the sparse matrix.
+//  format : storage format of the new sparse matrix.
+//
+// Returns:
+//  pointer to the new sparse matrix, a copy if the format is unchanged, or NULL if memory could not be allocated.
+sparse_t* sparse_convert(const sparse_t* sparse, sparse_format_t format);
+
+// Transpose a sparse matrix, keeping its storage format.
+//
+// Parameters:
+//  sparse : pointer to the sparse matrix.
+//
+// Returns:
+//  pointer to the transposed sparse matrix or NULL if memory could not be allocated.
+sparse_t* sparse_transpose(const sparse_t* sparse);
+
+// Multiply a sparse matrix by a dense vector i.e. y = A * x (SpMV).
+//
+// Parameters:
+//  a : pointer to the sparse matrix A, in either format.
+//  x : pointer to the dense vector x, with a->cols elements.
+//  y : pointer to the dense vector y, with a->rows elements, overwritten.
+void sparse_multiply_vector(const sparse_t* a, const int* x, int* y);
+
+// Multiply two sparse matrices i.e. C = A * B (SpGEMM), in either format.
+//
+// Gustavson's row-by-row algorithm is used, so that the time scales with the number of multiplications of nonzeros.
+// Products that cancel out are kept as explicit zeros.
+//
+// Parameters:
+//  a : pointer to the sparse matrix A, m x n.
+//  b : pointer to the sparse matrix B, n x p.
+//
+// Returns:
+//  pointer to C, m x p in CSR format, or NULL if the dimensions do not match or memory could not be allocated.
+sparse_t* sparse_multiply(const sparse_t* a, const sparse_t* b);
+
+#endif // SPARSE_MATRIX_H